@@ -0,0 +1,15 @@
+/**
+ *  Copyright 2010-2012 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ *
+ *  Checks for the atomic header
+ */
+#include <atomic>
+
+int main(int argc, const char** argv)
+{
+  int val = 0;
+  std::atomic<int *> ptr(&val);
+  return ptr.load(std::memory_order_acquire)==&val ? 0:1;
+}
@@ -114,6 +114,7 @@ if(WITH_CPP11)
   cpp11_feature_detection(UNIQUE_PTR)
   cpp11_feature_detection(SHARED_PTR) 
   cpp11_feature_detection(DELETED_FUNCTIONS)
+  cpp11_feature_detection(ATOMIC)
   #cpp11_feature_detection(THREAD)
 
   if(CPP11_ENABLED) 
@@ -210,8 +211,23 @@ else(WITH_CPP11)
   set(CPP11_ENABLED FALSE)
 endif(WITH_CPP11)
 
+if(CPP11_HAS_ATOMIC)
+  set(ATOMIC_LIB "" CACHE PATH "Using C++11 atomic" FORCE)
+else(CPP11_HAS_ATOMIC)
+  # Boost_VERSION is either 105300 or "1.53.0" depending on how Boost
+  # was found: rely on the major/minor numbers instead
+  if("${Boost_MAJOR_VERSION}.${Boost_MINOR_VERSION}" VERSION_LESS 1.53)
+    message(FATAL_ERROR "TREX requires either C++11 atomic or Boost >= 1.53 "
+      "for Boost.Atomic. Try to enable WITH_CPP11.")
+  endif("${Boost_MAJOR_VERSION}.${Boost_MINOR_VERSION}" VERSION_LESS 1.53)
+  find_package(Boost COMPONENTS atomic)
+  message(STATUS "Checking for Boost.Atomic: ${Boost_ATOMIC_LIBRARY}")
+  set(ATOMIC_LIB "${Boost_ATOMIC_LIBRARY}" CACHE PATH "Boost atomic library path" FORCE)
+endif(CPP11_HAS_ATOMIC)
+
 message(STATUS "CPP11 enabled: ${CPP11_ENABLED}")
 message(STATUS "CHRONO_LIB: ${CHRONO_LIB}")
+message(STATUS "ATOMIC_LIB: ${ATOMIC_LIB}")
 
 ########################################################################
 # Europa                                                               #
@@ -35,6 +35,7 @@
 #include "TimelineHistory.hh"
 #include "timeline_services.hh"
 #include "tick_manager.hh"
+#include "event_stream.hh"
 
 #include <trex/utils/TREXversion.hh>
 
@@ -76,7 +77,26 @@ namespace {
 // structors 
 
 REST_reactor::REST_reactor(TeleoReactor::xml_arg_type arg)
-:TeleoReactor(arg, false) {
+:TeleoReactor(arg, false),
+ m_segment_ticks(utils::parse_attr<TICK>(3600, xml_factory::node(arg),
+                                         "segment_ticks")),
+ m_stream_events(utils::parse_attr<size_t>(1024, xml_factory::node(arg),
+                                           "stream_events")),
+ m_plan(utils::parse_attr<bool>(false, xml_factory::node(arg), "plan")) {
+  std::string history = utils::parse_attr<std::string>("db", xml_factory::node(arg),
+                                                       "history");
+  if( "columnar"==history )
+    m_columnar = true;
+  else if( "db"==history )
+    m_columnar = false;
+  else
+    throw utils::XmlError(xml_factory::node(arg),
+                          "Unknown history \""+history+"\": expected \"db\" or \"columnar\"");
+  if( m_segment_ticks<=0 )
+    throw utils::XmlError(xml_factory::node(arg), "segment_ticks should be greater than 0");
+  if( 0==m_stream_events )
+    throw utils::XmlError(xml_factory::node(arg), "stream_events should be greater than 0");
+  
   // Initialize web server
   bool found;
   
@@ -175,6 +195,7 @@ void REST_reactor::handleInit() {
   
   boost::filesystem::path recvd = file_name("rest_goal");
   m_services->add_handler("goal", new goal_service(m_timelines, recvd.string()));
+  m_services->add_handler("stream", new event_service(m_timelines->events()));
 
   
   
@@ -197,7 +218,7 @@ void REST_reactor::handleInit() {
 void REST_reactor::handleTickStart() {
 }
 
-void REST_reactor::notify(Observation const &obs) {
+void REST_reactor::handleObservation(observation_id const &obs) {
   m_timelines->new_obs(obs, getCurrentTick());
 }
 
@@ -207,9 +228,9 @@ bool REST_reactor::synchronize() {
 }
 
 void REST_reactor::newPlanToken(goal_id const &t) {
-  
+  m_timelines->new_plan(t);
 }
 
 void REST_reactor::cancelledPlanToken(goal_id const &t) {
-  
+  m_timelines->cancelled_plan(t);
 }
@@ -55,7 +55,7 @@ namespace TREX {
       //reactor handlers
       void handleInit();
       void handleTickStart();
-      void notify(TREX::transaction::Observation const &obs);
+      void handleObservation(TREX::transaction::observation_id const &obs);
       bool synchronize();
       void newPlanToken(transaction::goal_id const &t);
       void cancelledPlanToken(transaction::goal_id const &t);
@@ -64,6 +64,29 @@ namespace TREX {
       
       // UNIQ_PTR<Wt::WServer>     m_server;
       
+      /** @brief Columnar history flag
+       *
+       * Indicates if past tokens are stored in an append only columnar
+       * store instead of the database (@c history="columnar" attribute)
+       */
+      bool                        m_columnar;
+      /** @brief Number of ticks per columnar store segment */
+      transaction::TICK           m_segment_ticks;
+      /** @brief Number of events kept for the event stream
+       *
+       * Clients of the event stream that are behind by more than this 
+       * number of events miss the oldest ones (@c stream_events 
+       * attribute)
+       */
+      size_t                      m_stream_events;
+      /** @brief Plan tokens flag
+       *
+       * Indicates if this reactor listens to the plan tokens of the 
+       * timelines it observes in order to publish them on the event 
+       * stream (@c plan attribute)
+       */
+      bool                        m_plan;
+      
       SHARED_PTR<TimelineHistory> m_timelines;
       SHARED_PTR<tick_manager>    m_tick;
       UNIQ_PTR<service_tree>             m_services;
@@ -38,6 +38,13 @@
 
 #include <trex/utils/ptree_io.hh>
 
+#include "dbo_cfg.hh"
+
+#ifdef REST_GZIP
+# include <boost/iostreams/filtering_stream.hpp>
+# include <boost/iostreams/filter/gzip.hpp>
+#endif // REST_GZIP
+
 
 using namespace TREX::REST;
 namespace bpt=boost::property_tree;
@@ -57,6 +64,18 @@ namespace {
     }
     return ret;
   }
+  
+#ifdef REST_GZIP
+  /** @brief Minimum size of a compressed response
+   *
+   * Responses smaller than this are not worth the compression
+   */
+  size_t const gzip_threshold = 1024;
+  
+  bool accept_gzip(wht::Request const &req) {
+    return std::string::npos!=req.headerValue("Accept-Encoding").find("gzip");
+  }
+#endif // REST_GZIP
 }
 
 std::string TREX::REST::my_url_decode(std::string str) {
@@ -98,8 +117,27 @@ void rest_service::handleRequest(wht::Request const &req,
   try {
     std::ostringstream oss;
     handleRequest(rest, oss, response);
-    if( !oss.str().empty() ) {
-      response.out()<<oss.str();
+    std::string const body = oss.str();
+    if( !body.empty() ) {
+#ifdef REST_GZIP
+      // Only compress complete responses : the chunks of a response
+      // with continuations are sent as they are
+      bool const compressible = NULL==req.continuation() &&
+        NULL==response.continuation() && body.size()>=gzip_threshold;
+      
+      if( compressible )
+        // tell caches that this response depends on the client encodings
+        response.addHeader("Vary", "Accept-Encoding");
+      if( compressible && accept_gzip(req) ) {
+        boost::iostreams::filtering_ostream gz;
+        
+        response.addHeader("Content-Encoding", "gzip");
+        gz.push(boost::iostreams::gzip_compressor());
+        gz.push(response.out());
+        gz<<body;
+      } else
+#endif // REST_GZIP
+        response.out()<<body;
     }
   } catch(rest_error const &err) {
     response.setStatus(err.get_code());
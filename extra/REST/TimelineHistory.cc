@@ -48,29 +48,42 @@ using namespace TREX::REST;
 
 TimelineHistory::TimelineHistory(REST_reactor &creator)
 :graph::timelines_listener(creator.get_graph()), m_fancy(true), m_reactor(creator),
- m_strand(creator.manager().service()) {
-   boost::filesystem::path p = m_reactor.file_name("timelines"+helpers::db_manager::db_ext);
-   m_db.initialize(p.string());
+ m_strand(creator.manager().service()),
+ m_events(MAKE_SHARED<helpers::event_journal>(creator.m_stream_events)) {
+   if( m_reactor.m_columnar ) {
+     boost::filesystem::path p = m_reactor.file_name("timelines");
+     m_store.reset(new helpers::token_store(p, m_reactor.m_segment_ticks));
+   } else {
+     boost::filesystem::path p = m_reactor.file_name("timelines"+helpers::db_manager::db_ext);
+     m_db.initialize(p.string());
+   }
    
    // complete my initialization to receive the timleines crrated before I was created
    graph::timelines_listener::initialize();
 }
 
-TimelineHistory::~TimelineHistory() {}
+TimelineHistory::~TimelineHistory() {
+  flush_sync();
+}
 
 // manipulators
 
-bp::ptree TimelineHistory::get_goal(goal_id g) const {
-  bp::ptree tmp;
-  tmp.put("id", g);
-  tmp.put("href", "/rest/goal/"+tmp.get<std::string>("id"));
-  tmp.put_child("Goal", get_token(g));
-  return tmp;
+void TimelineHistory::get_goal(goal_id g, utils::json_writer &out) const {
+  std::ostringstream oss;
+  oss<<g;
+  
+  out.begin_object();
+  out.key("id").value(oss.str());
+  out.key("href").value("/rest/goal/"+oss.str());
+  out.key("Goal");
+  get_token(g, out);
+  out.end_object();
 }
 
 
-bp::ptree TimelineHistory::get_token(goal_id const &tok) const {
-  return m_reactor.getGraph().export_goal(tok).get_child("Goal");
+void TimelineHistory::get_token(goal_id const &tok,
+                                utils::json_writer &out) const {
+  m_reactor.getGraph().export_goal(tok, out);
 }
 
 TICK TimelineHistory::get_date(std::string const &date) {
@@ -80,9 +93,18 @@ TICK TimelineHistory::get_date(std::string const &date) {
 
 // TREX updates callbacks
 
-void TimelineHistory::new_obs(Observation const &obs, TICK cur) {
-  goal_id tok(new Goal(obs, cur));
-  m_strand.post(boost::bind(&TimelineHistory::add_obs_sync, this, tok, cur));
+void TimelineHistory::new_obs(observation_id const &obs, TICK cur) {
+  // The observation is shared : the token is built in the strand to
+  // keep this call as light as possible for the reactor
+  m_strand.post(boost::bind(&TimelineHistory::new_obs_sync, this, obs, cur));
+}
+
+void TimelineHistory::new_plan(goal_id const &tok) {
+  m_strand.post(boost::bind(&TimelineHistory::publish_sync, this, tok, "plan"));
+}
+
+void TimelineHistory::cancelled_plan(goal_id const &tok) {
+  m_strand.post(boost::bind(&TimelineHistory::publish_sync, this, tok, "cancel"));
 }
 
 void TimelineHistory::update_tick(TICK cur) {
@@ -92,7 +114,7 @@ void TimelineHistory::update_tick(TICK cur) {
 
 void TimelineHistory::declared(details::timeline const &timeline) {
   m_strand.post(boost::bind(&TimelineHistory::add_tl_sync, this, boost::ref(timeline)));
-  m_reactor.use(timeline.name());
+  m_reactor.use(timeline.name(), true, m_reactor.m_plan);
 }
 
 // REST callbacks
@@ -101,21 +123,21 @@ void TimelineHistory::list_timelines(std::ostream &out,
                                      std::set<std::string> const &select,
                                      bool hidden,
                                      IntegerDomain const &range) {
-  // I build the json by hand
-  out<<"{ \"requested_tick_range\": ";
+  utils::json_writer json(out, fancy());
+  
+  json.begin_object();
+  json.key("requested_tick_range");
   if( range.isFull() )
-    out<<"{}";
+    json.begin_object().end_object();
   else
-    utils::write_json(out, range.as_tree(), fancy());
-  out<<",\n  \"timelines\": [";
-  
-  boost::function<size_t ()> fn(boost::bind(&TimelineHistory::list_tl_sync, this, boost::ref(out), boost::ref(select), hidden, range));
+    json.tree(range.as_tree());
+  json.key("timelines").begin_array();
   
-  size_t count = utils::strand_run(m_strand, fn);
+  boost::function<size_t ()> fn(boost::bind(&TimelineHistory::list_tl_sync, this, boost::ref(json), boost::ref(select), hidden, range));
   
-  if( count>0 )
-    out.put(' ');
-  out<<"] }";
+  utils::strand_run(m_strand, fn);
+  json.end_array();
+  json.end_object();
 }
 
 void TimelineHistory::get_tokens(std::string const &timeline,
@@ -142,9 +164,9 @@ bool TimelineHistory::exists(std::string const &name) {
   return utils::strand_run(m_strand, fn);
 }
 
-bp::ptree TimelineHistory::goals() {
-  boost::function<bp::ptree ()> fn(boost::bind(&TimelineHistory::goals_sync, this));
-  return utils::strand_run(m_strand, fn);
+void TimelineHistory::goals(utils::json_writer &out) {
+  boost::function<void ()> fn(boost::bind(&TimelineHistory::goals_sync, this, boost::ref(out)));
+  utils::strand_run(m_strand, fn);
 }
 
 goal_id TimelineHistory::add_goal(std::string const &file) {
@@ -197,11 +219,18 @@ void TimelineHistory::add_tl_sync(details::timeline const &tl) {
   // insert the new timeline in my set
   helpers::timeline_wrap *entry = new helpers::timeline_wrap(tl);
   if( m_timelines.insert(entry).second ) {
-    m_db.add_timeline(tl.name().str());
+    if( m_store )
+      m_store->add_timeline(tl.name().str());
+    else
+      m_db.add_timeline(tl.name().str());
   } else
     delete entry;
 }
 
+void TimelineHistory::new_obs_sync(observation_id obs, TICK date) {
+  add_obs_sync(goal_id(new Goal(*obs, date)), date);
+}
+
 void TimelineHistory::add_obs_sync(goal_id tok, TICK date) {
   helpers::rest_tl_set::iterator pos = m_timelines.find(tok->object());
   if( m_timelines.end()!=pos ) {    
@@ -214,17 +243,60 @@ void TimelineHistory::add_obs_sync(goal_id tok, TICK date) {
       // If there was a former observation then store it in the database
       // Do the export in json so the data is already formatted for the services
       std::ostringstream oss;
-      helpers::json_stream json(oss);
+      utils::json_writer json(oss, fancy());
       prev->restrictEnd(IntegerDomain(date));
-      utils::write_json(json, get_token(prev), fancy());
-      m_db.add_token(start, date, (*pos)->name().str(), oss.str());
+      get_token(prev, json);
+      // stored with the other tokens of this tick by ext_obs_sync
+      m_batch.push_back(helpers::db_manager::token_row(start, date,
+                                                       (*pos)->name().str(),
+                                                       oss.str()));
     }
+    publish_sync(tok, "obs");
   } else
     m_reactor.syslog(utils::log::warn)<<"Received an observation on "<<tok->object()
     <<" which is not declared yet !!!";
 }
 
+void TimelineHistory::flush_sync() {
+  if( m_batch.empty() )
+    return;
+  
+  size_t skipped = 0;
+  try {
+    if( m_store ) {
+      for(helpers::db_manager::token_batch::const_iterator i=m_batch.begin();
+          m_batch.end()!=i; ++i)
+        if( !m_store->add_token(i->start, i->end, i->timeline, i->json) )
+          ++skipped;
+      m_store->flush();
+    } else
+      skipped = m_db.add_tokens(m_batch);
+  } catch(std::exception const &e) {
+    m_reactor.syslog(utils::log::error)<<"Failed to store "<<m_batch.size()
+      <<" tokens: "<<e.what();
+  }
+  if( skipped>0 )
+    m_reactor.syslog(utils::log::warn)<<"Skipped "<<skipped
+      <<" tokens on timelines not in the history.";
+  m_batch.clear();
+}
+
+void TimelineHistory::publish_sync(goal_id tok, std::string kind) {
+  std::ostringstream oss, id;
+  utils::json_writer json(oss, false);
+  
+  id<<tok;
+  json.begin_object();
+  json.key("timeline").value(tok->object().str());
+  json.key("id").value(id.str());
+  json.key("token");
+  get_token(tok, json);
+  json.end_object();
+  m_events->publish(tok->object(), kind, oss.str());
+}
+
 void TimelineHistory::ext_obs_sync(TICK date) {
+  flush_sync();
   m_cur = date;
   IntegerDomain future(date+1, IntegerDomain::plus_inf);
   
@@ -232,6 +304,17 @@ void TimelineHistory::ext_obs_sync(TICK date) {
       m_timelines.end()!=i; ++i)
     if( (*i)->has_observation() )
       (*i)->obs()->restrictEnd(future);
+  
+  // Publish the tick and wake up the stream clients once for all the
+  // events produced during the last tick
+  std::ostringstream oss;
+  utils::json_writer json(oss, false);
+  json.begin_object();
+  json.key("value").value(date);
+  json.key("date").value(m_reactor.date_str(date));
+  json.end_object();
+  m_events->publish(utils::Symbol(), "tick", oss.str());
+  m_events->notify();
 }
 
 unsigned long long TimelineHistory::count_tokens(helpers::timeline_wrap const &tl,
@@ -264,6 +347,8 @@ unsigned long long TimelineHistory::count_tokens(helpers::timeline_wrap const &t
       
       delta_t = hi.value()-lo.value();
       // Now access the domain for the given range
+      if( m_store )
+        return ret + m_store->count(tl.name().str(), lo, hi);
       return ret + m_db.count(tl.name().str(), lo, hi);
     }
   } else {
@@ -275,10 +360,11 @@ unsigned long long TimelineHistory::count_tokens(helpers::timeline_wrap const &t
 
 
 
-size_t TimelineHistory::list_tl_sync(std::ostream &out, std::set<std::string> const &select,
+size_t TimelineHistory::list_tl_sync(utils::json_writer &out, std::set<std::string> const &select,
                                      bool hidden, IntegerDomain rng) {
   size_t count =0;
   
+  flush_sync();
   for(helpers::rest_tl_set::const_iterator i=m_timelines.begin(); m_timelines.end()!=i;
       ++i) {
     bool valid;
@@ -288,25 +374,28 @@ size_t TimelineHistory::list_tl_sync(std::ostream &out, std::set<std::string> co
       valid = select.end()!=select.find((*i)->name().str());
     
     if( valid ) {
-      if( count>0 )
-        out.put(',');
       ++count;
     
       TICK t_l = (*i)->latency(), t_pi = (*i)->look_ahead(), n_ticks;
       unsigned long long cnt = count_tokens(**i, rng, n_ticks);
-        
-      out<<"\n  { \"name\": \""<<(*i)->name()<<"\","
+      
+      out.begin_object();
+      out.key("name").value((*i)->name());
       // href is hard coded .... I dshould be able to do better but will
       // do for now
-         <<"\n    \"href\": \"/rest/timeline/"<<(*i)->name()<<"\","
-         <<"\n    \"alive\": \""<<(*i)->alive()<<"\","
-         <<"\n    \"accept_goals\": \""<<(*i)->accept_goals()<<"\","
-         <<"\n    \"latency\": { \"ticks\": \""<<t_l<<"\", \"duration\": \""
-         <<m_reactor.duration_str(t_l)<<"\" },"
-         <<"\n    \"look_ahead\": { \"ticks\": \""<<t_pi<<"\", \"duration\": \""
-         <<m_reactor.duration_str(t_pi)<<"\" },"
-         <<"\n    \"publish_plan\": \""<<(*i)->publish_plan()<<"\","
-         <<"\n    \"total_obs\": "<<cnt<<",";
+      out.key("href").value("/rest/timeline/"+(*i)->name().str());
+      out.key("alive").value((*i)->alive());
+      out.key("accept_goals").value((*i)->accept_goals());
+      out.key("latency").begin_object();
+      out.key("ticks").value(t_l);
+      out.key("duration").value(m_reactor.duration_str(t_l));
+      out.end_object();
+      out.key("look_ahead").begin_object();
+      out.key("ticks").value(t_pi);
+      out.key("duration").value(m_reactor.duration_str(t_pi));
+      out.end_object();
+      out.key("publish_plan").value((*i)->publish_plan());
+      out.key("total_obs").raw(boost::lexical_cast<std::string>(cnt));
 
       typedef utils::chrono_posix_convert<TeleoReactor::duration_type> convert;
       convert::posix_duration period = convert::to_posix(m_reactor.tickDuration());
@@ -319,8 +408,11 @@ size_t TimelineHistory::list_tl_sync(std::ostream &out, std::set<std::string> co
       } else
         period *= 0;
     
-      out<<"\n    \"obs_period\": { \"ticks\": \""<<factor<<"\", "
-         <<"\"duration\": \""<<period<<"\" }\n  }";
+      out.key("obs_period").begin_object();
+      out.key("ticks").value(factor);
+      out.key("duration").value(period);
+      out.end_object();
+      out.end_object();
     }
   }
   
@@ -348,7 +440,11 @@ size_t TimelineHistory::get_tok_sync(TREX::utils::Symbol tl,
       IntegerDomain::bound date = (*pos)->obs_date();
       if( date>=lo ) {
         // access the database
-        ret = m_db.get_tokens(tl.str(), lo, hi, out, max);
+        flush_sync();
+        if( m_store )
+          ret = m_store->get_tokens(tl.str(), lo, hi, out, max);
+        else
+          ret = m_db.get_tokens(tl.str(), lo, hi, out, max);
         if( ret==max )
           return ret;
         else if( ret>0 )
@@ -361,7 +457,8 @@ size_t TimelineHistory::get_tok_sync(TREX::utils::Symbol tl,
           out.put(',');
 //        else
 //          first = false;
-        utils::write_json(out, get_token((*pos)->obs()), fancy());
+        utils::json_writer json(out, fancy());
+        get_token((*pos)->obs(), json);
         lo = IntegerDomain::plus_inf;
         ret += 1;
       }
@@ -372,12 +469,11 @@ size_t TimelineHistory::get_tok_sync(TREX::utils::Symbol tl,
 }
 
 
-bp::ptree TimelineHistory::goals_sync() {
-  bp::ptree ret;
-  
+void TimelineHistory::goals_sync(utils::json_writer &out) {
+  out.begin_array();
   for(goal_map::const_iterator i=m_goals.begin(); m_goals.end()!=i; ++i)
-    ret.push_back(bp::ptree::value_type("", get_goal(i->second)));
-  return ret;
+    get_goal(i->second, out);
+  out.end_array();
 }
 
 void TimelineHistory::add_goal_sync(goal_id g) {
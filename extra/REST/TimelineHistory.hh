@@ -35,8 +35,12 @@
 # define H_trex_rest_TimelineHistory
 
 # include "db_manager.hh"
+# include "event_stream.hh"
+# include "token_store.hh"
 # include "timeline_wrap.hh"
 
+# include <trex/utils/json_writer.hh>
+
 # include <boost/operators.hpp>
 
 namespace TREX {
@@ -49,8 +53,18 @@ namespace TREX {
       TimelineHistory(REST_reactor &creator);
       ~TimelineHistory();
       
-      void new_obs(transaction::Observation const &obs,
+      void new_obs(transaction::observation_id const &obs,
                    transaction::TICK cur);
+      /** @brief New plan token
+       * @param[in] tok A token
+       * Publish @p tok as a @c plan event of the stream
+       */
+      void new_plan(transaction::goal_id const &tok);
+      /** @brief Cancelled plan token
+       * @param[in] tok A token
+       * Publish @p tok as a @c cancel event of the stream
+       */
+      void cancelled_plan(transaction::goal_id const &tok);
       void update_tick(transaction::TICK cur);
       
       void list_timelines(std::ostream &out, std::set<std::string> const &select, bool hidden,
@@ -64,13 +78,37 @@ namespace TREX {
                       size_t max);
       bool exists(std::string const &name);
       
-      boost::property_tree::ptree get_goal(transaction::goal_id g) const;
-      boost::property_tree::ptree goals();
+      /** @brief Goal description
+       *
+       * @param[in] g A goal
+       * @param[in,out] out A json writer
+       *
+       * Write into @p out the json description of @p g with its id and 
+       * url
+       */
+      void get_goal(transaction::goal_id g, utils::json_writer &out) const;
+      /** @brief Goals list
+       *
+       * @param[in,out] out A json writer
+       *
+       * Write into @p out the json array of all the goals posted 
+       * through this interface
+       */
+      void goals(utils::json_writer &out);
       
       transaction::goal_id add_goal(std::string const &file);
       transaction::goal_id get_goal(std::string const &id);
       bool                 delete_goal(std::string const &id);
       
+      /** @brief Event journal
+       *
+       * The journal where the observations, plan tokens and ticks are 
+       * published for the event stream
+       */
+      SHARED_PTR<helpers::event_journal> const &events() const {
+        return m_events;
+      }
+      
       bool fancy() const {
         return m_fancy;
       }
@@ -79,7 +117,8 @@ namespace TREX {
       }
       
     private:
-      boost::property_tree::ptree get_token(transaction::goal_id const &tok) const;
+      void get_token(transaction::goal_id const &tok,
+                     utils::json_writer &out) const;
       unsigned long long count_tokens(helpers::timeline_wrap const &tl,
                                       transaction::IntegerDomain const &dom,
                                       transaction::TICK &delta_t);
@@ -87,9 +126,18 @@ namespace TREX {
       void declared(transaction::details::timeline const &timeline);
       
       // Bunch of internl calls that need to be thread protected
+      void new_obs_sync(transaction::observation_id obs,
+                        transaction::TICK date);
       void add_obs_sync(transaction::goal_id tok,
                         transaction::TICK date);
       void ext_obs_sync(transaction::TICK date);
+      void publish_sync(transaction::goal_id tok, std::string kind);
+      /** @brief Store pending tokens
+       *
+       * Store all the tokens completed since last call in a single
+       * batch
+       */
+      void flush_sync();
       void add_tl_sync(transaction::details::timeline const &tl);
       size_t get_tok_sync(utils::Symbol tl,
                           transaction::IntegerDomain::bound &lo,
@@ -97,14 +145,14 @@ namespace TREX {
                           std::ostream &out, bool first, size_t max);
       bool exists_sync(utils::Symbol name);
             
-      boost::property_tree::ptree goals_sync();
+      void goals_sync(utils::json_writer &out);
       
       void add_goal_sync(transaction::goal_id g);
       transaction::goal_id get_goal_sync(std::string id);
       transaction::goal_id del_goal_sync(std::string id);
       
       
-      size_t list_tl_sync(std::ostream &out, std::set<std::string> const &select, bool hidden,
+      size_t list_tl_sync(utils::json_writer &out, std::set<std::string> const &select, bool hidden,
                           transaction::IntegerDomain rng);
       
       bool const m_fancy;
@@ -114,7 +162,16 @@ namespace TREX {
       boost::asio::strand m_strand;
       
       helpers::db_manager          m_db;
+      /** @brief Columnar token store
+       *
+       * When set, past tokens are stored there instead of in the
+       * database
+       */
+      UNIQ_PTR<helpers::token_store> m_store;
+      /** @brief Tokens completed during current tick */
+      helpers::db_manager::token_batch m_batch;
       helpers::rest_tl_set         m_timelines;
+      SHARED_PTR<helpers::event_journal> m_events;
       
       typedef std::map<std::string, transaction::goal_id> goal_map;
       goal_map m_goals;
@@ -36,6 +36,8 @@
 
 #include <Wt/Dbo/Dbo>
 
+#include <map>
+
 namespace dbo = Wt::Dbo;
 
 /*
@@ -106,6 +108,32 @@ namespace {
 
 using namespace TREX::REST::helpers;
 
+/*
+ * TREX::REST::helpers::db_manager::timeline_cache
+ */
+
+class db_manager::timeline_cache {
+public:
+  typedef std::map<std::string, dbo::ptr<db_timeline> > map_type;
+  
+  dbo::ptr<db_timeline> get(dbo::Session &s, std::string const &name) {
+    map_type::const_iterator i = m_cache.find(name);
+    if( m_cache.end()!=i )
+      return i->second;
+    // not cached yet : look in the database
+    dbo::ptr<db_timeline> ret = s.find<db_timeline>().where("name = ?").bind(name);
+    if( ret )
+      m_cache[name] = ret;
+    return ret;
+  }
+  void add(std::string const &name, dbo::ptr<db_timeline> const &tl) {
+    m_cache[name] = tl;
+  }
+  
+private:
+  map_type m_cache;
+}; // TREX::REST::helpers::db_manager::timeline_cache
+
 
 /*
  * TREX::REST::helpers::db_manager
@@ -113,7 +141,7 @@ using namespace TREX::REST::helpers;
 
 std::string const db_manager::db_ext(DBO_EXTENSION);
 
-db_manager::db_manager() {}
+db_manager::db_manager():m_timelines(new timeline_cache) {}
 
 db_manager::~db_manager() {}
 
@@ -124,6 +152,12 @@ void db_manager::initialize(std::string const &file_name) {
   m_session.mapClass<db_timeline>("timeline");
   m_session.mapClass<db_token>("token");
   m_session.createTables();
+  
+  // index used by get_tokens and count range queries
+  dbo::Transaction tr(m_session);
+  m_session.execute("create index if not exists token_tl_end"
+                    " on token (timeline_name, \"end\")");
+  tr.commit();
 }
 
 dbo::Session &db_manager::session() {
@@ -134,7 +168,7 @@ void db_manager::add_timeline(std::string const &name) {
   dbo::Transaction tr(m_session);
   
   db_timeline *tmp = new db_timeline(name);
-  m_session.add(tmp);
+  m_timelines->add(name, m_session.add(tmp));
   
   tr.commit();
 }
@@ -146,7 +180,7 @@ void db_manager::add_token(TREX::transaction::TICK start,
   dbo::Transaction tr(m_session);
   
   // get the timeline
-  dbo::ptr<db_timeline> timeline = m_session.find<db_timeline>().where("name = ?").bind(tl);
+  dbo::ptr<db_timeline> timeline = m_timelines->get(m_session, tl);
   if( !timeline )
     throw exception("attempted to add an observation to timeline \""+tl+"\" which is not on the database.");
   db_token *obs = new db_token;
@@ -158,6 +192,30 @@ void db_manager::add_token(TREX::transaction::TICK start,
   tr.commit();
 }
 
+size_t db_manager::add_tokens(db_manager::token_batch const &batch) {
+  size_t skipped = 0;
+  
+  if( !batch.empty() ) {
+    dbo::Transaction tr(m_session);
+    
+    for(token_batch::const_iterator i=batch.begin(); batch.end()!=i; ++i) {
+      dbo::ptr<db_timeline> timeline = m_timelines->get(m_session, i->timeline);
+      
+      if( timeline ) {
+        db_token *obs = new db_token;
+        obs->start = i->start;
+        obs->end = i->end;
+        obs->timeline = timeline;
+        obs->json = i->json;
+        m_session.add(obs);
+      } else
+        ++skipped;
+    }
+    tr.commit();
+  }
+  return skipped;
+}
+
 size_t db_manager::get_tokens(std::string const &tl,
                                        bound &min, bound const &max,
                                        std::ostream &out,
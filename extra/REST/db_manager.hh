@@ -39,6 +39,8 @@
 # include <Wt/Dbo/SqlConnection>
 # include <Wt/Dbo/Session>
 
+# include <list>
+
 namespace TREX {
   namespace REST {
     namespace helpers {
@@ -70,9 +72,32 @@ namespace TREX {
           return &session();
         }
         
+        /** @brief A token to be stored */
+        struct token_row {
+          token_row(transaction::TICK s, transaction::TICK e,
+                    std::string const &tl, std::string const &j)
+          :start(s), end(e), timeline(tl), json(j) {}
+          
+          transaction::TICK start, end;
+          std::string       timeline;
+          std::string       json;
+        }; // TREX::REST::helpers::db_manager::token_row
+        typedef std::list<token_row> token_batch;
+        
         void add_timeline(std::string const &name);
         void add_token(transaction::TICK start, transaction::TICK end,
                        std::string const &tl, std::string const &json);
+        /** @brief Store a batch of tokens
+         *
+         * @param[in] batch A list of tokens
+         *
+         * Store all the tokens of @p batch within a single transaction. 
+         * The tokens associated to a timeline that is not in the database 
+         * are skipped.
+         *
+         * @return the number of tokens skipped
+         */
+        size_t add_tokens(token_batch const &batch);
         
         typedef transaction::IntegerDomain::bound bound;
         
@@ -82,8 +107,16 @@ namespace TREX {
         unsigned long long count(std::string const &name, bound const &min, bound const &max);
         
       private:
+        class timeline_cache;
+        
         UNIQ_PTR<Wt::Dbo::SqlConnection> m_db;
         Wt::Dbo::Session                 m_session;
+        /** @brief Timelines handles
+         *
+         * The timelines already loaded from the database so storing a token 
+         * does not need to look up its timeline
+         */
+        UNIQ_PTR<timeline_cache>         m_timelines;
       };
       
     }
@@ -0,0 +1,196 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ * 
+ *  Copyright (c) 2013, MBARI.
+ *  All rights reserved.
+ * 
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ * 
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the TREX Project nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ * 
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "event_stream.hh"
+
+#include <boost/lexical_cast.hpp>
+
+using namespace TREX::REST;
+using helpers::event_journal;
+
+namespace {
+  
+  /** @brief Maximum number of events sent in one chunk */
+  size_t const chunk_events = 64;
+  
+  void write_event(std::ostream &out, event_journal::event_id id,
+                   std::string const &kind, std::string const &data) {
+    out<<"id: "<<id<<"\nevent: "<<kind<<"\ndata: "<<data<<"\n\n";
+  }
+  
+}
+
+/*
+ * class TREX::REST::helpers::event_journal
+ */
+
+// structors
+
+event_journal::event_journal(size_t capacity)
+:m_capacity(capacity), m_last(0) {}
+
+// observers
+
+event_journal::event_id event_journal::last_id() const {
+  boost::mutex::scoped_lock lock(m_mtx);
+  return m_last;
+}
+
+event_journal::event_id event_journal::fetch(event_journal::event_id &last,
+                                             std::set<utils::Symbol> const &filter,
+                                             size_t max,
+                                             std::vector<event_journal::event> &out) const {
+  boost::mutex::scoped_lock lock(m_mtx);
+  event_id lost = 0;
+  
+  if( m_events.empty() || m_events.back().id<=last )
+    return 0;
+  
+  std::deque<event>::const_iterator i = m_events.begin();
+  
+  if( i->id>last+1 )
+    // the events after last are already gone
+    lost = i->id-last-1;
+  else
+    // ids are contiguous
+    i += last+1-i->id;
+  for( ; m_events.end()!=i && max>0; ++i) {
+    last = i->id;
+    if( i->timeline.empty() || filter.empty() ||
+        filter.end()!=filter.find(i->timeline) ) {
+      out.push_back(*i);
+      --max;
+    }
+  }
+  return lost;
+}
+
+bool event_journal::wait_after(event_journal::event_id last,
+                               boost::function<void ()> const &wait) const {
+  boost::mutex::scoped_lock lock(m_mtx);
+  if( last<m_last )
+    return false;
+  wait();
+  return true;
+}
+
+// modifiers
+
+void event_journal::publish(utils::Symbol const &tl, std::string const &kind,
+                            std::string const &json) {
+  boost::mutex::scoped_lock lock(m_mtx);
+  m_events.push_back(event(++m_last, tl, kind, json));
+  if( m_events.size()>m_capacity )
+    m_events.pop_front();
+}
+
+/*
+ * class TREX::REST::event_service
+ */
+
+struct event_service::client {
+  explicit client(event_journal::event_id l):last(l) {}
+  
+  event_journal::event_id  last;
+  std::set<utils::Symbol>  filter;
+};
+
+// structors
+
+event_service::event_service(SHARED_PTR<event_journal> const &journal)
+:rest_service("Stream of the agent events as Server-Sent Events.\n"
+              "Events are tick, obs, plan and cancel.\n"
+              "Optional args are the timelines to follow.\n"
+              "Example: /rest/stream/navigator"),
+ m_journal(journal) {
+   m_conn = m_journal->on_notify().connect(boost::bind(&event_service::new_events, this));
+}
+
+event_service::~event_service() {
+  m_conn.disconnect();
+  beingDeleted();
+}
+
+// manipulators
+
+void event_service::handleRequest(rest_request const &req,
+                                  std::ostream &data,
+                                  Wt::Http::Response &ans) {
+  Wt::Http::ResponseContinuation *cont = req.request().continuation();
+  SHARED_PTR<client> me;
+  
+  if( cont )
+    me = boost::any_cast< SHARED_PTR<client> >(cont->data());
+  else {
+    me.reset(new client(m_journal->last_id()));
+    
+    rest_request::path_type tmp(req.arg_path());
+    while( !tmp.empty() )
+      me->filter.insert(utils::Symbol(tmp.reduce()));
+    
+    // Resume after the last event received before a reconnection
+    std::string resume = req.request().headerValue("Last-Event-ID");
+    if( !resume.empty() ) {
+      try {
+        event_journal::event_id id = boost::lexical_cast<event_journal::event_id>(resume);
+        if( id<me->last )
+          me->last = id;
+      } catch(boost::bad_lexical_cast const &e) {
+        // silently ignore and start from now
+      }
+    }
+    ans.setMimeType("text/event-stream");
+    ans.addHeader("Cache-Control", "no-cache");
+    // comment line so the client gets the headers at once
+    data<<": trex events\n\n";
+  }
+  
+  std::vector<event_journal::event> events;
+  event_journal::event_id lost = m_journal->fetch(me->last, me->filter,
+                                                  chunk_events, events);
+  if( lost>0 )
+    data<<"event: lagged\ndata: {\"missed\": \""<<lost<<"\"}\n\n";
+  for(std::vector<event_journal::event>::const_iterator i=events.begin();
+      events.end()!=i; ++i)
+    write_event(data, i->id, i->kind, i->data);
+  
+  // Wt calls back on this continuation only once this chunk is sent
+  cont = ans.createContinuation();
+  cont->setData(me);
+  // nothing pending : wait for the next notification. This is done
+  // under the journal lock so a notification cannot fall between the
+  // test and the wait
+  m_journal->wait_after(me->last,
+                        boost::bind(&Wt::Http::ResponseContinuation::waitForMoreData,
+                                    cont));
+}
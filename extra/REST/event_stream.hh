@@ -0,0 +1,212 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ * 
+ *  Copyright (c) 2013, MBARI.
+ *  All rights reserved.
+ * 
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ * 
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the TREX Project nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ * 
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef H_trex_rest_event_stream
+# define H_trex_rest_event_stream
+
+# include "REST_service.hh"
+
+# include <trex/utils/Symbol.hh>
+
+# include <deque>
+# include <set>
+# include <vector>
+
+# include <boost/function.hpp>
+# include <boost/signals2/signal.hpp>
+# include <boost/thread/mutex.hpp>
+# include <boost/utility.hpp>
+
+namespace TREX {
+  namespace REST {
+    namespace helpers {
+      
+      /** @brief Bounded journal of the REST events
+       *
+       * This class keeps the last events produced by the agent -- new 
+       * observations, plan tokens and ticks -- as already serialized json 
+       * and identified by an increasing sequence number. Clients of the 
+       * event stream keep track of the last event they received and fetch 
+       * the ones that follow.
+       *
+       * The journal holds at most a fixed number of events. A client that 
+       * falls further behind than this capacity loses the oldest events 
+       * and is told how many it missed. This bounds the memory used for 
+       * slow clients regardless of how many are connected.
+       *
+       * Events are published from the TimelineHistory strand while 
+       * clients fetch them from the Wt threads: all the accesses are 
+       * protected by a mutex.
+       */
+      class event_journal :boost::noncopyable {
+      public:
+        typedef unsigned long long event_id;
+        typedef boost::signals2::signal<void ()> notify_event;
+        
+        /** @brief Journal event */
+        struct event {
+          event(event_id i, utils::Symbol const &tl, std::string const &k,
+                std::string const &d)
+          :id(i), timeline(tl), kind(k), data(d) {}
+          
+          /** @brief Sequence number */
+          event_id      id;
+          /** @brief Timeline of the event
+           *
+           * This is empty for events not related to a timeline such as 
+           * the ticks
+           */
+          utils::Symbol timeline;
+          /** @brief Event type */
+          std::string   kind;
+          /** @brief Single line json content */
+          std::string   data;
+        };
+        
+        /** @brief Constructor
+         *
+         * @param[in] capacity Maximum number of events kept
+         */
+        explicit event_journal(size_t capacity);
+        ~event_journal() {}
+        
+        /** @brief Add a new event
+         *
+         * @param[in] tl A timeline (or an empty symbol)
+         * @param[in] kind The event type
+         * @param[in] json The event content
+         *
+         * Add a new event at the end of this journal, dropping the 
+         * oldest event when full. Clients are not notified until 
+         * notify() is called.
+         */
+        void publish(utils::Symbol const &tl, std::string const &kind,
+                     std::string const &json);
+        /** @brief Notify clients
+         *
+         * Indicates to the clients waiting for events that new ones 
+         * were published. This allows to wake up the clients once for 
+         * all the events of a tick.
+         */
+        void notify() {
+          m_notify();
+        }
+        notify_event &on_notify() {
+          return m_notify;
+        }
+        
+        /** @brief Last event id
+         * @return The id of the last event published
+         */
+        event_id last_id() const;
+        /** @brief Read events
+         *
+         * @param[in,out] last The last event received by the client
+         * @param[in] filter Timelines of interest
+         * @param[in] max Maximum number of events to read
+         * @param[out] out Where the events are appended
+         *
+         * Append to @p out at most @p max of the events following @p last 
+         * and related to a timeline in @p filter (all the timelines when 
+         * @p filter is empty). Events not related to a timeline always 
+         * pass the filter. On completion @p last is the last event 
+         * examined.
+         *
+         * @return The number of events following @p last that were 
+         *         already dropped from the journal
+         */
+        event_id fetch(event_id &last, std::set<utils::Symbol> const &filter,
+                       size_t max, std::vector<event> &out) const;
+        /** @brief Wait for new events
+         *
+         * @param[in] last The last event received by the client
+         * @param[in] wait Arms the wait of the client
+         *
+         * Calls @p wait when no event was published after @p last. The 
+         * test and the call are made while holding the journal lock so 
+         * an event published concurrently is either seen by the test or 
+         * notified after @p wait returned.
+         *
+         * @retval true if @p wait was called
+         * @retval false if events were published after @p last
+         */
+        bool wait_after(event_id last, 
+                        boost::function<void ()> const &wait) const;
+        
+      private:
+        mutable boost::mutex m_mtx;
+        size_t const         m_capacity;
+        std::deque<event>    m_events;
+        event_id             m_last;
+        notify_event         m_notify;
+      }; // TREX::REST::helpers::event_journal
+      
+    } // TREX::REST::helpers
+    
+    /** @brief Server-sent events service
+     *
+     * This service sends the events of an event_journal to the client 
+     * as a Server-Sent Events stream (text/event-stream) that stays 
+     * open. The client can restrict the stream to some timelines by 
+     * giving them as arguments (ex: /rest/stream/navigator/state) and 
+     * resume after a reconnection using the Last-Event-ID header.
+     *
+     * Each chunk sent holds a bounded number of events and the next one 
+     * is only produced by Wt after the previous one was written to the 
+     * client. A slow client therefore never has more than one chunk 
+     * pending and, when it falls behind the journal capacity, receives a 
+     * @c lagged event with the number of events it missed.
+     */
+    class event_service :public rest_service {
+    public:
+      event_service(SHARED_PTR<helpers::event_journal> const &journal);
+      ~event_service();
+      
+    private:
+      struct client;
+      
+      void handleRequest(rest_request const &req,
+                         std::ostream &data,
+                         Wt::Http::Response &ans);
+      void new_events() {
+        haveMoreData();
+      }
+      
+      SHARED_PTR<helpers::event_journal> m_journal;
+      boost::signals2::connection        m_conn;
+    }; // TREX::REST::event_service
+    
+  } // TREX::REST
+} // TREX
+
+#endif // H_trex_rest_event_stream
@@ -142,6 +142,10 @@ void timeline_service::handleRequest(rest_request const &req,
   now = ptr->now();
   
   bool first = true;
+  // number of tokens per page : 0 means that the whole range is
+  // streamed through continuations
+  size_t limit = 0;
+  
   if( cont ) {
     SHARED_PTR<transaction::IntegerDomain> range;
     range = boost::any_cast< SHARED_PTR<transaction::IntegerDomain> >(cont->data());
@@ -149,24 +153,52 @@ void timeline_service::handleRequest(rest_request const &req,
     range->getBounds(lo, hi);
     first = false;
   } else {
+    std::string const *value;
+    
     temporal_bounds(req.request(), lo, hi, ptr);
-    if( lo.isInfinity() ) {
+    value = req.request().getParameter("cursor");
+    if( NULL!=value )
+      // the cursor is the tick given by the previous page
+      lo = parse_date("cursor", *value, false, ptr);
+    else if( lo.isInfinity() ) {
       if( hi>=now )
         lo = now;
     }
+    value = req.request().getParameter("limit");
+    if( NULL!=value ) {
+      try {
+        limit = boost::lexical_cast<size_t>(*value);
+      } catch(boost::bad_lexical_cast const &e) {
+        throw std::runtime_error("Failed to parse limit="+(*value)+" as a positive integer.");
+      }
+      if( 0==limit )
+        throw std::runtime_error("limit should be greater than 0.");
+    }
     
     ans.setMimeType("application/json");
     transaction::IntegerDomain initial(lo, hi);
     // As it is the start I need to add initial info to the stream
-    data<<"{\n \"name\": \""<<req.arg_path().dump()
-    <<"\",\"requested_tick_range\": ";
+    data<<"{\n \"name\": ";
+    utils::json_writer::quote(data, req.arg_path().dump());
+    data<<",\"requested_tick_range\": ";
     if( initial.isFull() )
       data<<"{}";
-    else
-      utils::write_json(data, initial.as_tree(), ptr->fancy());
+    else {
+      utils::json_writer json(data, ptr->fancy());
+      json.tree(initial.as_tree());
+    }
     data<<",\n \"tokens\": [\n";
   }
   
+  if( limit>0 ) {
+    // Paginated request : send one page and the cursor of the next one
+    ptr->get_tokens(req.arg_path().dump(), lo, hi, data, true, limit);
+    data<<" ]";
+    if( transaction::IntegerDomain::plus_inf!=lo && lo<=hi )
+      data<<",\n \"next\": \""<<lo.value()<<'"';
+    data<<"\n}";
+    return;
+  }
   ptr->get_tokens(req.arg_path().dump(), lo, hi,
                   data, first, 10);
   if( transaction::IntegerDomain::plus_inf==lo || hi<lo ) {
@@ -190,19 +222,12 @@ void goals_service::handleRequest(rest_request const &req,
   if( !ptr )
     throw std::runtime_error("Entry point to trex has been destroyed.\n"
                              "This probaly means that trex is terminating.");
-  bp::ptree goals = ptr->goals();
+  utils::json_writer json(data, ptr->fancy());
+  
   ans.setMimeType("application/json");
-
-  if( goals.empty() )
-    // handle spacial case where there is no goal
-    data<<"{ \"goals\": [] }";
-  else {
-    bp::ptree result;
-    helpers::json_stream json(data);
-    
-    result.put_child("goals", goals);
-    TREX::utils::write_json(json, result, ptr->fancy());
-  }
+  json.begin_object().key("goals");
+  ptr->goals(json);
+  json.end_object();
 }
 
 
@@ -233,7 +258,7 @@ void goal_service::handleRequest(rest_request const &req,
     throw std::runtime_error("Entry point to trex has been destroyed.\n"
                              "This probaly means that trex is terminating.");
   std::string kind = req.request().method();
-  helpers::json_stream json(data);
+  utils::json_writer json(data, ptr->fancy());
   
   if( "POST"==kind ) {
     if( "application/json"!=req.request().contentType() )       
@@ -247,7 +272,7 @@ void goal_service::handleRequest(rest_request const &req,
     }
     TREX::transaction::goal_id g = ptr->add_goal(file);
     ans.setMimeType("application/json");
-    utils::write_json(json, ptr->get_goal(g), ptr->fancy());
+    ptr->get_goal(g, json);
   } else if( "DELETE"==kind ) {
     std::string id = req.arg_path().dump();
     ans.setMimeType("application/json");
@@ -255,8 +280,10 @@ void goal_service::handleRequest(rest_request const &req,
       <<"  \"deleted\": \""<<ptr->delete_goal(id)<<"\"\n}";
   } else if( "GET"==kind ) {
     TREX::transaction::goal_id g = ptr->get_goal(req.arg_path().dump());
+    if( !g )
+      throw rest_not_found("Unknown goal "+req.arg_path().dump());
     ans.setMimeType("application/json");
-    utils::write_json(json, ptr->get_goal(g), ptr->fancy());
+    ptr->get_goal(g, json);
   } else
     throw std::runtime_error("Do not know how to handle request method "+kind);
 }
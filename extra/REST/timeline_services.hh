@@ -65,7 +65,10 @@ namespace TREX {
       :rest_service("Give state history of the timeline.\nOptioanl args are:\n"
                     " - format: format indicator (tick or date)\n"
                     " - from: initial tick of the requested range\n"
-                    " - to: last tick of the requested range"), m_entry(ref) {}
+                    " - to: last tick of the requested range\n"
+                    " - limit: maximum number of tokens in the response. The\n"
+                    "   response then gives the cursor of the next page\n"
+                    " - cursor: tick where to resume a paginated request"), m_entry(ref) {}
       ~timeline_service() {
         beingDeleted();
       }
@@ -0,0 +1,295 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ * 
+ *  Copyright (c) 2013, MBARI.
+ *  All rights reserved.
+ * 
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ * 
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the TREX Project nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ * 
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "token_store.hh"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include <boost/tuple/tuple.hpp>
+
+using namespace TREX::REST::helpers;
+using TREX::transaction::TICK;
+using TREX::transaction::IntegerDomain;
+
+namespace {
+  
+  /** @brief Column based row comparator
+   *
+   * Compare rows of a segment through the value of one of their columns
+   */
+  struct by_column {
+    explicit by_column(std::vector<TICK> const &col):m_col(col) {}
+    
+    bool operator()(size_t row, TICK val) const {
+      return m_col[row]<val;
+    }
+    bool operator()(TICK val, size_t row) const {
+      return val<m_col[row];
+    }
+    
+  private:
+    std::vector<TICK> const &m_col;
+  }; // <unnamed>::by_column
+  
+}
+
+/*
+ * class TREX::REST::helpers::token_store::segment
+ */
+
+class token_store::segment :boost::noncopyable {
+public:
+  typedef std::vector<size_t>   rows;
+  typedef rows::const_iterator  row_iterator;
+  
+  explicit segment(boost::filesystem::path const &file)
+  :m_file(file), m_bytes(0) {}
+  ~segment() {}
+  
+  void append(TICK start, TICK end, unsigned tl, std::string const &json) {
+    if( !m_out.is_open() ) {
+      std::ios_base::openmode mode = std::ios_base::out|std::ios_base::binary;
+      // the file is new on the first append 
+      mode |= (0==m_bytes)?std::ios_base::trunc:std::ios_base::app;
+      m_out.open(m_file.string().c_str(), mode);
+    }
+    size_t row = m_start.size();
+    
+    m_start.push_back(start);
+    m_end.push_back(end);
+    m_offset.push_back(m_bytes);
+    m_length.push_back(json.size());
+    m_out.write(json.data(), json.size());
+    m_out.put('\n');
+    m_bytes += json.size()+1;
+    
+    // maintain the rows of tl sorted by end
+    rows &idx = m_index[tl];
+    if( idx.empty() || !(end<m_end[idx.back()]) )
+      idx.push_back(row);
+    else
+      idx.insert(std::upper_bound(idx.begin(), idx.end(), end, 
+                                  by_column(m_end)), row);
+  }
+  
+  void flush() {
+    if( m_out.is_open() )
+      m_out.flush();
+  }
+  void seal() {
+    if( m_out.is_open() )
+      m_out.close();
+  }
+  void release() {
+    if( m_in.is_open() )
+      m_in.close();
+  }
+  
+  /** @brief Rows in range
+   *
+   * @param[in] tl A timeline id
+   * @param[in] min lowest token end
+   * @param[in] max highest token start
+   * @param[out] last set to @c true if tokens of @p tl beyond this 
+   *             range are all starting after @p max
+   *
+   * @return the rows of @p tl that end after @p min and start before 
+   *         @p max sorted by end
+   */
+  std::pair<row_iterator, row_iterator> range(unsigned tl, bound const &min,
+                                              bound const &max, 
+                                              bool &last) const {
+    std::map<unsigned, rows>::const_iterator i = m_index.find(tl);
+    
+    last = false;
+    if( m_index.end()==i ) {
+      static rows const none;
+      return std::make_pair(none.begin(), none.end());
+    }
+    
+    row_iterator lo = i->second.begin(), hi = i->second.end();
+    
+    if( !min.isInfinity() )
+      lo = std::lower_bound(lo, hi, min.value(), by_column(m_end));
+    if( !max.isInfinity() ) {
+      // tokens of a timeline are chronological : start is sorted too
+      hi = std::upper_bound(lo, hi, max.value(), by_column(m_start));
+      last = i->second.end()!=hi;
+    }
+    return std::make_pair(lo, hi);
+  }
+  
+  TICK end(size_t row) const {
+    return m_end[row];
+  }
+  
+  void write(size_t row, std::ostream &out) {
+    flush();
+    if( !m_in.is_open() )
+      m_in.open(m_file.string().c_str(), std::ios_base::in|std::ios_base::binary);
+    m_in.clear();
+    m_in.seekg(m_offset[row]);
+    
+    std::vector<char> buff(m_length[row]);
+    if( !buff.empty() ) {
+      m_in.read(&buff[0], buff.size());
+      out.write(&buff[0], m_in.gcount());
+    }
+  }
+  
+private:
+  boost::filesystem::path m_file;
+  std::ofstream           m_out;
+  std::ifstream           m_in;
+  size_t                  m_bytes;
+  
+  std::vector<TICK>       m_start, m_end;
+  std::vector<size_t>     m_offset, m_length;
+  std::map<unsigned, rows> m_index;
+}; // TREX::REST::helpers::token_store::segment
+
+/*
+ * class TREX::REST::helpers::token_store
+ */
+
+// structors
+
+token_store::token_store(boost::filesystem::path const &dir, TICK seg_ticks)
+:m_dir(dir), m_seg_ticks(seg_ticks>0?seg_ticks:1), m_size(0) {
+  boost::filesystem::create_directories(m_dir);
+}
+
+token_store::~token_store() {}
+
+// modifiers
+
+void token_store::add_timeline(std::string const &name) {
+  m_names.insert(std::make_pair(name, m_names.size()));
+}
+
+bool token_store::add_token(TICK start, TICK end, std::string const &tl,
+                            std::string const &json) {
+  std::map<std::string, unsigned>::const_iterator n = m_names.find(tl);
+  
+  if( m_names.end()==n )
+    return false;
+  
+  TICK k = key(end);
+  segment_map::iterator pos = m_segments.find(k);
+  
+  if( m_segments.end()==pos ) {
+    // a new segment starts : the previous one is complete
+    if( !m_segments.empty() && m_segments.rbegin()->first<k )
+      m_segments.rbegin()->second->seal();
+    std::ostringstream name;
+    name<<"seg_"<<k<<".json";
+    pos = m_segments.insert(std::make_pair(k, MAKE_SHARED<segment>(m_dir/name.str()))).first;
+  }
+  pos->second->append(start, end, n->second, json);
+  if( m_segments.rbegin()->first!=k ) 
+    pos->second->seal(); // late token in an older segment 
+  ++m_size;
+  return true;
+}
+
+void token_store::flush() {
+  if( !m_segments.empty() )
+    m_segments.rbegin()->second->flush();
+}
+
+// observers
+
+TICK token_store::key(TICK date) const {
+  if( date<0 )
+    return -((-date-1)/m_seg_ticks)-1;
+  return date/m_seg_ticks;
+}
+
+token_store::segment_map::const_iterator token_store::first_segment(bound const &min) const {
+  if( min.isInfinity() )
+    return m_segments.begin();
+  return m_segments.lower_bound(key(min.value()));
+}
+
+size_t token_store::get_tokens(std::string const &tl, bound &min,
+                               bound const &max, std::ostream &out,
+                               size_t max_count) {
+  std::map<std::string, unsigned>::const_iterator n = m_names.find(tl);
+  
+  if( max<min || min==IntegerDomain::plus_inf || m_names.end()==n ) {
+    min = IntegerDomain::plus_inf; // set min to +inf so caller know that he is done
+    return 0;
+  }
+  size_t cpt = 0;
+  bool last = false;
+  TICK last_end = 0;
+  
+  for(segment_map::const_iterator s=first_segment(min);
+      m_segments.end()!=s && cpt<max_count && !last; ++s) {
+    segment::row_iterator i, end;
+    boost::tie(i, end) = s->second->range(n->second, min, max, last);
+    
+    for( ; end!=i && cpt<max_count; ++i, ++cpt) {
+      if( cpt>0 )
+        out.put(',');
+      s->second->write(*i, out);
+      last_end = s->second->end(*i);
+    }
+    s->second->release();
+  }
+  if( cpt<max_count )
+    min = IntegerDomain::plus_inf; // if count is less than our max then we know that we are done
+  else
+    min = last_end+1;
+  return cpt;
+}
+
+unsigned long long token_store::count(std::string const &tl, bound const &min,
+                                      bound const &max) {
+  std::map<std::string, unsigned>::const_iterator n = m_names.find(tl);
+  unsigned long long ret = 0;
+  
+  if( m_names.end()!=n && !(max<min) ) {
+    bool last = false;
+    for(segment_map::const_iterator s=first_segment(min);
+        m_segments.end()!=s && !last; ++s) {
+      segment::row_iterator i, end;
+      boost::tie(i, end) = s->second->range(n->second, min, max, last);
+      ret += std::distance(i, end);
+    }
+  }
+  return ret;
+}
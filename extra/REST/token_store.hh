@@ -0,0 +1,166 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ * 
+ *  Copyright (c) 2013, MBARI.
+ *  All rights reserved.
+ * 
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ * 
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the TREX Project nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ * 
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef H_trex_rest_token_store
+# define H_trex_rest_token_store
+
+# include <trex/transaction/Tick.hh>
+# include <trex/utils/platform/memory.hh>
+
+# include <map>
+# include <ostream>
+
+# include <boost/filesystem.hpp>
+# include <boost/utility.hpp>
+
+namespace TREX {
+  namespace REST {
+    namespace helpers {
+      
+      /** @brief Append only token history
+       *
+       * A columnar store for the past tokens of the REST timelines. 
+       * Tokens are appended in segments each covering a fixed number of 
+       * ticks of the tokens end. Within a segment the start, end and 
+       * timeline of the tokens are kept in memory as separate columns 
+       * along with, for each timeline, the list of its rows sorted by end. 
+       * The json of the tokens is appended to a file per segment and only 
+       * read back when a query needs it.
+       *
+       * This allows to answer range queries on a timeline by only looking 
+       * at the segments overlapping the range and a binary search within 
+       * each of them, without the per token transaction cost of the 
+       * database.
+       *
+       * @note Range queries assume that the tokens of a timeline are 
+       *       appended in chronological order, which is the case for the 
+       *       observations stored by TimelineHistory
+       *
+       * @sa db_manager
+       */
+      class token_store :boost::noncopyable {
+      public:
+        typedef transaction::IntegerDomain::bound bound;
+        
+        /** @brief Constructor
+         *
+         * @param[in] dir The directory where segment files are written
+         * @param[in] seg_ticks The number of ticks covered by a segment
+         */
+        token_store(boost::filesystem::path const &dir,
+                    transaction::TICK seg_ticks);
+        /** @brief Destructor */
+        ~token_store();
+        
+        /** @brief Declare a timeline
+         *
+         * @param[in] name A timeline name
+         */
+        void add_timeline(std::string const &name);
+        /** @brief Append a token
+         *
+         * @param[in] start The token start
+         * @param[in] end The token end
+         * @param[in] tl The token timeline
+         * @param[in] json The token json description
+         *
+         * @retval true the token was stored
+         * @retval false @p tl is not a declared timeline
+         */
+        bool add_token(transaction::TICK start, transaction::TICK end,
+                       std::string const &tl, std::string const &json);
+        /** @brief Flush segment files
+         *
+         * Ensure that all the tokens appended so far are written to their 
+         * segment file
+         */
+        void flush();
+        
+        /** @brief Get tokens
+         *
+         * @param[in] tl A timeline name
+         * @param[in,out] min The lowest token end
+         * @param[in] max The highest token start
+         * @param[out] out The output stream
+         * @param[in] max_count The maximum number of tokens
+         *
+         * Write in @p out as a comma separated list the json of at most 
+         * @p max_count tokens of @p tl that end after @p min and start 
+         * before @p max in the order of their end. @p min is then updated 
+         * to the next end to query or to @c plus_inf if there's no more 
+         * tokens in the range. 
+         *
+         * @return the number of tokens written
+         */
+        size_t get_tokens(std::string const &tl, bound &min, bound const &max,
+                          std::ostream &out, size_t max_count=100);
+        /** @brief Count tokens
+         *
+         * @param[in] tl A timeline name
+         * @param[in] min The lowest token end
+         * @param[in] max The highest token start
+         *
+         * @return the number of tokens of @p tl that end after @p min and 
+         *         start before @p max 
+         */
+        unsigned long long count(std::string const &tl, bound const &min,
+                                 bound const &max);
+        
+        /** @brief Number of tokens
+         * @return the total number of tokens stored
+         */
+        size_t size() const {
+          return m_size;
+        }
+        
+      private:
+        class segment;
+        typedef SHARED_PTR<segment>              segment_ref;
+        typedef std::map<transaction::TICK, segment_ref> segment_map;
+        
+        transaction::TICK key(transaction::TICK date) const;
+        segment &get_segment(transaction::TICK end);
+        segment_map::const_iterator first_segment(bound const &min) const;
+        
+        boost::filesystem::path           m_dir;
+        transaction::TICK                 m_seg_ticks;
+        std::map<std::string, unsigned>   m_names;
+        segment_map                       m_segments;
+        size_t                            m_size;
+      }; // TREX::REST::helpers::token_store
+      
+    }
+  }
+}
+
+#endif // H_trex_rest_token_store
@@ -42,6 +42,8 @@
 
 #include <iterator>
 #include <limits>
+#include <map>
+#include <set>
 
 #include <trex/utils/chrono_helper.hh>
 
@@ -51,6 +53,7 @@
 
 #include <boost/thread.hpp>
 #include <boost/bind.hpp>
+#include <boost/exception_ptr.hpp>
 
 
 using namespace TREX::agent;
@@ -163,6 +166,8 @@ namespace TREX {
          *
          * @param[in,out] sync_order A reference to the list where the schduling
          *                           order should be stored
+         * @param[in] new_tick A flag indicating if @c newTick() should be
+         *                     called on the reactors
          *
          * Create A new instance that will put the reactor synchronization
          * scheduling into the list referred by @p sync_order
@@ -172,8 +177,8 @@ namespace TREX {
          *       Otherwise we would loose the information of this scheduling as
          *       soon as the search complete.
          */
-        explicit sync_scheduller(reactor_queue &sync_order)
-        :m_sync(&sync_order) {}
+        explicit sync_scheduller(reactor_queue &sync_order, bool new_tick=true)
+        :m_sync(&sync_order), m_tick(new_tick) {}
         /** @briief Copy constructor
          *
          * @param[in] other Another instance
@@ -181,7 +186,7 @@ namespace TREX {
          * Create new instance referring to the same scheduling list as @p other
          */
         sync_scheduller(sync_scheduller const &other)
-        :CycleDetector(other), m_sync(other.m_sync) {}
+        :CycleDetector(other), m_sync(other.m_sync), m_tick(other.m_tick) {}
         /** @brief Destructor */
         virtual ~sync_scheduller() {}
         
@@ -198,7 +203,7 @@ namespace TREX {
           // First encounter with r :
           //   - inform him that a new tick has started
           //        this will result on dispatching its goals if possible
-          if( is_valid(r,g) )
+          if( m_tick && is_valid(r,g) )
             if( !r->newTick() )
               g.isolate(r);
         }
@@ -223,10 +228,214 @@ namespace TREX {
       private:
         /** @brief Reference to scheduling list */
         reactor_queue               *m_sync;
+        /** @brief Do we need to call newTick */
+        bool                         m_tick;
         
         sync_scheduller(); // no code in purpose
       };
-      
+
+      /** @brief Parallel reactor synchronization
+       *
+       * This class executes the synchronization of the reactors produced by
+       * a sync_scheduller on a thread pool. A reactor is synchronized as soon
+       * as all the reactors owning one of its @e External timelines have
+       * completed their own synchronization. As a result reactors that do
+       * not share any timeline dependency are synchronized concurrently
+       * while the order imposed by the reactor graph is preserved.
+       *
+       * The dependencies are extracted from the graph relations during
+       * build() which -- as any access to the graph structure -- should be
+       * executed within the graph strand.
+       *
+       * @note The threads of the pool should not be the ones running the
+       *       graph strand : the reactor synchronization blocks on the strand
+       *       and sharing the same threads could result on a dead-lock.
+       *
+       * @ingroup agent
+       * @relates class Agent
+       * @sa sync_scheduller
+       */
+      class sync_dag :boost::noncopyable {
+      public:
+        typedef graph::reactor_id          reactor_id;
+        typedef std::list<reactor_id>      reactor_queue;
+        typedef Agent::priority_queue      work_queue;
+
+        typedef boost::function<bool (reactor_id)> sync_fn;
+        typedef boost::function<double (reactor_id)> ratio_fn;
+        
+        /** @brief Constructor
+         *
+         * @param[in] g The graph the reactors belong to
+         * @param[in] sync The function synchronizing a reactor
+         * @param[in] ratio The function computing a reactor work ratio
+         */
+        sync_dag(graph &g, sync_fn const &sync, ratio_fn const &ratio)
+        :m_graph(g), m_sync(sync), m_ratio(ratio), m_remaining(0),
+        m_running(0), m_pool(NULL) {}
+        /** @brief Destructor */
+        ~sync_dag() {}
+
+        /** @brief Build the dependencies
+         *
+         * @param[in] order A valid synchronization order
+         *
+         * Extract the dependencies between all the reactors in @p order.
+         *
+         * @pre This call is made within the graph strand
+         */
+        void build(reactor_queue const &order);
+        /** @brief Execute the synchronization
+         *
+         * @param[in] pool The service used to execute the synchronizations
+         * @param[out] edf The queue where reactors with work are inserted
+         * @param[out] idle The list where reactors without work are inserted
+         *
+         * Synchronizes all the reactors and block until all of them completed.
+         * A reactor that failed to synchronize is killed before any of the
+         * reactors depending on it is synchronized, as the sequential
+         * synchronization does. Killing a reactor modifies the graph the
+         * other synchronizations are traversing : no new synchronization is
+         * started while a failed reactor waits to be killed and the kill
+         * occurs on the calling thread once the running ones completed.
+         *
+         * @retval true if at least one reactor has been killed
+         * @retval false otherwise
+         *
+         * @throw an exception produced while computing a reactor work ratio
+         */
+        bool execute(boost::asio::io_service &pool,
+                     work_queue &edf, reactor_queue &idle);
+
+      private:
+        struct node {
+          node():pending(0) {}
+
+          size_t                pending;
+          std::set<reactor_id>  dependents;
+        };
+        typedef std::map<reactor_id, node> node_map;
+
+        void launch(reactor_id r);
+        void run(reactor_id r);
+        void completed(reactor_id r);
+
+        graph                    &m_graph;
+        sync_fn                   m_sync;
+        ratio_fn                  m_ratio;
+        node_map                  m_nodes;
+        size_t                    m_remaining, m_running;
+        reactor_queue             m_failed, m_held;
+        boost::exception_ptr      m_error;
+
+        boost::asio::io_service  *m_pool;
+        work_queue               *m_edf;
+        reactor_queue            *m_idle;
+
+        boost::mutex              m_mtx;
+        boost::condition_variable m_done;
+      }; // TREX::agent::details::sync_dag
+
+      /** @brief Parallel deliberation executor
+       *
+       * This class executes the @c step of the reactors that have work on
+       * several workers. Each worker picks the reactor with the highest
+       * work ratio still pending -- the priority is then only a hint as
+       * several reactors deliberate at the same time -- and puts it back in
+       * the idle list once its step completed. Idle reactors are
+       * re-evaluated after every step so any worker can pick the new work
+       * produced by another one.
+       *
+       * A reactor is never stepped by two workers at the same time and a
+       * worker stops picking new reactors as soon as the condition given to
+       * execute is not satisfied anymore (typically when the tick changed)
+       *
+       * The idle reactors are polled outside of the executor lock so the
+       * other workers can keep on stepping meanwhile. A reactor which
+       * throws an exception while being polled is killed once all the
+       * workers completed.
+       *
+       * @ingroup agent
+       * @relates class Agent
+       */
+      class delib_executor :boost::noncopyable {
+      public:
+        typedef graph::reactor_id          reactor_id;
+        typedef std::list<reactor_id>      reactor_queue;
+        typedef Agent::priority_queue      work_queue;
+        typedef boost::function<bool ()>   condition;
+        typedef boost::function<bool (reactor_id)> poll_condition;
+        typedef boost::function<bool (reactor_id)> step_fn;
+        typedef boost::function<double (reactor_id)> ratio_fn;
+
+        /** @brief Constructor
+         *
+         * @param[in] g The graph the reactors belong to
+         * @param[in] edf The queue of reactors with work
+         * @param[in] idle The list of reactors without work
+         * @param[in] poll The condition to poll an idle reactor
+         * @param[in] step The function executing a reactor step. It returns
+         *            @c false when the reactor was deferred to a later tick
+         * @param[in] ratio The function computing a reactor work ratio
+         */
+        delib_executor(graph &g, work_queue &edf, reactor_queue &idle,
+                       poll_condition const &poll, step_fn const &step,
+                       ratio_fn const &ratio)
+        :m_graph(g), m_edf(edf), m_idle(idle), m_poll(poll), m_step(step),
+        m_ratio(ratio), m_workers(0), m_busy(0), m_count(0) {}
+        /** @brief Destructor */
+        ~delib_executor() {}
+
+        /** @brief Execute deliberation
+         *
+         * @param[in] pool The service used to run the workers
+         * @param[in] n The number of workers
+         * @param[in] proceed The condition to pick a new reactor
+         *
+         * Runs @p n workers on @p pool that will execute reactors steps
+         * while @p proceed is @c true and there is work left. The calling
+         * thread is blocked until all the workers completed, then the 
+         * reactors that failed are killed.
+         *
+         * @return The number of steps executed
+         */
+        size_t execute(boost::asio::io_service &pool, size_t n,
+                       condition const &proceed);
+
+      private:
+        /** @brief Worker bookkeeping
+         *
+         * Restores the executor counters when a worker completes,
+         * including when it is interrupted by an exception, so execute
+         * never waits for a worker that is gone.
+         */
+        struct worker_guard :boost::noncopyable {
+          worker_guard(delib_executor &exec, boost::mutex::scoped_lock &lock)
+          :m_exec(exec), m_lock(lock), busy(false) {}
+          ~worker_guard();
+
+          delib_executor            &m_exec;
+          boost::mutex::scoped_lock &m_lock;
+          bool                       busy;
+        };
+
+        void worker();
+        void refresh(reactor_id stepped, worker_guard &guard);
+
+        graph                    &m_graph;
+        work_queue               &m_edf;
+        reactor_queue            &m_idle;
+        poll_condition            m_poll;
+        step_fn                   m_step;
+        ratio_fn                  m_ratio;
+        condition                 m_proceed;
+        size_t                    m_workers, m_busy, m_count;
+        reactor_queue             m_failed;
+
+        boost::mutex              m_mtx;
+        boost::condition_variable m_cond;
+      }; // TREX::agent::details::delib_executor
+
       /** @brief Potential Graph cycle detector
        *
        * This class is a graph visitor that looks for potential dependency 
@@ -427,6 +636,253 @@ namespace TREX {
   }
 }
 
+/*
+ * class TREX::agent::details::sync_dag
+ */
+
+void TREX::agent::details::sync_dag::build(reactor_queue const &order) {
+  m_nodes.clear();
+  for(reactor_queue::const_iterator i=order.begin(); order.end()!=i; ++i)
+    m_nodes[*i];
+  for(node_map::iterator i=m_nodes.begin(); m_nodes.end()!=i; ++i) {
+    TeleoReactor::external_iterator e, last;
+    // Every reactor owning one of my externals needs to be synchronized
+    // before me
+    for(boost::tie(e, last)=boost::out_edges(i->first, m_graph); last!=e; ++e) {
+      node_map::iterator dep = m_nodes.find(boost::target(*e, m_graph));
+
+      if( m_nodes.end()!=dep && dep!=i &&
+          dep->second.dependents.insert(i->first).second )
+        i->second.pending += 1;
+    }
+  }
+}
+
+bool TREX::agent::details::sync_dag::execute(boost::asio::io_service &pool,
+                                           work_queue &edf,
+                                           reactor_queue &idle) {
+  bool killed = false;
+  {
+    boost::mutex::scoped_lock lock(m_mtx);
+    m_pool = &pool;
+    m_edf = &edf;
+    m_idle = &idle;
+    m_remaining = m_nodes.size();
+    m_running = 0;
+    m_failed.clear();
+    m_held.clear();
+    m_error = boost::exception_ptr();
+
+    // Start with the reactors that do not depend on anybody
+    for(node_map::const_iterator i=m_nodes.begin(); m_nodes.end()!=i; ++i)
+      if( 0==i->second.pending )
+        launch(i->first);
+    // and wait for all of them to complete
+    while( m_remaining>0 || !m_failed.empty() ) {
+      if( !m_failed.empty() && 0==m_running ) {
+        reactor_queue failed, held;
+        
+        // No synchronization is running : kill the reactors that failed
+        // before resuming the ones that were held meanwhile
+        failed.swap(m_failed);
+        lock.unlock();
+        for(reactor_queue::const_iterator i=failed.begin(); failed.end()!=i; 
+            ++i)
+          killed |= m_graph.kill_reactor(*i);
+        lock.lock();
+        held.swap(m_held);
+        for(reactor_queue::const_iterator i=held.begin(); held.end()!=i; ++i)
+          launch(*i);
+      } else
+        m_done.wait(lock);
+    }
+  }
+  if( m_error )
+    boost::rethrow_exception(m_error);
+  return killed;
+}
+
+void TREX::agent::details::sync_dag::launch(reactor_id r) {
+  // a reactor waiting to be killed blocks any new synchronization
+  if( m_failed.empty() ) {
+    ++m_running;
+    m_pool->post(boost::bind(&sync_dag::run, this, r));
+  } else
+    m_held.push_back(r);
+}
+
+void TREX::agent::details::sync_dag::run(reactor_id r) {
+  if( m_sync(r) ) {
+    try {
+      double wr = m_ratio(r);
+      boost::mutex::scoped_lock lock(m_mtx);
+
+      if( !std::isnan(wr) )
+        m_edf->insert(std::make_pair(wr, r));
+      else
+        m_idle->push_front(r);
+    } catch(...) {
+      // Keep the first exception so it can be rethrown by execute
+      boost::mutex::scoped_lock lock(m_mtx);
+      if( !m_error )
+        m_error = boost::current_exception();
+    }
+  } else {
+    // r failed => it will be killed by execute as soon as the running
+    // synchronizations completed
+    boost::mutex::scoped_lock lock(m_mtx);
+    m_failed.push_back(r);
+  }
+  completed(r);
+}
+
+void TREX::agent::details::sync_dag::completed(reactor_id r) {
+  boost::mutex::scoped_lock lock(m_mtx);
+  node const &n = m_nodes[r];
+
+  --m_running;
+  // release the reactors that were waiting for r
+  for(std::set<reactor_id>::const_iterator i=n.dependents.begin();
+      n.dependents.end()!=i; ++i) {
+    if( 0 == --(m_nodes[*i].pending) )
+      launch(*i);
+  }
+  if( 0 == --m_remaining || (0==m_running && !m_failed.empty()) )
+    m_done.notify_all();
+}
+
+
+/*
+ * class TREX::agent::details::delib_executor
+ */
+
+TREX::agent::details::delib_executor::worker_guard::~worker_guard() {
+  if( !m_lock.owns_lock() )
+    m_lock.lock();
+  if( busy )
+    m_exec.m_busy -= 1;
+  m_exec.m_workers -= 1;
+  // wake up both execute and the workers waiting for this one
+  m_exec.m_cond.notify_all();
+}
+
+size_t TREX::agent::details::delib_executor::execute(boost::asio::io_service &pool,
+                                                     size_t n,
+                                                     condition const &proceed) {
+  reactor_queue failed;
+  {
+    boost::mutex::scoped_lock lock(m_mtx);
+    m_proceed = proceed;
+    m_count = 0;
+    m_workers = n;
+    m_failed.clear();
+    for(size_t i=0; i<n; ++i)
+      pool.post(boost::bind(&delib_executor::worker, this));
+    while( m_workers>0 )
+      m_cond.wait(lock);
+    failed.swap(m_failed);
+  }
+  // No worker is running anymore : kill the reactors that failed
+  for(reactor_queue::const_iterator i=failed.begin(); failed.end()!=i; ++i)
+    m_graph.kill_reactor(*i);
+  return m_count;
+}
+
+void TREX::agent::details::delib_executor::worker() {
+  boost::mutex::scoped_lock lock(m_mtx);
+  worker_guard guard(*this, lock);
+
+  while( m_proceed() ) {
+    if( m_edf.empty() ) {
+      if( 0==m_busy ) {
+        // check if any idle reactor got new work in the meantime
+        refresh(NULL, guard);
+        if( m_edf.empty() && 0==m_busy )
+          break; // nobody has work anymore
+      } else
+        // wait for another worker to complete its step
+        m_cond.wait(lock);
+    } else {
+      reactor_id r = m_edf.begin()->second;
+
+      m_edf.erase(m_edf.begin());
+      m_busy += 1;
+      guard.busy = true;
+      lock.unlock();
+      bool stepped = m_step(r);
+      lock.lock();
+      m_busy -= 1;
+      guard.busy = false;
+      if( stepped ) {
+        m_count += 1;
+        m_idle.push_back(r);
+      }
+      // a deferred reactor is left aside until next synchronization
+      refresh(r, guard);
+      m_cond.notify_all();
+    }
+  }
+}
+
+void TREX::agent::details::delib_executor::refresh(reactor_id stepped,
+                                                   worker_guard &guard) {
+  reactor_queue polled, failed;
+  std::list<reactor_id>::iterator i = m_idle.begin();
+  
+  // Take the reactors to poll out of the idle list so no other worker
+  // polls them meanwhile
+  while( m_idle.end()!=i ) {
+    // Check if the reactor is still valid
+    if( !m_graph.is_member(*i) )
+      i = m_idle.erase(i);
+    else if( stepped==*i || m_poll(*i) )
+      polled.splice(polled.end(), m_idle, i++);
+    else
+      // event driven reactor with no new event
+      ++i;
+  }
+  if( polled.empty() )
+    return;
+  
+  std::list< std::pair<double, reactor_id> > ready;
+  
+  m_busy += 1;
+  guard.busy = true;
+  guard.m_lock.unlock();
+  for(i=polled.begin(); polled.end()!=i; ) {
+    try {
+      double wr = m_ratio(*i);
+      
+      if( !std::isnan(wr) ) {
+        ready.push_back(std::make_pair(wr, *i));
+        i = polled.erase(i);
+      } else
+        ++i;
+    } catch(utils::Exception const &e) {
+      m_graph.syslog((*i)->getName(), warn)
+        <<"Exception caught while computing work ratio:\n"<<e;
+      failed.splice(failed.end(), polled, i++);
+    } catch(std::exception const &se) {
+      m_graph.syslog((*i)->getName(), warn)
+        <<"C++ exception caught while computing work ratio:\n"<<se.what();
+      failed.splice(failed.end(), polled, i++);
+    } catch(...) {
+      m_graph.syslog((*i)->getName(), warn)
+        <<"Unknown exception caught while computing work ratio.";
+      failed.splice(failed.end(), polled, i++);
+    }
+  }
+  guard.m_lock.lock();
+  m_busy -= 1;
+  guard.busy = false;
+  m_edf.insert(ready.begin(), ready.end());
+  m_idle.splice(m_idle.end(), polled);
+  m_failed.splice(m_failed.end(), failed);
+  if( !ready.empty() )
+    m_cond.notify_all(); // new work for the waiting workers
+}
+
+
 AgentException::AgentException(graph const &agent, std::string const &msg) throw()
 :GraphException(agent, msg) {}
 
@@ -444,13 +900,17 @@ TICK Agent::initialTick(clock_ref clk) {
 
 Agent::Agent(Symbol const &name, TICK final, clock_ref clk, bool verbose)
 :graph(name, initialTick(clk), verbose), m_continue_if_empty(false),
- m_stat_log(manager().service()), m_clock(clk), m_finalTick(final), m_valid(true) {
+ m_stat_log(manager().service()), m_clock(clk), m_finalTick(final),
+ m_sync_version(0), m_valid(true), m_latency_window(10),
+ m_latency_log(manager().service()), m_overrun_limit(3) {
   m_proxy = new AgentProxy(*this);
   add_reactor(m_proxy);
 }
 
 Agent::Agent(std::string const &file_name, clock_ref clk, bool verbose)
-:m_stat_log(manager().service()), m_clock(clk), m_valid(true), m_continue_if_empty(false) {
+:m_stat_log(manager().service()), m_clock(clk), m_sync_version(0),
+ m_valid(true), m_continue_if_empty(false), m_latency_window(10),
+ m_latency_log(manager().service()), m_overrun_limit(3) {
   set_verbose(verbose);
   updateTick(initialTick(m_clock), false);
   m_proxy = new AgentProxy(*this);
@@ -474,7 +934,9 @@ Agent::Agent(std::string const &file_name, clock_ref clk, bool verbose)
 }
 
 Agent::Agent(boost::property_tree::ptree::value_type &conf, clock_ref clk, bool verbose)
-:m_stat_log(manager().service()), m_clock(clk), m_valid(true), m_continue_if_empty(false) {
+:m_stat_log(manager().service()), m_clock(clk), m_sync_version(0),
+ m_valid(true), m_continue_if_empty(false), m_latency_window(10),
+ m_latency_log(manager().service()), m_overrun_limit(3) {
   set_verbose(verbose);
   updateTick(initialTick(m_clock), false);
   m_proxy = new AgentProxy(*this);
@@ -502,7 +964,47 @@ Agent::~Agent() {
   m_proxy = NULL;
   if( m_stat_log.is_open() )
     m_stat_log.close();
+  if( m_latency_log.is_open() )
+    m_latency_log.close();
   clear();
+  m_sync_pool.reset();
+  m_delib_pool.reset();
+  m_reactor_exec.clear();
+  m_executors.clear();
+}
+
+// modifiers :
+
+size_t Agent::sync_threads() const {
+  if( m_sync_pool )
+    return m_sync_pool->thread_count();
+  return 0;
+}
+
+size_t Agent::delib_threads() const {
+  if( m_delib_pool )
+    return m_delib_pool->thread_count();
+  return 0;
+}
+
+size_t Agent::delib_threads(size_t n) {
+  if( 0==n )
+    m_delib_pool.reset();
+  else if( m_delib_pool )
+    m_delib_pool->thread_count(n);
+  else
+    m_delib_pool.reset(new asio_runner(n));
+  return delib_threads();
+}
+
+size_t Agent::sync_threads(size_t n) {
+  if( 0==n )
+    m_sync_pool.reset();
+  else if( m_sync_pool )
+    m_sync_pool->thread_count(n);
+  else
+    m_sync_pool.reset(new asio_runner(n));
+  return sync_threads();
 }
 
 // observers :
@@ -663,6 +1165,11 @@ void Agent::subConf(boost::property_tree::ptree &conf,
     }
   }
   
+  // Create executor pools before the reactors that may use them
+  boost::tie(i, last) = conf.equal_range("Executor");
+  for(; last!=i; ++i)
+    add_executor(*i);
+  
   // Produce new reactors
   syslog(path, info)<<"Loading reactors...";
   add_reactors(conf);
@@ -694,9 +1201,17 @@ void Agent::loadConf(boost::property_tree::ptree::value_type &config) {
     set_name(name);
     
     m_continue_if_empty = parse_attr<int>(0, config, "allow_empty")!=0;
+    sync_threads(parse_attr<size_t>(0, config, "sync_threads"));
+    delib_threads(parse_attr<size_t>(0, config, "delib_threads"));
     m_finalTick = parse_attr<TICK>(std::numeric_limits<TICK>::max(), config, "finalTick");
     if( m_finalTick<=0 )
       throw XmlError(config, "agent life time should be greater than 0");
+    m_latency_window = parse_attr<TICK>(m_latency_window, config,
+                                        "latency_window");
+    if( m_latency_window<=0 )
+      throw XmlError(config, "latency_window should be greater than 0");
+    m_overrun_limit = parse_attr<size_t>(m_overrun_limit, config,
+                                         "overrun_limit");
   } catch(bad_string_cast const &e) {
     throw XmlError(config, e.what());
   }
@@ -792,6 +1307,9 @@ void Agent::initComplete() {
   " delib_ns, delib_rt_ns, delib_steps,"
   " planned_sleep, sleep_cnt, sleep_ns\n";
   
+  m_latency_log.open(manager().file_name("latency.csv").c_str());
+  m_latency_log<<"tick, reactor, phase, count, p50_ns, p99_ns, max_ns\n";
+  
   {
     graph_names_writer gn;
     async_ofstream::entry e = dotf.new_entry();
@@ -821,9 +1339,35 @@ void Agent::run() {
 
 std::list<Agent::reactor_id> Agent::sort_reactors_sync() {
   std::list<reactor_id> queue;
-  details::sync_scheduller sync(queue);
+  size_t version = topology_version();
   
-  boost::depth_first_search(me(), boost::visitor(sync));
+  if( m_sync_order.empty() || version!=m_sync_version ) {
+    // The graph changed since last tick: compute a new order
+    details::sync_scheduller sync(queue);
+    
+    boost::depth_first_search(me(), boost::visitor(sync));
+  } else {
+    // Reuse the last order and just notify the reactors of the new tick
+    for(std::list<reactor_id>::const_iterator i=m_sync_order.begin();
+        m_sync_order.end()!=i; ++i) {
+      if( !is_isolated(*i) ) {
+        if( (*i)->newTick() )
+          queue.push_back(*i);
+        else
+          isolate(*i);
+      }
+    }
+    if( topology_version()!=version ) {
+      // One reactor changed the graph during its newTick: compute the new
+      // order without calling newTick again
+      details::sync_scheduller sync(queue, false);
+      
+      queue.clear();
+      boost::depth_first_search(me(), boost::visitor(sync));
+    }
+  }
+  m_sync_order = queue;
+  m_sync_version = version;
   return queue;
 }
 
@@ -836,6 +1380,11 @@ void Agent::synchronize() {
   
   m_edf.clear(); // Make sure that there's no one left in the schedulling
   m_idle.clear();
+  {
+    // all the reactors are polled after synchronization
+    boost::mutex::scoped_lock lock(m_wake_mtx);
+    m_woken.clear();
+  }
   bool update = false;
   
   stat_clock::duration delta;
@@ -852,6 +1401,20 @@ void Agent::synchronize() {
     if( n_failed>0 )
       syslog(null, warn)<<n_failed<<" reactors failed to start tick "
       <<now;
+    if( m_sync_pool && queue.size()>1 ) {
+      // Execute synchronization in parallel
+      //  - each reactor is synchronized on the pool as soon as all the
+      //  reactors it depends on are synchronized
+      details::sync_dag dag(*this,
+                            boost::bind(&Agent::synchronize_reactor, this, _1),
+                            boost::bind(&Agent::work_ratio, this, _1));
+      boost::function<void ()>
+      deps(boost::bind(&details::sync_dag::build, &dag, boost::cref(queue)));
+
+      strand_run(strand(), deps);
+      update = dag.execute(m_sync_pool->service(), m_edf, m_idle);
+      queue.clear();
+    }
     // Execute synchronization
     //  - could be done with a dfs but we choose for now to do it using the
     //  output list of sync_scheduller to avoid a potentially costfull graph
@@ -860,8 +1423,8 @@ void Agent::synchronize() {
       reactor_id r = queue.front();
       queue.pop_front();
       // synchronization
-      if( r->doSynchronize() ) {
-        double wr = r->workRatio();
+      if( synchronize_reactor(r) ) {
+        double wr = work_ratio(r);
         
         if( !std::isnan(wr) ) {
           // this reactor has deliberation :
@@ -896,30 +1459,243 @@ void Agent::synchronize() {
   }
 }
 
-bool Agent::executeReactor() {
-  Symbol id = null;
+bool Agent::can_deliberate(TICK now) const {
+  return m_clock->tick()==now && m_clock->is_free() && valid();
+}
+
+void Agent::wakeup(reactor_id r) {
+  {
+    boost::mutex::scoped_lock lock(m_wake_mtx);
+    m_woken.insert(r);
+  }
+  // interrupt the clock if we were waiting for next tick
+  if( m_clock )
+    m_clock->wake();
+}
+
+bool Agent::should_poll(reactor_id r) {
+  if( !r->is_event_driven() )
+    return true;
+  boost::mutex::scoped_lock lock(m_wake_mtx);
+  return m_woken.erase(r)>0;
+}
+
+bool Agent::may_step(reactor_id r, TICK now) {
+  rt_clock::duration left = CHRONO::duration_cast<rt_clock::duration>(m_clock->budget_left());
+  boost::mutex::scoped_lock lock(m_overrun_mtx);
+  overrun_map::const_iterator i = m_overruns.find(r);
+  
+  if( m_overruns.end()==i )
+    return true;
+  // Degraded reactors are deferred until their resume tick
+  if( now<i->second.resume )
+    return false;
+  // Do not start a new step that is not expected to complete before
+  // the deadline: a reactor can always do its first step of the tick
+  return i->second.last_step!=now || i->second.expected<=left;
+}
+
+void Agent::account_step(reactor_id r, TICK now,
+                         rt_clock::duration const &delta, bool overrun) {
+  boost::mutex::scoped_lock lock(m_overrun_mtx);
+  overrun_info &info = m_overruns[r];
+  
+  if( info.last_step<0 )
+    info.expected = delta;
+  else
+    info.expected = (3*info.expected+delta)/4;
+  info.last_step = now;
+  
+  if( overrun ) {
+    if( info.last_overrun==now )
+      return; // only one strike per tick
+    if( info.last_overrun+1==now )
+      info.strikes += 1;
+    else
+      info.strikes = 1;
+    info.last_overrun = now;
+    
+    if( m_overrun_limit>0 && info.strikes>=m_overrun_limit ) {
+      if( info.level<5 )
+        info.level += 1;
+      info.strikes = 0;
+      info.resume = now+(TICK(1)<<info.level);
+      std::ostringstream oss;
+      utils::display(oss, info.expected);
+      syslog(r->getName(), warn)<<"Overran the clock deadline during "
+      <<m_overrun_limit<<" ticks (average step: "<<oss.str()
+      <<").\n\tDeferring its deliberation until tick "<<info.resume;
+    }
+  } else if( info.level>0 &&
+            now>info.last_overrun+(TICK(1)<<info.level) ) {
+    // no overrun for a while: progressively restore this reactor
+    info.level -= 1;
+  }
+}
+
+bool Agent::step_reactor(reactor_id r, TICK now) {
+  if( !may_step(r, now) )
+    return false;
+  
+  Symbol id = r->getName();
+  rt_clock::duration delta_rt;
+  bool overrun = false;
+  
+  try {
+    bool deadline = m_clock->budget_left()>Clock::duration_type::zero();
+    {
+      utils::chronograph<rt_clock> rt_chron(delta_rt);
+      run_on<void>(r, boost::bind(&TeleoReactor::step, r));
+    }
+    // the step overran if it started before the deadline and ended after
+    overrun = deadline &&
+      m_clock->budget_left()<=Clock::duration_type::zero();
+  } catch(Exception const &e) {
+    syslog(id, warn)<<"Exception caught while executing reactor step:\n"<<e;
+  } catch(std::exception const &se) {
+    syslog(id, warn)<<"C++ exception caught while executing reactor step:\n"
+    <<se.what();
+  } catch(...) {
+    syslog(id, warn)<<"Unknown exception caught while executing reactor step.";
+  }
+  account_step(r, now, delta_rt, overrun);
+  return true;
+}
+
+void Agent::add_executor(boost::property_tree::ptree::value_type &conf) {
+  Symbol name = parse_attr<Symbol>(conf, "name");
+  
+  if( name.empty() )
+    throw XmlError(conf, "Executor name is empty.");
+  if( TeleoReactor::dedicated_executor==name )
+    throw XmlError(conf, "\""+name.str()+"\" is reserved for reactors"
+                   " dedicated executors.");
+  
+  size_t n_threads = parse_attr<size_t>(1, conf, "threads");
+  if( 0==n_threads )
+    throw XmlError(conf, "Executor needs at least 1 thread.");
+  
+  thread_placement where;
+  try {
+    where.cpus(parse_attr<std::string>("", conf, "cpus"));
+  } catch(Exception const &e) {
+    throw XmlError(conf, e.what());
+  }
+  boost::optional<int> nice = parse_attr< boost::optional<int> >(conf, "nice");
+  if( nice )
+    where.nice(*nice);
+  
+  boost::mutex::scoped_lock lock(m_exec_mtx);
+  executor_ref &pool = m_executors[name];
+  if( pool )
+    throw XmlError(conf, "Executor \""+name.str()+"\" already exists.");
+  pool = MAKE_SHARED<asio_runner>(n_threads, boost::cref(where));
+  syslog(null, info)<<"Executor \""<<name<<"\" created with "<<n_threads
+                    <<" threads on "<<where.str();
+  if( pool->placement_failures()>0 )
+    syslog(null, warn)<<"Failed to apply placement of executor \""<<name
+                      <<"\" to "<<pool->placement_failures()<<" threads.";
+}
+
+boost::asio::io_service *Agent::executor(reactor_id r) {
+  boost::mutex::scoped_lock lock(m_exec_mtx);
+  std::map<reactor_id, executor_ref>::iterator i = m_reactor_exec.find(r);
+  
+  if( m_reactor_exec.end()==i ) {
+    Symbol const &name = r->executor();
+    executor_ref pool;
+    
+    if( TeleoReactor::dedicated_executor==name ) {
+      pool = MAKE_SHARED<asio_runner>(1, boost::cref(r->placement()));
+      syslog(r->getName(), info)<<"Running on a dedicated thread on "
+                                <<r->placement().str();
+      if( pool->placement_failures()>0 )
+        syslog(r->getName(), warn)<<"Failed to apply thread placement.";
+    } else if( !name.empty() ) {
+      std::map<Symbol, executor_ref>::const_iterator p = m_executors.find(name);
+      if( m_executors.end()!=p ) 
+        pool = p->second;
+      else
+        syslog(r->getName(), error)<<"Unknown executor \""<<name
+                                   <<"\": sharing the agent threads instead.";
+    }
+    i = m_reactor_exec.insert(std::make_pair(r, pool)).first;
+  }
+  if( i->second )
+    return &(i->second->service());
+  return NULL;
+}
+
+bool Agent::synchronize_reactor(reactor_id r) {
+  return run_on<bool>(r, boost::bind(&TeleoReactor::doSynchronize, r));
+}
+
+double Agent::work_ratio(reactor_id r) {
+  return run_on<double>(r, boost::bind(&TeleoReactor::workRatio, r));
+}
+
+size_t Agent::react(TICK now) {
+  priority_queue queue;
+  std::set<reactor_id> woken;
+  size_t steps = 0;
+  double wr;
+  bool stepped;
+  
+  do {
+    {
+      boost::mutex::scoped_lock lock(m_wake_mtx);
+      woken.swap(m_woken);
+    }
+    // Only the woken reactors are polled
+    for(std::set<reactor_id>::const_iterator i=woken.begin();
+        woken.end()!=i; ++i) {
+      if( is_member(*i) ) {
+        wr = work_ratio(*i);
+        if( !std::isnan(wr) )
+          queue.insert(std::make_pair(wr, *i));
+      }
+    }
+    woken.clear();
+    stepped = false;
+    
+    if( !queue.empty() && can_deliberate(now) ) {
+      reactor_id r = queue.begin()->second;
+      
+      queue.erase(queue.begin());
+      if( step_reactor(r, now) ) {
+        ++steps;
+        stepped = true;
+        // Poll r again directly as it did not wake up
+        if( is_member(r) ) {
+          wr = work_ratio(r);
+          if( !std::isnan(wr) )
+            queue.insert(std::make_pair(wr, r));
+        }
+      }
+    }
+  } while( stepped );
+  if( !queue.empty() ) {
+    // The reactors that still have work will be polled on next call
+    boost::mutex::scoped_lock lock(m_wake_mtx);
+    for(priority_queue::const_iterator i=queue.begin(); queue.end()!=i; ++i)
+      m_woken.insert(i->second);
+  }
+  return steps;
+}
+
+bool Agent::executeReactor(TICK now) {
   bool was_empty = m_edf.empty();
+  reactor_id r = NULL;
   
   if( !was_empty ) {
     // One reactor requested to run
     double wr;
-    reactor_id r;
 
     boost::tie(wr, r) = *(m_edf.begin());
     m_edf.erase(m_edf.begin());
-    m_idle.push_back(r);
-
-    try {
-      id = r->getName();
-      r->step();
-    } catch(Exception const &e) {
-      syslog(id, warn)<<"Exception caught while executing reactor step:\n"<<e;
-    } catch(std::exception const &se) {
-      syslog(id, warn)<<"C++ exception caught while executing reactor step:\n"
-      <<se.what();
-    } catch(...) {
-      syslog(id, warn)<<"Unknown exception caught while executing reactor step.";
-    }
+    // a deferred reactor is left aside until next synchronization
+    if( step_reactor(r, now) )
+      m_idle.push_back(r);
   }
   
   std::list<reactor_id>::iterator i = m_idle.begin();
@@ -927,7 +1703,12 @@ bool Agent::executeReactor() {
   while( m_idle.end()!=i ) {
     // Check if the reactor is still valid
     if( is_member(*i) ) {
-      wr = (*i)->workRatio();
+      if( r!=*i && !should_poll(*i) ) {
+        // event driven reactor with no new event
+        ++i;
+        continue;
+      }
+      wr = work_ratio(*i);
       if( !std::isnan(wr) ) {
 	m_edf.insert(std::make_pair(wr, *i));
 	i = m_idle.erase(i);
@@ -947,19 +1728,41 @@ bool Agent::doNext() {
     return false;
   }
   // Flush the goal to be parsed queue
-  while( !m_goals.empty() ) {
-    try {
-      goal_id tmp = parse_goal(m_goals.front());
-      sendRequest(tmp);
-    } catch(...) {
-      syslog(null, error)<<"Failed to parse a goal ... skipping it";
-    }
-    m_goals.pop_front();
+  if( !m_goals.empty() ) {
+    std::list<goal_id> batch;
+    size_t failed = parse_goals(m_goals, batch);
+    
+    m_goals.clear();
+    if( failed>0 )
+      syslog(null, error)<<"Failed to parse "<<failed<<" goals ... skipping them";
+    sendRequests(batch);
   }
   
   synchronize();
   TICK const now = getCurrentTick();
   
+  {
+    // forget about the overruns of the reactors that are gone
+    boost::mutex::scoped_lock lock(m_overrun_mtx);
+    for(overrun_map::iterator i=m_overruns.begin(); m_overruns.end()!=i; ) {
+      if( is_member(i->first) )
+        ++i;
+      else
+        m_overruns.erase(i++);
+    }
+  }
+  {
+    // release the executors of the reactors that are gone
+    boost::mutex::scoped_lock lock(m_exec_mtx);
+    for(std::map<reactor_id, executor_ref>::iterator i=m_reactor_exec.begin();
+        m_reactor_exec.end()!=i; ) {
+      if( is_member(i->first) )
+        ++i;
+      else
+        m_reactor_exec.erase(i++);
+    }
+  }
+  
   size_t count = 0; //slp_count = 0;
   stat_clock::duration delib;
   rt_clock::duration delib_rt, sleep_time, sleep_req;
@@ -971,10 +1774,19 @@ bool Agent::doNext() {
     {
       utils::chronograph<stat_clock> stat_chron(delib);
       utils::chronograph<rt_clock> rt_chron(delib_rt);
-      while( m_clock->tick()==now
-            && m_clock->is_free() && valid()
-            && executeReactor() ) {
-        ++count;
+      if( m_delib_pool ) {
+        details::delib_executor exec(*this, m_edf, m_idle,
+                                     boost::bind(&Agent::should_poll, this, _1),
+                                     boost::bind(&Agent::step_reactor, this,
+                                                 _1, now),
+                                     boost::bind(&Agent::work_ratio, this, _1));
+        count = exec.execute(m_delib_pool->service(),
+                             m_delib_pool->thread_count(),
+                             boost::bind(&Agent::can_deliberate, this, now));
+      } else {
+        while( can_deliberate(now) && executeReactor(now) ) {
+          ++count;
+        }
       }
     }
     
@@ -986,6 +1798,11 @@ bool Agent::doNext() {
     {
       utils::chronograph<rt_clock> sleep_chrono(sleep_time);
       while( valid() && m_clock->tick()==now ) {
+        // event driven reactors can react to new events until next tick
+        // as long as the clock allows deliberation (i.e. not when
+        // replaying a log or stepping through ticks)
+        if( can_deliberate(now) && react(now)>0 && m_clock->tick()!=now )
+          break;
         sleep_req += CHRONO::duration_cast<rt_clock::duration>(m_clock->sleep());
         ++sl_count;
       }
@@ -1001,10 +1818,28 @@ bool Agent::doNext() {
   if( print_delib )
     m_stat_log<<", "<<delib.count()<<", "<<count<<", ";
   m_stat_log<<sleep_req.count()<<", "<<sl_count<<", "<<sleep_time.count()<<std::endl;
+  roll_latency(now);
   
   return valid();
 }
 
+void Agent::roll_latency(TICK now) {
+  if( (now+1)%m_latency_window!=0 && valid() )
+    return;
+  
+  typedef TREX::utils::latency_registry::summary summary;
+  std::list<summary> window;
+  latency().roll(now, window);
+  
+  if( !window.empty() && m_latency_log.is_open() ) {
+    async_ofstream::entry e = m_latency_log.new_entry();
+    for(std::list<summary>::const_iterator i=window.begin();
+        window.end()!=i; ++i)
+      e.stream()<<now<<", "<<i->source<<", "<<i->phase<<", "<<i->count
+      <<", "<<i->p50<<", "<<i->p99<<", "<<i->max<<'\n';
+  }
+}
+
 void Agent::sendRequest(goal_id const &g) {
   if( !has_timeline(g->object()) )
     syslog(null, warn)<<"Posting goal on a unknnown timeline \""
@@ -1013,13 +1848,38 @@ void Agent::sendRequest(goal_id const &g) {
   syslog(null, info)<<"Added "<<g<<" to goal queue:\n\t"<<(*g);
 }
 
+size_t Agent::sendRequests(std::list<goal_id> const &goals) {
+  if( goals.empty() )
+    return 0;
+  std::set<Symbol> unknown;
+  
+  for(std::list<goal_id>::const_iterator i=goals.begin(); goals.end()!=i; ++i) {
+    if( !has_timeline((*i)->object()) && unknown.insert((*i)->object()).second )
+      syslog(null, warn)<<"Posting goals on a unknnown timeline \""
+      <<(*i)->object()<<"\".";
+  }
+  size_t ret = m_proxy->postRequests(goals);
+  syslog(null, info)<<"Added "<<ret<<" goals to goal queue ("
+  <<(goals.size()-ret)<<" rejected)";
+  return ret;
+}
+
 size_t Agent::sendRequests(boost::property_tree::ptree &g) {
   size_t ret = 0;
-  boost::property_tree::ptree::assoc_iterator i, last;
-  boost::tie(i, last) = g.equal_range("Goal");
-  for(; last!=i; ++i) {
-    sendRequest(*i);
-    ++ret;
+  
+  for(boost::property_tree::ptree::iterator i=g.begin(); g.end()!=i; ++i) {
+    if( is_tag(*i, "Goal") ) {
+      sendRequest(*i);
+      ++ret;
+    } else if( is_tag(*i, "Goals") ) {
+      for(boost::property_tree::ptree::iterator j=i->second.begin();
+          i->second.end()!=j; ++j) {
+        if( j->first.empty() || is_tag(*j, "Goal") ) {
+          sendRequest(*j);
+          ++ret;
+        }
+      }
+    }
   }
   return ret;
 }
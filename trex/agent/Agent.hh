@@ -54,6 +54,12 @@
 # include "Clock.hh"
 # include <trex/utils/PluginLoader.hh>
 # include <trex/utils/asio_fstream.hh>
+# include <trex/utils/asio_runner.hh>
+
+# include <boost/scoped_ptr.hpp>
+
+# include <map>
+# include <set>
 
 namespace TREX {
   namespace agent {
@@ -153,6 +159,12 @@ namespace TREX {
        * @li @c config is an optional attribute that points to another XML file.
        *     this file will contains extra tags that will be parse in simlar mananer
        *     to the childs of this root tag.
+       * @li @c sync_threads is an optional attribute giving the number of
+       *     threads used to synchronize reactors in parallel (default is 0
+       *     for a sequential synchronization)
+       * @li @c delib_threads is an optional attribute giving the number of
+       *     threads used to execute reactors deliberation steps in parallel
+       *     (default is 0 for a sequential execution)
        *
        * the child tags will be parsed in the following order:
        * @li Plugin information allowing TREX to load external plugins. These
@@ -163,6 +175,20 @@ namespace TREX {
        *     and will result on the  attempting to load the dynamic libray @e TREXvitre
        *     as a TREX plugin. These need to be loaded firast as oner plugin can defines
        *     new clocks or reactors types used by this agent
+       * @li Executor pools definition. These XML tags have the following syntax:
+       *     @code
+       *     <Executor name="planners" threads="2" cpus="2-3" nice="5" />
+       *     @endcode
+       *     and create a pool of @c threads threads (1 by default) restricted
+       *     to the given @c cpus and running with the given @c nice value
+       *     (both optional). A reactor runs its synchronization,
+       *     deliberation and work ratio computation on this pool when its
+       *     @c executor attribute is set to @c "planners". Its tick start
+       *     notification and goal dispatching are still executed on the
+       *     agent threads. A reactor can also request its own thread with
+       *     @c executor="dedicated" and place it with its own @c cpus and
+       *     @c nice attributes. Reactors without @c executor attribute share
+       *     the agent threads.
        * @li Clock definition. These will be parsed only if a clock is not defined and as
        *     a result only the first clock definition may be parsed in this configuration
        *     The tag of the XML depends on the way the clock class declared itself inside
@@ -247,6 +273,60 @@ namespace TREX {
         return m_clock;
       }
       
+      /** @brief Synchronization threads
+       *
+       * @return the number of threads used to synchronize the reactors in
+       *   parallel or 0 if synchronization is sequential
+       *
+       * @sa sync_threads(size_t)
+       */
+      size_t sync_threads() const;
+      /** @brief Set synchronization threads
+       *
+       * @param[in] n The desired number of threads
+       *
+       * Set the number of threads used for reactors synchronization. When
+       * @p n is greater than 0, a reactor is synchronized on one of these
+       * threads as soon as all the reactors owning its External timelines
+       * completed their own synchronization. Otherwise reactors are
+       * synchronized one after the other in dependency order.
+       *
+       * The number of threads can only grow unless @p n is 0 which restores
+       * the sequential synchronization.
+       *
+       * @return the number of synchronization threads
+       *
+       * @sa sync_threads() const
+       */
+      size_t sync_threads(size_t n);
+      
+      /** @brief Deliberation threads
+       *
+       * @return the number of threads used to execute reactors deliberation
+       *   in parallel or 0 if deliberation is sequential
+       *
+       * @sa delib_threads(size_t)
+       */
+      size_t delib_threads() const;
+      /** @brief Set deliberation threads
+       *
+       * @param[in] n The desired number of threads
+       *
+       * Set the number of threads used to execute the reactors deliberation
+       * steps. When @p n is greater than 0, up to @p n reactors can execute
+       * their step concurrently during the same tick; each thread picking
+       * the pending reactor with the highest work ratio. Otherwise the
+       * reactors are stepped one after the other.
+       *
+       * The number of threads can only grow unless @p n is 0 which restores
+       * the sequential deliberation.
+       *
+       * @return the number of deliberation threads
+       *
+       * @sa delib_threads() const
+       */
+      size_t delib_threads(size_t n);
+      
       void add_to_agent(boost::property_tree::ptree::value_type &config);
       
       /** @brief run the agent
@@ -331,6 +411,19 @@ namespace TREX {
        * to whichever reactor owns the timeline associated to @p g
        */
       void sendRequest(TREX::transaction::goal_id const &g);
+      /** @brief Post a batch of goals
+       *
+       * @param[in] goals A list of goals
+       *
+       * This method adds all the goals in @p goals to the agent in a single
+       * graph transaction and reports the outcome in one log message. Each 
+       * goal will be posted to whichever reactor owns its timeline.
+       *
+       * @return The number of goals succesfully posted
+       *
+       * @sa sendRequest(TREX::transaction::goal_id const &)
+       */
+      size_t sendRequests(std::list<TREX::transaction::goal_id> const &goals);
       /** @brief Post a goal from xml
        *
        * @param[in] g A goal in xml
@@ -350,8 +443,16 @@ namespace TREX {
        * @param[in] g A xml iterator
        *
        *  This method will insert all the goals that are acessibles by iterating
-       *  through @p g
+       *  through @p g. These are either @c Goal tags or @c Goals tags that
+       *  group several goals -- either in xml or as a json array.
+       *
+       *  The goals are parsed and posted as a single batch when the agent is 
+       *  ready to start its next tick.
        *
+       *  @return the number of goals found
+       *
+       *  @sa TREX::transaction::graph::parse_goals
+       *  @sa sendRequests(std::list<TREX::transaction::goal_id> const &)
        *  @sa TREX::transaction::Goal::Goal(rapidxml::xml_node<> &)
        *  @sa sendRequest(rapidxml::xml_node<> &)
        */
@@ -406,6 +507,22 @@ namespace TREX {
             syslog(null, error)<<"Unable to subscribe to "<<g->object();
           return false;
         }
+        size_t postRequests(std::list<TREX::transaction::goal_id> const &goals) {
+          std::set<TREX::utils::Symbol> tls;
+          
+          for(std::list<TREX::transaction::goal_id>::const_iterator i=goals.begin();
+              goals.end()!=i; ++i)
+            tls.insert((*i)->object());
+          for(std::set<TREX::utils::Symbol>::const_iterator i=tls.begin();
+              tls.end()!=i; ++i) {
+            if( !isExternal(*i) ) {
+              use(*i);
+              if( !isExternal(*i) )
+                syslog(null, error)<<"Unable to subscribe to "<<*i;
+            }
+          }
+          return postGoals(goals);
+        }
         
       protected:
         bool synchronize() {
@@ -425,11 +542,13 @@ namespace TREX {
                           TREX::transaction::details::timeline const &tl);
       void external_check(reactor_id r,
                           TREX::transaction::details::timeline const &tl);
+      void wakeup(reactor_id r);
       
       std::list<reactor_id> init_dfs_sync();
       std::list<reactor_id> sort_reactors_sync();
       
-      std::list<boost::property_tree::ptree::value_type> m_goals;
+      /** @brief Goals waiting to be parsed */
+      boost::property_tree::ptree m_goals;
       
       AgentProxy *m_proxy;
       
@@ -540,10 +659,63 @@ namespace TREX {
       TREX::transaction::TICK    m_finalTick;
       priority_queue             m_edf;
       std::list<reactor_id>      m_idle;
+      /** @brief Cached synchronization order
+       *
+       * The synchronization order computed during last tick. It is reused
+       * as long as the graph structure did not change
+       *
+       * @sa topology_version() const
+       */
+      std::list<reactor_id>      m_sync_order;
+      /** @brief Graph version of m_sync_order */
+      size_t                     m_sync_version;
+      /** @brief Parallel synchronization pool
+       *
+       * The threads used to synchronize reactors in parallel. This pool is
+       * distinct from the one managing the graph strand as reactor
+       * synchronization can block on this strand.
+       */
+      boost::scoped_ptr<TREX::utils::asio_runner> m_sync_pool;
+      /** @brief Parallel deliberation pool
+       *
+       * The threads used to execute reactors deliberation in parallel
+       */
+      boost::scoped_ptr<TREX::utils::asio_runner> m_delib_pool;
+      /** @brief Woken reactors
+       *
+       * The event driven reactors that received new events since they
+       * were last polled for work
+       *
+       * @sa TeleoReactor::is_event_driven() const
+       */
+      std::set<reactor_id>       m_woken;
+      boost::mutex               m_wake_mtx;
       
       mutable utils::SharedVar<bool> m_valid;
       bool m_continue_if_empty;
       
+      /** @brief Latency window size
+       *
+       * The number of ticks covered by each window of the reactors latency
+       * histograms
+       *
+       * @sa roll_latency(TREX::transaction::TICK)
+       */
+      TREX::transaction::TICK     m_latency_window;
+      /** @brief Latency summary file */
+      TREX::utils::async_ofstream m_latency_log;
+      /** @brief Close a latency window
+       *
+       * @param[in] now The current tick
+       *
+       * If @p now is the last tick of the current latency window, summarize
+       * the reactors latency histograms of this window in @c latency.csv
+       * and start a new window.
+       *
+       * @sa graph::latency() const
+       */
+      void roll_latency(TREX::transaction::TICK now);
+      
       bool valid() const {
         utils::SharedVar<bool>::scoped_lock lck(m_valid);
         return *m_valid;
@@ -551,7 +723,184 @@ namespace TREX {
       
       void synchronize();
       
-      bool executeReactor();
+      /** @brief Check if deliberation can proceed
+       *
+       * @param[in] now The current tick
+       *
+       * @retval true if the clock is still at tick @p now and the agent
+       *  is still valid
+       * @retval false otherwise
+       */
+      bool can_deliberate(TREX::transaction::TICK now) const;
+      bool executeReactor(TREX::transaction::TICK now);
+      /** @brief Check if an idle reactor needs to be polled
+       *
+       * @param[in] r An idle reactor
+       *
+       * @retval true if @p r is not event driven or has been woken up since
+       *         it was last polled
+       * @retval false otherwise
+       */
+      bool should_poll(reactor_id r);
+      /** @brief React to events
+       *
+       * @param[in] now The current tick
+       *
+       * Execute the steps of the event driven reactors woken up while the
+       * agent waits for the next tick. The reactors that still have work
+       * when deliberation is not possible anymore stay woken up.
+       *
+       * @return the number of steps executed
+       */
+      size_t react(TREX::transaction::TICK now);
+      /** @brief Execute a reactor step
+       *
+       * @param[in] r A reactor
+       * @param[in] now The current tick
+       *
+       * Execute one step of @p r unless it is deferred: either because
+       * it was degraded after repeatedly overrunning the clock deliberation
+       * budget or because it already stepped during this tick and its
+       * expected step duration exceeds the budget left. 
+       *
+       * @retval true if @p r was stepped
+       * @retval false if @p r is deferred to a later tick
+       *
+       * @sa Clock::budget_left() const
+       */
+      bool step_reactor(reactor_id r, TREX::transaction::TICK now);
+      
+      /** @brief Reactor deadline overrun record */
+      struct overrun_info {
+        overrun_info():strikes(0), level(0), last_step(-1), last_overrun(-1),
+                       resume(0), expected(rt_clock::duration::zero()) {}
+        
+        /** @brief Number of consecutive ticks with an overrun */
+        size_t                  strikes;
+        /** @brief Degradation level
+         *
+         * A reactor with a level @e n is deferred for 2^n ticks when it
+         * is degraded
+         */
+        unsigned                level;
+        TREX::transaction::TICK last_step, last_overrun, resume;
+        /** @brief Moving average of the reactor steps duration */
+        rt_clock::duration      expected;
+      }; // TREX::agent::Agent::overrun_info
+      
+      typedef std::map<reactor_id, overrun_info> overrun_map;
+      
+      /** @brief Deadline admission
+       *
+       * @param[in] r A reactor
+       * @param[in] now The current tick
+       *
+       * @retval true if @p r can execute a step
+       * @retval false if the step of @p r has to be deferred
+       */
+      bool may_step(reactor_id r, TREX::transaction::TICK now);
+      /** @brief Overrun accounting
+       *
+       * @param[in] r A reactor
+       * @param[in] now The current tick
+       * @param[in] delta The real time duration of the step of @p r
+       * @param[in] overrun Indicates if this step ended past the clock
+       *            deliberation deadline
+       */
+      void account_step(reactor_id r, TREX::transaction::TICK now,
+                        rt_clock::duration const &delta, bool overrun);
+      
+      /** @brief Number of consecutive overrun ticks before degradation
+       *
+       * A value of 0 disables reactors degradation
+       */
+      size_t      m_overrun_limit;
+      overrun_map m_overruns;
+      boost::mutex m_overrun_mtx;
+      
+      typedef SHARED_PTR<TREX::utils::asio_runner>  executor_ref;
+      
+      /** @brief Create an executor pool
+       *
+       * @param[in] conf An @c Executor XML definition
+       *
+       * @throw TREX::utils::XmlError @p conf is not a valid executor
+       *        definition
+       */
+      void add_executor(boost::property_tree::ptree::value_type &conf);
+      /** @brief Reactor executor
+       *
+       * @param[in] r A reactor
+       *
+       * Identifies the service @p r should be executed on. The executor 
+       * of a reactor is resolved on its first call and, if @p r requested 
+       * a dedicated executor, created at this time.
+       *
+       * @return the service of the executor of @p r or @c NULL if @p r 
+       *         shares the agent threads
+       *
+       * @sa TREX::transaction::TeleoReactor::executor() const
+       */
+      boost::asio::io_service *executor(reactor_id r);
+      /** @brief Execute on reactor executor
+       *
+       * @param[in] r A reactor
+       * @param[in] fn A function
+       *
+       * Execute @p fn on the executor of @p r and wait for its completion. 
+       * If @p r has no executor @p fn is executed directly by the calling 
+       * thread
+       *
+       * @return the value returned by @p fn
+       * @throw an exception produced by @p fn if any
+       *
+       * @note only the synchronization, the step and the work ratio of
+       *       a reactor are executed this way. Its @c newTick is called
+       *       while the agent explores the reactors graph in order to
+       *       dispatch the goals before any synchronization starts and
+       *       therefore stays on the agent graph strand.
+       *
+       * @sa executor(reactor_id)
+       */
+      template<typename Ret>
+      Ret run_on(reactor_id r, boost::function<Ret ()> const &fn) {
+        boost::asio::io_service *exec = executor(r);
+        
+        if( NULL==exec )
+          return fn();
+        return TREX::utils::strand_run(*exec, fn);
+      }
+      /** @brief Synchronize a reactor
+       *
+       * @param[in] r A reactor
+       *
+       * Synchronizes @p r on its executor
+       *
+       * @retval true if @p r synchronized successfully
+       * @retval false if @p r failed and should be killed
+       */
+      bool synchronize_reactor(reactor_id r);
+      /** @brief Reactor work ratio
+       *
+       * @param[in] r A reactor
+       *
+       * Computes the work ratio of @p r on its executor
+       *
+       * @return the work ratio of @p r
+       * @throw an exception produced by @p r while computing its work ratio
+       *
+       * @sa TREX::transaction::TeleoReactor::workRatio()
+       */
+      double work_ratio(reactor_id r);
+      
+      /** @brief Executor pools
+       *
+       * The named executor pools declared in the agent configuration
+       */
+      std::map<TREX::utils::Symbol, executor_ref> m_executors;
+      /** @brief Resolved reactors executor */
+      std::map<reactor_id, executor_ref>    m_reactor_exec;
+      boost::mutex                          m_exec_mtx;
       
       void loadPlugin(boost::property_tree::ptree::value_type &pg,
                       std::string path);
@@ -133,10 +133,36 @@ Clock::duration_type Clock::sleep() {
 
 Clock::duration_type Clock::doSleep() {
   Clock::duration_type delay = getSleepDelay();
-  sleep(delay);
+  wait(delay);
   return delay;
 }
 
+void Clock::wait(Clock::duration_type const &delay) {
+  boost::mutex::scoped_lock lock(m_wake_mtx);
+  
+  if( delay>Clock::duration_type::zero() && !m_woken ) {
+    typedef CHRONO::steady_clock steady;
+    // The deadline is based on a monotonic clock and we only wait for
+    // relative durations so wall clock adjustments do not affect the wait
+    steady::time_point deadline = steady::now()
+      +CHRONO::duration_cast<steady::duration>(delay);
+    
+    for(steady::duration left = deadline-steady::now();
+        !m_woken && left>steady::duration::zero();
+        left = deadline-steady::now()) {
+      CHRONO::microseconds us = CHRONO::duration_cast<CHRONO::microseconds>(left);
+      m_wake_cond.timed_wait(lock, boost::posix_time::microseconds(us.count()+1));
+    }
+  }
+  m_woken = false;
+}
+
+void Clock::wake() {
+  boost::mutex::scoped_lock lock(m_wake_mtx);
+  m_woken = true;
+  m_wake_cond.notify_all();
+}
+
 TREX::utils::log::stream Clock::syslog(utils::Symbol const &kind) const {
   if( m_started )
     return m_log->syslog(m_last, "clock", kind);
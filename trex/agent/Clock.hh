@@ -50,6 +50,9 @@
 # include <trex/utils/ErrnoExcept.hh>
 # include <trex/utils/asio_fstream.hh>
 
+# include <boost/thread/mutex.hpp>
+# include <boost/thread/condition_variable.hpp>
+
 namespace TREX {
   namespace agent {
     
@@ -114,6 +117,22 @@ namespace TREX {
         return std::numeric_limits<TREX::transaction::TICK>::max();
       }
       bool is_free() const;
+      /** @brief Deliberation budget left
+       *
+       * Indicates how much time is left in the current tick before this
+       * clock stops to be free. Clocks with a real time deadline use this 
+       * to let the agent avoid starting deliberation steps that are not 
+       * expected to complete on time.
+       *
+       * @return the time left before the deliberation deadline of the 
+       *         current tick or @c duration_type::max() if this clock does 
+       *         not have such deadline
+       *
+       * @sa is_free() const
+       */
+      virtual duration_type budget_left() const {
+        return duration_type::max();
+      }
             
       
       /** @brief Initial tick
@@ -155,6 +174,16 @@ namespace TREX {
        * @sa void sleep(double)
        */
       duration_type sleep();
+      /** @brief Interrupt sleep
+       *
+       * Wakes up the thread currently sleeping through sleep(). If no
+       * thread is sleeping then the next call to sleep() will return
+       * immediately. This is used by the agent to react to events
+       * received by event driven reactors before the end of the tick.
+       *
+       * @sa duration_type sleep()
+       */
+      virtual void wake();
       
       
       /** @brief Process sleep
@@ -192,6 +221,15 @@ namespace TREX {
       
     protected:
       virtual duration_type doSleep();
+      /** @brief Interruptible sleep
+       * @param[in] delay A duration
+       *
+       * Put the calling thread asleep for @p delay or until wake()
+       * is called.
+       *
+       * @sa wake()
+       */
+      void wait(duration_type const &delay);
       
       
       /** @brief Check if clock free
@@ -238,7 +276,8 @@ namespace TREX {
        * @a sleepSeconds
        */
       explicit Clock(duration_type const &sleep)
-      :m_sleep(sleep), m_started(false), m_data(m_log->service()) {}
+      :m_sleep(sleep), m_woken(false), m_started(false),
+      m_data(m_log->service()) {}
       
       /** @brief Internal start method
        *
@@ -267,6 +306,10 @@ namespace TREX {
       duration_type const m_sleep;
       utils::SingletonUse<utils::LogManager> m_log;
       
+      boost::mutex              m_wake_mtx;
+      boost::condition_variable m_wake_cond;
+      bool                      m_woken;
+      
       void log_tick() const ;
       
       // Logging related attributes
@@ -36,6 +36,10 @@ namespace TREX {
       
       std::string info() const;
       
+      void wake() {
+        m_clock->wake();
+      }
+      
     private:
       clock_ref     m_clock;
       date_type     m_epoch;
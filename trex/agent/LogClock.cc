@@ -34,9 +34,13 @@
 #include "LogClock.hh"
 
 #include <trex/utils/chrono_helper.hh>
+#include <trex/transaction/bits/binary_log.hh>
 
 #include <boost/date_time/posix_time/posix_time_io.hpp>
 
+#include <fstream>
+#include <sstream>
+
 
 using namespace TREX::agent;
 using namespace TREX::transaction;
@@ -47,6 +51,91 @@ namespace xml = boost::property_tree::xml_parser;
 
 namespace {
   Clock::xml_factory::declare<LogClock> decl("LogClock");
+  
+  namespace bl=TREX::transaction::details::binary_log;
+  
+  /*
+   * Extract the date of a clock log line. Each tick is logged by 
+   * Clock::log_tick on its own line which allows to locate them 
+   * without parsing the whole xml document.
+   */
+  bool tick_line(std::string const &line, TICK &date) {
+    static std::string const tag("<tick value=\"");
+    size_t pos = line.find(tag), last;
+    
+    if( std::string::npos==pos )
+      return false;
+    pos += tag.length();
+    last = line.find('"', pos);
+    if( std::string::npos==last )
+      return false;
+    try {
+      date = string_cast<TICK>(line.substr(pos, last-pos));
+    } catch(bad_string_cast const &) {
+      return false;
+    }
+    return true;
+  }
+  
+  /*
+   * Load the tick index of a clock log from idx_file and complete it 
+   * with the ticks of the log that are not yet indexed. The index is 
+   * saved back when it was updated. Returns the number of ticks added.
+   */
+  size_t index_clock_log(std::istream &log, std::string const &idx_file,
+                         bl::tick_index &index) {
+    std::ifstream in(idx_file.c_str(), std::ios::binary);
+    std::string line;
+    TICK date;
+    
+    if( in ) {
+      std::string content((std::istreambuf_iterator<char>(in)),
+                          std::istreambuf_iterator<char>());
+      bl::decoder idx(content.data(), content.data()+content.length());
+      
+      try {
+        index.decode(idx);
+        if( !index.empty() ) {
+          // Check that the last entry refers to its tick in the log
+          log.seekg(index.back().second);
+          if( !std::getline(log, line) || !tick_line(line, date) ||
+              date!=index.back().first )
+            throw bl::format_error("tick index does not match the log");
+        }
+      } catch(bl::format_error const &e) {
+        index = bl::tick_index();
+      }
+    }
+    size_t loaded = index.size();
+    
+    // Index the ticks that are not in the file
+    log.clear();
+    log.seekg(index.empty()?0:index.back().second);
+    if( !index.empty() )
+      std::getline(log, line); // skip the last tick indexed
+    for(std::streamoff pos=log.tellg(); std::getline(log, line); 
+        pos=log.tellg()) {
+      if( tick_line(line, date) ) {
+        try {
+          index.add(date, pos);
+        } catch(bl::format_error const &e) {
+          break; // ticks are not sorted : stop here
+        }
+      }
+    }
+    log.clear();
+    if( index.size()>loaded ) {
+      // Try to save the updated index for later replays
+      bl::encoder out;
+      
+      bl::tick_index::encode_header(out);
+      for(bl::tick_index::iterator i=index.begin(); index.end()!=i; ++i)
+        bl::tick_index::encode_entry(out, i->first, i->second);
+      std::ofstream save(idx_file.c_str(), std::ios::binary|std::ios::trunc);
+      save.write(out.str().c_str(), out.str().length());
+    }
+    return index.size()-loaded;
+  }
 }
 
 /*
@@ -73,9 +162,33 @@ LogClock::LogClock(bpt::ptree::value_type &node)
   file = log->use(file, found);
   if( !found )
     throw XmlError(node, "Unable to locate file \""+file+"\"");
+  // the optional replay window
+  boost::optional<TICK>
+    start = parse_attr< boost::optional<TICK> >(node, "start"),
+    end = parse_attr< boost::optional<TICK> >(node, "end");
+  if( start && end && *end<*start )
+    throw XmlError(node, "end tick is before start tick");
+  std::ifstream log_file(file.c_str(), std::ios::binary);
+  if( !log_file )
+    throw XmlError(node, "Unable to open file \""+file+"\"");
+  // locate the ticks through the log tick index
+  bl::tick_index index;
+  size_t added = index_clock_log(log_file, file+".idx", index);
+  if( added>0 )
+    syslog(TREX::utils::log::info)<<"Indexed "<<added<<" ticks missing from \""
+                                  <<file<<".idx\"";
+  if( index.empty() ) 
+    throw XmlError(node, "clock log has no valid tick.");
+  
   bpt::ptree tks;
-  // parse the log
-  read_xml(file, tks, xml::no_comments|xml::trim_whitespace);
+  // parse the log header : everything before the first tick
+  {
+    std::string header(index.begin()->second, '\0');
+    log_file.seekg(0);
+    log_file.read(&header[0], header.length());
+    std::istringstream in(header+"</Clock>");
+    read_xml(in, tks, xml::no_comments|xml::trim_whitespace);
+  }
   if( tks.empty() ) {
     syslog(error)<<"clock log \""<<file<<"\" is empty.";
     throw XmlError(node, "Empty clock log file.");
@@ -95,11 +208,27 @@ LogClock::LogClock(bpt::ptree::value_type &node)
     m_epoch = boost::posix_time::from_time_t(0);
     m_epoch += cvt::to_posix(dur);
   }
-  bpt::ptree::assoc_iterator i, last;
-  boost::tie(i, last) = tks.equal_range("tick");
+  // jump to the start of the window and only parse its ticks
+  bl::tick_index::iterator first = index.begin();
+  if( start )
+    first = index.seek(*start);
+  if( index.end()!=first )
+    log_file.seekg(first->second);
+  else
+    log_file.setstate(std::ios::eofbit);
+  
   boost::optional<transaction::TICK> prev;
-  for(; last!=i; ++i) {
-    tick_info tck(*i);
+  std::string line;
+  TICK date;
+  while( std::getline(log_file, line) ) {
+    if( !tick_line(line, date) )
+      continue;
+    if( end && date>*end )
+      break;
+    bpt::ptree tick_xml;
+    std::istringstream in(line);
+    read_xml(in, tick_xml, xml::no_comments|xml::trim_whitespace);
+    tick_info tck(tick_xml.front());
     if( tck.count>0 ) {
       if( prev ) {
         if( tck.date > 1+(*prev) )
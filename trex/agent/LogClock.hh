@@ -47,6 +47,13 @@ namespace TREX {
      * This cock allow to accurately replay a mission by giving as many atomic 
      * call steps for each tcj as it really occured during the replayed mission.
      *
+     * The clock accepts the optional attributes @c start and @c end to only 
+     * replay the ticks within this window, allowing to start the replay of 
+     * a mission at a given tick. The ticks are located through a tick index
+     * stored next to the log (with the @c .idx extension) which is built on
+     * first use, so only the header of the log and the ticks of the window
+     * are parsed.
+     *
      * @author Frederic Py <fpy@mbari.org>
      * @ingroup agent
      */
@@ -146,6 +146,11 @@ namespace TREX {
        *  <ClockName minutes="2" seconds="20" micros="20000" /> 
        * @endcode
        * All attributes on either definition are expected to be integer.
+       *
+       * The optional @c percent_use attribute (between 5 and 100, 100 by 
+       * default) gives the fraction of the tick that can be used for 
+       * deliberation. Past this deadline the clock is not free anymore and
+       * the agent defers the steps that would not complete on time.
        */  
       explicit rt_clock(boost::property_tree::ptree::value_type &node) 
         :Clock(duration_type::zero()) {
@@ -250,6 +255,22 @@ namespace TREX {
         return CHRONO::duration_cast<duration_type>(m_period);
       }
       
+      /** @brief Deliberation budget left
+       *
+       * @return The time left before the @c percent_use fraction of the
+       *         current tick is consumed
+       */
+      duration_type budget_left() const {
+        typename mutex_type::scoped_lock guard(m_lock);
+        if( NULL!=m_clock.get() ) {
+          typename clock_type::base_time_point t = clock_type::base_clock::now();
+          if( t>=m_sleep )
+            return duration_type::zero();
+          return CHRONO::duration_cast<duration_type>(m_sleep-t);
+        } else
+          return Clock::budget_left();
+      }
+      
       transaction::TICK timeToTick(date_type const &date) const {
         typedef utils::chrono_posix_convert<tick_rate> convert;
     
@@ -0,0 +1,554 @@
+/** @defgroup benchcmd trex_bench command
+ * @brief Micro-benchmarks for TREX core operations
+ *
+ * This module embeds all the code related to the @c trex_bench program
+ *
+ * @h1 trex_bench command usage
+ *
+ * The trex_bench command runs a set of micro-benchmarks over the hot
+ * paths of the TREX core libraries and reports their cost on the
+ * standard output. It can be called like this :
+ * @code
+ * trex_bench [--iterations <n>] [--reactors <n>] [--timelines <n>]
+ *            [--ticks <n>] [--filter <name>]
+ * @endcode
+ *
+ * Each benchmark produces one line with the format
+ * @code
+ * <name>, <iterations>, <total_ns>, <ns_per_op>
+ * @endcode
+ * which allows to compare results of two different builds by simply
+ * diffing or plotting their outputs.
+ *
+ * The benchmarks currently available are:
+ * @li @c symbol.create  creation of new symbols
+ * @li @c symbol.lookup  creation of already existing symbols
+ * @li @c obs.copy       copy of a fully instantiated observation
+ * @li @c goal.copy      copy of a fully instantiated goal
+ * @li @c goal.as_tree   serialization of a goal into a property tree
+ * @li @c domain.int     intersect/restrict of integer intervals
+ * @li @c domain.float   intersect/restrict of float intervals
+ * @li @c domain.enum    intersect/restrict of enumerated domains
+ * @li @c domain.batch   intersection test of a batch of 1024 integer 
+ *                       intervals against a dispatch window
+ * @li @c external.dispatch posting of goals on an External timeline 
+ *                       along with their dispatching to the timeline 
+ *                       owner
+ * @li @c agent.tick     a full agent tick on a synthetic graph of
+ *                       @c --reactors reactors each providing
+ *                       @c --timelines timelines
+ *
+ * @note This command is only built when the @c WITH_BENCH cmake option
+ *       is enabled
+ *
+ * @ingroup commands
+ */
+
+/** @file Bench.cc
+ * @brief TREX micro-benchmarks
+ *
+ * This file implements a set of micro-benchmarks for TREX core
+ * operations
+ *
+ * @ingroup benchcmd
+ */
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2011, MBARI.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the TREX Project nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <trex/utils/TREXversion.hh>
+#include <trex/agent/Agent.hh>
+#include <trex/agent/StepClock.hh>
+
+#include <trex/domain/IntegerDomain.hh>
+#include <trex/domain/FloatDomain.hh>
+#include <trex/domain/BooleanDomain.hh>
+#include <trex/domain/StringDomain.hh>
+#include <trex/domain/EnumDomain.hh>
+#include <trex/domain/interval_batch.hh>
+
+#include <boost/program_options.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/bind.hpp>
+
+using namespace TREX::agent;
+using namespace TREX::utils;
+using namespace TREX::transaction;
+
+namespace po=boost::program_options;
+
+namespace {
+  
+  /** @brief entry point to TREX system log */
+  SingletonUse<LogManager> s_log;
+  
+  po::options_description opt("Usage:\n"
+                              "  trex_bench [options]\n\n"
+                              "Allowed options");
+  
+  typedef TeleoReactor::rt_clock rt_clock;
+  
+  /** @brief Benchmark runner
+   *
+   * Maintain the benchmark parameters and execute each benchmark
+   * that matches the name filter.
+   *
+   * @ingroup benchcmd
+   */
+  class bench_runner {
+  public:
+    typedef boost::function<void (size_t)> bench_fn;
+    
+    bench_runner(size_t iter, std::string const &filter)
+    :m_iter(iter), m_filter(filter) {}
+    
+    size_t iterations() const {
+      return m_iter;
+    }
+    
+    /** @brief Check if benchmark @p name matches the name filter */
+    bool enabled(std::string const &name) const {
+      return m_filter.empty() || std::string::npos!=name.find(m_filter);
+    }
+    
+    /** @brief Execute a benchmark
+     * @param[in] name The benchmark name
+     * @param[in] fn The benchmark body
+     * @param[in] n The number of iterations
+     *
+     * Call @p fn once with @p n as argument -- the body is expected
+     * to loop @p n times over the operation to measure -- and report
+     * the time it took.
+     */
+    void run(std::string const &name, bench_fn fn, size_t n) {
+      if( !enabled(name) )
+        return;
+      rt_clock::time_point start = rt_clock::now();
+      fn(n);
+      CHRONO::nanoseconds
+        ns = CHRONO::duration_cast<CHRONO::nanoseconds>(rt_clock::now()-start);
+      double per_op = n>0 ? static_cast<double>(ns.count())/n : 0.0;
+      
+      std::cout<<name<<", "<<n<<", "<<ns.count()<<", "<<per_op<<std::endl;
+    }
+    void run(std::string const &name, bench_fn fn) {
+      run(name, fn, m_iter);
+    }
+    
+  private:
+    size_t      m_iter;
+    std::string m_filter;
+  }; // ::bench_runner
+  
+  /** @brief Prevent the compiler from discarding a result
+   *
+   * Make @p v escape -- through an empty asm statement that may read it 
+   * or, when not available, by writing its address into a volatile sink --
+   * so the computation of @p v is not optimized away.
+   */
+  void const * volatile s_sink = NULL;
+  
+  template<typename Ty>
+  void keep(Ty const &v) {
+#ifdef __GNUC__
+    asm volatile("" : : "r"(&v) : "memory");
+#else
+    s_sink = &v;
+#endif
+  }
+  
+  /*
+   * Symbol benchmarks
+   */
+  void symbol_create(size_t n) {
+    std::string const base("bench_sym_");
+    
+    for(size_t i=0; i<n; ++i)
+      keep(Symbol(base+boost::lexical_cast<std::string>(i)));
+  }
+  
+  void symbol_lookup(size_t n) {
+    std::vector<std::string> names;
+    
+    for(size_t i=0; i<64; ++i) {
+      names.push_back("bench_sym_"+boost::lexical_cast<std::string>(i));
+      Symbol tmp(names.back());
+    }
+    for(size_t i=0; i<n; ++i)
+      keep(Symbol(names[i%names.size()]));
+  }
+  
+  /*
+   * Token benchmarks
+   */
+  template<class Pred>
+  void fill_attributes(Pred &p) {
+    p.restrictAttribute(Variable("count", IntegerDomain(0, 100)));
+    p.restrictAttribute(Variable("ratio", FloatDomain(0.5)));
+    p.restrictAttribute(Variable("flag", BooleanDomain(true)));
+    p.restrictAttribute(Variable("label", StringDomain("bench")));
+  }
+  
+  void obs_copy(size_t n) {
+    Observation o("bench_tl", "Holds");
+    fill_attributes(o);
+    for(size_t i=0; i<n; ++i) {
+      Observation cpy(o);
+      keep(cpy);
+    }
+  }
+  
+  Goal make_goal() {
+    Goal g("bench_tl", "Holds");
+    fill_attributes(g);
+    g.restrictStart(IntegerDomain(10, 20));
+    return g;
+  }
+  
+  void goal_copy(size_t n) {
+    Goal g = make_goal();
+    
+    for(size_t i=0; i<n; ++i) {
+      Goal cpy(g);
+      keep(cpy);
+    }
+  }
+  
+  void goal_as_tree(size_t n) {
+    Goal g = make_goal();
+    
+    for(size_t i=0; i<n; ++i)
+      keep(g.as_tree());
+  }
+  
+  /*
+   * Domain benchmarks
+   */
+  void domain_int(size_t n) {
+    IntegerDomain a(0, 1000), b(500, 1500);
+    
+    for(size_t i=0; i<n; ++i) {
+      IntegerDomain tmp(a);
+      if( tmp.intersect(b) )
+        tmp.restrictWith(b);
+      keep(tmp);
+    }
+  }
+  
+  void domain_float(size_t n) {
+    FloatDomain a(0.0, 1000.0), b(500.0, 1500.0);
+    
+    for(size_t i=0; i<n; ++i) {
+      FloatDomain tmp(a);
+      if( tmp.intersect(b) )
+        tmp.restrictWith(b);
+      keep(tmp);
+    }
+  }
+  
+  void domain_batch(size_t n) {
+    interval_batch<IntegerDomain::base_type> batch;
+    interval_batch<IntegerDomain::base_type>::result_type res;
+    IntegerDomain window(100, 200);
+    
+    batch.reserve(1024);
+    for(long long i=0; i<1024; ++i)
+      batch.push_back(IntegerDomain(i, i+50));
+    for(size_t i=0; i<n; ++i)
+      keep(batch.intersect(window, res));
+  }
+  
+  void domain_enum(size_t n) {
+    std::vector<Symbol> all, some;
+    
+    for(size_t i=0; i<16; ++i) {
+      all.push_back("v"+boost::lexical_cast<std::string>(i));
+      if( i%2 )
+        some.push_back(all.back());
+    }
+    EnumDomain a(all.begin(), all.end()), b(some.begin(), some.end());
+    
+    for(size_t i=0; i<n; ++i) {
+      EnumDomain tmp(a);
+      if( tmp.intersect(b) )
+        tmp.restrictWith(b);
+      keep(tmp);
+    }
+  }
+  
+  /*
+   * Agent benchmarks
+   */
+  
+  /** @brief Synthetic reactor
+   *
+   * A reactor that posts a new observation on each of its Internal
+   * timelines every tick and a goal on each of its External ones.
+   * Chaining these reactors gives a graph that exercises observation
+   * propagation along with goal dispatching.
+   *
+   * @ingroup benchcmd
+   */
+  class BenchReactor :public TeleoReactor {
+  public:
+    BenchReactor(TeleoReactor::xml_arg_type arg)
+    :TeleoReactor(arg, true, false) {
+      boost::property_tree::ptree &node = xml_factory::node(arg).second;
+      
+      for(boost::property_tree::ptree::iterator i=node.begin();
+          node.end()!=i; ++i)
+        if( is_tag(*i, "Internal") )
+          m_owned.push_back(parse_attr<Symbol>(*i, "name"));
+    }
+    ~BenchReactor() {}
+    
+    /** @brief external::post_goal/dispatch benchmark body
+     * @param[in] n Number of goals to post
+     *
+     * Post @p n goals on the first External timeline of this reactor 
+     * and dispatch them to the timeline owner every 64 goals. All the 
+     * goals start within the dispatch window so the pending queue does 
+     * not grow.
+     *
+     * @pre the agent is not running
+     */
+    void post_dispatch(size_t n) {
+      external_iterator tl = ext_begin();
+      std::vector<goal_id> pool;
+      std::list<goal_id> sent;
+      
+      if( !tl.valid() )
+        return;
+      for(size_t i=0; i<64; ++i) {
+        goal_id g(new Goal(tl->name(), "Holds"));
+        g->restrictStart(IntegerDomain(1, 1+i%8));
+        pool.push_back(g);
+      }
+      for(size_t i=0; i<n; ++i) {
+        keep(tl.post_goal(pool[i%pool.size()]));
+        if( 0==(i+1)%pool.size() ) {
+          tl.dispatch(0, sent);
+          keep(sent.size());
+          sent.clear();
+        }
+      }
+      tl.dispatch(0, sent);
+    }
+    
+  private:
+    void handleRequest(goal_id const &g) {
+      keep(g);
+    }
+    void notify(Observation const &obs) {
+      keep(obs);
+    }
+    
+    void handleTickStart() {
+      for(external_iterator i=ext_begin(); ext_end()!=i; ++i) {
+        Goal g(i->name(), "Holds");
+        g.restrictStart(IntegerDomain(getCurrentTick()+1, 
+                                      getCurrentTick()+getExecLatency()+
+                                      getLookAhead()+1));
+        postGoal(g);
+      }
+    }
+    bool synchronize() {
+      TICK now = getCurrentTick();
+      
+      for(std::vector<Symbol>::const_iterator i=m_owned.begin();
+          m_owned.end()!=i; ++i) {
+        Observation o(*i, (now%2)?"Holds":"Idle");
+        o.restrictAttribute("tick", IntegerDomain(now));
+        postObservation(o);
+      }
+      return true;
+    }
+    
+    std::vector<Symbol> m_owned;
+  }; // ::BenchReactor
+  
+  TeleoReactor::xml_factory::declare<BenchReactor> decl("BenchReactor");
+  
+  /** @brief Build a synthetic agent configuration
+   * @param[in] reactors Number of reactors
+   * @param[in] timelines Number of timelines per reactor
+   *
+   * Reactor @c r@<i@> provides the timelines @c r@<i@>_t@<j@> and
+   * uses all the timelines of @c r@<i-1@>
+   */
+  boost::property_tree::ptree bench_graph(size_t reactors, size_t timelines) {
+    boost::property_tree::ptree ret;
+    
+    for(size_t i=0; i<reactors; ++i) {
+      boost::property_tree::ptree r;
+      std::string name = "r"+boost::lexical_cast<std::string>(i);
+      
+      r.put("<xmlattr>.name", name);
+      r.put("<xmlattr>.latency", 0);
+      r.put("<xmlattr>.lookahead", 10);
+      r.put("<xmlattr>.log", false);
+      for(size_t j=0; j<timelines; ++j) {
+        boost::property_tree::ptree tl;
+        tl.put("<xmlattr>.name", name+"_t"+boost::lexical_cast<std::string>(j));
+        r.add_child("Internal", tl);
+        if( i>0 ) {
+          tl.put("<xmlattr>.name", "r"+boost::lexical_cast<std::string>(i-1)
+                 +"_t"+boost::lexical_cast<std::string>(j));
+          r.add_child("External", tl);
+        }
+      }
+      ret.add_child("BenchReactor", r);
+    }
+    return ret;
+  }
+  
+  /** @brief Create the client reactor for the dispatch benchmark
+   * @param[in] agent An agent
+   *
+   * Add to @p agent a reactor providing one timeline and a client
+   * reactor using this timeline
+   *
+   * @return the client reactor
+   */
+  BenchReactor *dispatch_client(Agent &agent) {
+    boost::property_tree::ptree conf = bench_graph(2, 1);
+    TeleoReactor *last = NULL;
+    
+    for(boost::property_tree::ptree::iterator i=conf.begin(); 
+        conf.end()!=i; ++i)
+      last = agent.add_reactor(*i);
+    return dynamic_cast<BenchReactor *>(last);
+  }
+  
+  void agent_run(Agent &agent, size_t) {
+    agent.run();
+  }
+  
+}
+
+/** @brief trex_bench main function
+ * @param argc Number of arguments
+ * @param argv command line arguments
+ *
+ * This is the main function for the @c trex_bench program.
+ *
+ * @ingroup benchcmd
+ */
+int main(int argc, char **argv) {
+  opt.add_options()
+  ("help,h", "produce help message and exit")
+  ("version,v", "print trex version and exit")
+  ("log-dir,L", po::value<std::string>(), "Set log directory")
+  ("iterations,n", po::value<size_t>()->default_value(100000),
+   "Number of iterations for each micro-benchmark")
+  ("reactors,r", po::value<size_t>()->default_value(10),
+   "Number of reactors for agent benchmarks")
+  ("timelines,t", po::value<size_t>()->default_value(5),
+   "Number of timelines per reactor for agent benchmarks")
+  ("ticks", po::value<size_t>()->default_value(1000),
+   "Number of ticks for agent benchmarks")
+  ("filter,f", po::value<std::string>()->default_value(""),
+   "Only run benchmarks which name contains this string");
+  
+  po::variables_map opt_val;
+  
+  try {
+    po::store(po::parse_command_line(argc, argv, opt), opt_val);
+    po::notify(opt_val);
+  } catch(boost::program_options::error const &e) {
+    std::cerr<<"command line error: "<<e.what()<<'\n'
+    <<opt<<std::endl;
+    return 1;
+  }
+  
+  if( opt_val.count("help") ) {
+    std::cout<<"TREX micro-benchmarks\n"<<opt<<"\nExample:\n  "
+    <<"trex_bench --filter=domain -n 1000000\n"
+    <<"  - run all the domain benchmarks with 1000000 iterations each\n"
+    <<std::endl;
+    return 0;
+  }
+  if( opt_val.count("version") ) {
+    std::cout<<"trex_bench for trex "<<TREX::version::full_str()<<std::endl;
+    return 0;
+  }
+  
+  if( opt_val.count("log-dir") )
+    s_log->setLogPath(opt_val["log-dir"].as<std::string>());
+  else
+    s_log->logPath();
+  
+  bench_runner bench(opt_val["iterations"].as<size_t>(),
+                     opt_val["filter"].as<std::string>());
+  size_t reactors = opt_val["reactors"].as<size_t>(),
+    timelines = opt_val["timelines"].as<size_t>(),
+    ticks = opt_val["ticks"].as<size_t>();
+  
+  try {
+    std::cout<<"# name, iterations, total_ns, ns_per_op"<<std::endl;
+    bench.run("symbol.create", &symbol_create);
+    bench.run("symbol.lookup", &symbol_lookup);
+    bench.run("obs.copy", &obs_copy);
+    bench.run("goal.copy", &goal_copy);
+    bench.run("goal.as_tree", &goal_as_tree);
+    bench.run("domain.int", &domain_int);
+    bench.run("domain.float", &domain_float);
+    bench.run("domain.enum", &domain_enum);
+    bench.run("domain.batch", &domain_batch);
+    if( bench.enabled("external.dispatch") ) {
+      clock_ref clk(new StepClock(Clock::duration_type(0), 1));
+      Agent agent("bench_dispatch", 1, clk);
+      BenchReactor *client = dispatch_client(agent);
+      
+      if( NULL!=client )
+        bench.run("external.dispatch", 
+                  boost::bind(&BenchReactor::post_dispatch, client, _1));
+    }
+    if( bench.enabled("agent.tick") ) {
+      // build the agent before measuring its execution
+      clock_ref clk(new StepClock(Clock::duration_type(0), 1));
+      Agent agent("bench", ticks, clk);
+      boost::property_tree::ptree conf = bench_graph(reactors, timelines);
+      
+      agent.add_reactors(conf);
+      bench.run("agent.tick", boost::bind(&agent_run, boost::ref(agent), _1),
+                ticks);
+    }
+  } catch(Exception const &e) {
+    std::cerr<<"TREX error: "<<e<<std::endl;
+    return 1;
+  } catch(std::exception const &e) {
+    std::cerr<<"exception: "<<e.what()<<std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,158 @@
+/** @defgroup blogcmd blog2txt command
+ * @brief Binary log decoder
+ *
+ * This module embeds all the code related to the @c blog2txt program
+ *
+ * @h1 blog2txt command usage
+ *
+ * The blog2txt command converts the structured binary log file 
+ * @c TREX.blog produced by an agent back into text using the same
+ * format as @c TREX.log. It can be called like this :
+ * @code
+ * blog2txt <file> [-o <output>]
+ * @endcode
+ * Where :
+ * @li @c @<file@> is the binary log to decode
+ * @li @c @<output@> is the text file to produce. If not specified
+ *     the text is written on the standard output
+ *
+ * @sa TREX::utils::log::binary_file
+ *
+ * @ingroup commands
+ */
+
+/** @file BlogDecode.cc
+ * @brief Binary log decoder
+ *
+ * This file implements the decoder of TREX binary log files
+ *
+ * @ingroup blogcmd
+ */
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2011, MBARI.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the TREX Project nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <trex/utils/log/binary_file.hh>
+#include <trex/utils/Exception.hh>
+#include <trex/utils/TREXversion.hh>
+
+#include <iostream>
+#include <fstream>
+
+#include <boost/program_options.hpp>
+
+using namespace TREX::utils;
+
+namespace po=boost::program_options;
+
+namespace {
+  
+  po::options_description opt("Usage:\n"
+                              "  blog2txt <file> [options]\n\n"
+                              "Allowed options");
+  
+}
+
+/** @brief blog2txt main function
+ * @param argc Number of arguments
+ * @param argv command line arguments
+ *
+ * This is the main function for the @c blog2txt program.
+ *
+ * @ingroup blogcmd
+ */
+int main(int argc, char **argv) {
+  std::string input;
+  po::options_description hidden("Hidden options"), cmd_line;
+  
+  opt.add_options()
+  ("help,h", "produce help message and exit")
+  ("version,v", "print trex version and exit")
+  ("output,o", po::value<std::string>(), "Set the output text file");
+  hidden.add_options()("input", po::value<std::string>(&input),
+                       "The binary log file");
+  po::positional_options_description p;
+  p.add("input", 1);
+  
+  cmd_line.add(opt).add(hidden);
+  po::variables_map opt_val;
+  
+  try {
+    po::store(po::command_line_parser(argc, argv).options(cmd_line).positional(p).run(),
+              opt_val);
+    po::notify(opt_val);
+  } catch(boost::program_options::error const &e) {
+    std::cerr<<"command line error: "<<e.what()<<'\n'
+    <<opt<<std::endl;
+    return 1;
+  }
+  
+  if( opt_val.count("help") ) {
+    std::cout<<"TREX binary log decoder\n"<<opt<<"\nExample:\n  "
+    <<"blog2txt TREX.blog -o TREX.blog.txt\n"
+    <<"  - decode TREX.blog into TREX.blog.txt\n"<<std::endl;
+    return 0;
+  }
+  if( opt_val.count("version") ) {
+    std::cout<<"blog2txt for trex "<<TREX::version::full_str()<<std::endl;
+    return 0;
+  }
+  if( !opt_val.count("input") ) {
+    std::cerr<<"No input file specified\n"
+    <<opt<<std::endl;
+    return 1;
+  }
+  
+  std::ifstream in(input.c_str(), std::ios::binary);
+  if( !in ) {
+    std::cerr<<"Unable to open \""<<input<<'\"'<<std::endl;
+    return 1;
+  }
+  
+  try {
+    if( opt_val.count("output") ) {
+      std::string name = opt_val["output"].as<std::string>();
+      std::ofstream out(name.c_str());
+      
+      if( !out ) {
+        std::cerr<<"Unable to create \""<<name<<'\"'<<std::endl;
+        return 1;
+      }
+      log::binary_file::decode(in, out);
+    } else
+      log::binary_file::decode(in, std::cout);
+  } catch(Exception const &e) {
+    std::cerr<<"Error while decoding \""<<input<<"\": "<<e<<std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -41,6 +41,8 @@
 #include <sstream>
 #include "DomainVisitor.hh"
 
+#include <trex/utils/json_writer.hh>
+
 using namespace TREX::transaction;
 namespace bpt=boost::property_tree;
 /*
@@ -108,6 +110,19 @@ boost::property_tree::ptree BasicEnumerated::build_tree() const {
   return values;
 }
 
+void BasicEnumerated::json_content(TREX::utils::json_writer &out) const {
+  size_t len = getSize();
+  
+  if( len>0 ) {
+    out.begin_object().key("elem").begin_array();
+    for(size_t i=0; i<len; ++i)
+      out.begin_object().key("value").value(getStringValue(i)).end_object();
+    out.end_array().end_object();
+  } else
+    // same as the empty tree of build_tree
+    out.value("");
+}
+
 
 // manipulators
 
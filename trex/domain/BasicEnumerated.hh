@@ -176,6 +176,7 @@ namespace TREX {
       
     private:
       boost::property_tree::ptree build_tree() const;
+      void json_content(TREX::utils::json_writer &out) const;
       
       void accept(DomainVisitor &visitor) const;
       std::ostream &print_domain(std::ostream &out) const;
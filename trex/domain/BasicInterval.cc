@@ -40,6 +40,8 @@
  */
 #include "DomainVisitor.hh"
 
+#include <trex/utils/json_writer.hh>
+
 using namespace TREX::transaction;
 namespace bpt=boost::property_tree;
 
@@ -102,6 +104,23 @@ boost::property_tree::ptree BasicInterval::build_tree() const {
   return info;
 }
 
+void BasicInterval::json_content(TREX::utils::json_writer &out) const {
+  if( hasLower() || hasUpper() ) {
+    out.begin_object();
+    if( isSingleton() )
+      out.key("value").value(getStringSingleton());
+    else {
+      if( hasLower() )
+        out.key("min").value(getStringLower());
+      if( hasUpper() )
+        out.key("max").value(getStringUpper());
+    }
+    out.end_object();
+  } else
+    // same as the empty tree of build_tree
+    out.value("");
+}
+
 
 // manipulators
 
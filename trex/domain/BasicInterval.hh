@@ -129,6 +129,7 @@ namespace TREX {
       
     private:
       boost::property_tree::ptree build_tree() const;
+      void json_content(TREX::utils::json_writer &out) const;
 
       
       void accept(DomainVisitor &visitor) const;
@@ -40,6 +40,8 @@
 #include <sstream>
 #include "DomainVisitor.hh"
 
+#include <trex/utils/json_writer.hh>
+
 using namespace TREX::transaction;
 
 std::string DomainExcept::build_message(DomainBase const &d, 
@@ -71,3 +73,18 @@ boost::property_tree::ptree DomainBase::as_tree() const {
   return ret;
 }
 
+void DomainBase::json_members(TREX::utils::json_writer &out) const {
+  out.key(getTypeName().str());
+  json_content(out);
+}
+
+void DomainBase::json_content(TREX::utils::json_writer &out) const {
+  out.tree(build_tree());
+}
+
+void DomainBase::json_value(TREX::utils::json_writer &out) const {
+  out.begin_object();
+  json_members(out);
+  out.end_object();
+}
+
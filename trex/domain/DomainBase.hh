@@ -417,6 +417,16 @@ namespace TREX {
       typedef TREX::utils::XmlFactory<DomainBase, SHARED_PTR<DomainBase> > xml_factory;
       virtual boost::property_tree::ptree build_tree() const=0;
       
+      /** @brief json members
+       *
+       * @param[in,out] out A json writer
+       *
+       * Write the type of this domain and its content as a member of 
+       * the json object currently opened in @p out. This is the json 
+       * equivalent of as_tree() without the enclosing object.
+       */
+      void json_members(TREX::utils::json_writer &out) const;
+      
     protected:
       
       /** @brief Constructor
@@ -468,6 +478,15 @@ namespace TREX {
        * @sa std::ostream &print_to(std::ostream &out) const
        */
       virtual std::ostream &print_domain(std::ostream &out) const =0;
+      /** @brief json content
+       *
+       * @param[in,out] out A json writer
+       *
+       * Write the value of this domain into @p out. The default 
+       * implementation writes build_tree()
+       */
+      virtual void json_content(TREX::utils::json_writer &out) const;
+      void json_value(TREX::utils::json_writer &out) const;
       
       /** @brief singleton value
        * This method is called by getSingleton() to get the actual value of
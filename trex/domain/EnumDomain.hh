@@ -124,7 +124,7 @@ namespace TREX {
        * Allocates a new copy of current instance
        */
       DomainBase *copy() const {
-	return new EnumDomain(begin(), end());
+	return new EnumDomain(*this);
       }
     }; // TREX::transaction::EnumDomain
 
@@ -49,11 +49,8 @@
 #ifndef H_EnumeratedDomain 
 # define H_EnumeratedDomain
 
-# include <algorithm>
-# include <iterator>
-# include <set>
-
 # include "BasicEnumerated.hh"
+# include "bits/flat_set.hh"
 
 namespace TREX {
   namespace transaction {
@@ -71,12 +68,10 @@ namespace TREX {
      * 
      * @pre @e Comp is expected to be a complete order over @e Ty
      *
-     * @note As for now this domain relies on the set standard C++ compiler.
-     * This results on the need to have the elements being comparable though
-     * an ordering functor. We may in the future use the more general
-     * collection_set, provided by next C++ standard (and already available
-     * on the boost library),
-     * which will remove this requirement.
+     * @note This domain stores its values in a sorted flat array that keeps
+     * small domains inline. This results on the need to have the elements 
+     * being comparable though an ordering functor but allows to implement
+     * intersection and restriction as linear merges.
      *
      * @note To ease implementation of this class the full domain is
      * represented by the fact that the subjacent value collection is empty.
@@ -93,7 +88,7 @@ namespace TREX {
     class EnumeratedDomain :public BasicEnumerated {
     private:
       /** @brief Internal domain elements container */
-      typedef std::set<Ty, Comp> container_type;
+      typedef details::flat_set<Ty, Comp> container_type;
       
     public:
       /** @brief Possible values iterator */
@@ -206,13 +201,8 @@ namespace TREX {
       }
       
       boost::any getElement(size_t i) const {
-        typename container_type::const_iterator it = begin();
-        // std::set doe not provide operator[]
-        // I need to do the iteration by my own
-        for(; i>0 && end()!=it; ++it, --i);
-        // if it==end() the behavior is undefined
-        // but that also means that i>=getSize()
-        return *it;
+        // if i>=getSize() the behavior is undefined
+        return m_elements[i];
       }
       /** @brief First element
        *
@@ -303,25 +293,7 @@ namespace TREX {
       else {
         EnumeratedDomain<Ty, Cmp> const &ref 
         = dynamic_cast<EnumeratedDomain<Ty, Cmp> const &>(other);
-        if( isFull() || ref.isFull() )
-          return true;
-        else {
-          iterator i = begin(), j = ref.begin();
-          iterator const endi = end();
-          iterator const endj = ref.end();
-          
-          while( endi!=i && endj!=j ) {
-            if( m_elements.key_comp()(*i, *j) )
-              ++i;
-            else if( m_elements.key_comp()(*j, *i) )
-              ++j;
-            else 
-              // *i and *j are equals -> intersection is not empty
-              return true;
-          }
-          // no similar items -> itersection is empty
-          return false;
-        }
+        return isFull() || ref.isFull() || m_elements.intersects(ref.m_elements);
       }
     }
     
@@ -342,14 +314,13 @@ namespace TREX {
         throw EmptyDomain(*this, "Incompatible types");
       else {
         EnumeratedDomain<Ty, Cmp> const &ref 
-        = dynamic_cast<EnumeratedDomain<Ty, Cmp> const &>(other);    
-        container_type tmp;
-        std::set_intersection(begin(), end(), ref.begin(), ref.end(), 
-                              std::inserter(tmp, tmp.begin()), 
-                              m_elements.key_comp());
-        if( tmp.empty() ) 
+        = dynamic_cast<EnumeratedDomain<Ty, Cmp> const &>(other);
+        if( ref.isFull() )
+          return *this;
+        if( isFull() )
+          m_elements = ref.m_elements;
+        else if( !m_elements.intersect_with(ref.m_elements) ) 
           throw EmptyDomain(*this, "intersection is empty.");
-        m_elements.swap(tmp);
       }
       return *this;
     }
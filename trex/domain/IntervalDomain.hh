@@ -398,7 +398,8 @@ namespace TREX {
        * @retval false otherwise
        */
       bool contains(Ty const &val) const {
-	return val==closestTo(val);
+	return ( m_lower.isInfinity() || !bound::s_cmp(val, m_lower.value()) )
+	  && ( m_upper.isInfinity() || !bound::s_cmp(m_upper.value(), val) );
       }
 
       /** @brief Closest value
@@ -426,6 +427,36 @@ namespace TREX {
 
       bool intersect(DomainBase const &other) const;
       bool equals(DomainBase const &other) const;
+      /** @brief Intersection test
+       * @param lo minimum value
+       * @param hi maximum value
+       *
+       * @retval true if this domain intersects [lo, hi]
+       * @retval false otherwise
+       */
+      bool intersect(bound const &lo, bound const &hi) const {
+	return !(m_upper.min(hi)<m_lower.max(lo));
+      }
+      /** @brief Intersection test
+       * @param other Another domain
+       *
+       * Non virtual version of intersect(DomainBase const &) const used
+       * when @p other is statically known to be of this type
+       */
+      bool intersect(IntervalDomain const &other) const {
+	return getTypeName()==other.getTypeName() 
+	  && intersect(other.m_lower, other.m_upper);
+      }
+      /** @brief Equality test
+       * @param other Another domain
+       *
+       * Non virtual version of equals(DomainBase const &) const used
+       * when @p other is statically known to be of this type
+       */
+      bool equals(IntervalDomain const &other) const {
+	return getTypeName()==other.getTypeName() 
+	  && m_lower==other.m_lower && m_upper==other.m_upper;
+      }
       /** @brief Restrict domain possible values
        * @param lo minimum value
        * @param hi maximum value
@@ -440,6 +471,20 @@ namespace TREX {
        */
       DomainBase &restrictWith(bound const &lo, bound const &hi);
       DomainBase &restrictWith(DomainBase const &other);
+      /** @brief Restrict domain possible values
+       * @param other Another domain
+       *
+       * Non virtual version of restrictWith(DomainBase const &) used
+       * when @p other is statically known to be of this type
+       *
+       * @throw EmptyDomain resulting domain is empty or @p other is not 
+       * of the same type
+       */
+      DomainBase &restrictWith(IntervalDomain const &other) {
+	if( getTypeName()!=other.getTypeName() )
+	  throw EmptyDomain(*this, "Incompatible types");
+	return restrictWith(other.m_lower, other.m_upper);
+      }
 
       /** @brief interval lower bound
        *
@@ -124,7 +124,7 @@ namespace TREX {
        * Allocates a new copy of current instance
        */
       DomainBase *copy() const {
-        return new StringDomain(begin(), end());
+        return new StringDomain(*this);
       }
     }; // TREX::transaction::StringDomain
     
@@ -42,6 +42,8 @@
 
 # include "Variable.hh"
 
+# include <trex/utils/json_writer.hh>
+
 using namespace TREX::utils;
 using namespace TREX::transaction;
 
@@ -75,7 +77,7 @@ Variable::Variable(Symbol const &name, DomainBase const &dom)
 }
 
 Variable::Variable(Variable const &other) 
-  :m_name(other.m_name), m_domain(clone(other.m_domain)) {}
+  :m_name(other.m_name), m_domain(other.m_domain) {}
 
 Variable::Variable(boost::property_tree::ptree::value_type &node)
   :m_name(parse_attr<Symbol>(node.second, "name")) {
@@ -93,15 +95,22 @@ Variable::~Variable() {}
 
 Variable &Variable::operator= (Variable const &other) {
   m_name = other.m_name;
-  m_domain.reset(clone(other.m_domain));
+  m_domain = other.m_domain;
   return *this;
 }
 
+DomainBase &Variable::detach() {
+  if( 1!=m_domain.use_count() )
+    m_domain.reset(clone(m_domain));
+  return *m_domain;
+}
+
 Variable &Variable::restrict(DomainBase const &dom) {
   if( !m_domain )
     m_domain.reset(dom.copy());
-  else 
-    m_domain->restrictWith(dom);
+  else if( 1==m_domain.use_count() || !m_domain->equals(dom) )
+    // avoid copying a shared domain when dom won't change it
+    detach().restrictWith(dom);
   return *this;
 }
 
@@ -150,4 +159,15 @@ boost::property_tree::ptree Variable::as_tree() const {
   return ret;
 }
 
+void Variable::json_value(json_writer &out) const {
+  out.begin_object();
+  if( m_domain ) {
+    m_domain->json_members(out);
+    out.key("type").value(m_domain->getTypeName().str());
+  } else
+    out.key("type").value("null");
+  out.key("name").value(name().str());
+  out.end_object();
+}
+
 
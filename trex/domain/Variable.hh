@@ -81,6 +81,10 @@ namespace TREX {
      * Goal excahnged between reactors. They are represented by a
      * symbolic name and its associated domain.
      *
+     * The domain is shared between the copies of a variable and only
+     * duplicated when one of them is restricted (copy on write). Copying
+     * a variable is then as cheap as copying a shared pointer.
+     *
      * @author Frederic Py <fpy@mbari.org>
      * @ingroup domains
      */
@@ -110,7 +114,8 @@ namespace TREX {
       /** @brief Constructor
        * @brief var Another instance
        *
-       * Create a copy of @e var
+       * Create a copy of @e var. The copy shares the domain of @e var
+       * until one of them is restricted.
        */
       Variable(Variable const &var);
       /** @brief Constructor
@@ -292,6 +297,7 @@ namespace TREX {
       domain_ptr m_domain;
       
       std::ostream &print_to(std::ostream &out) const;
+      void json_value(TREX::utils::json_writer &out) const;
       
       /** @brief Entry point to domain XML parsing */
       static TREX::utils::SingletonUse< DomainBase::xml_factory > s_dom_factory;
@@ -303,6 +309,12 @@ namespace TREX {
        * @return a pointer to a copy of @a *dom or a NULL pointer
        */
       static DomainBase *clone(boost::call_traits<Variable::domain_ptr>::param_type dom);
+      /** @brief Get a modifiable domain
+       *
+       * Make a private copy of the domain if it is shared with other
+       * variables so it can be safely restricted.
+       */
+      DomainBase &detach();
       
       /** @brief Constructor
        * @param name A symbolic name
@@ -152,7 +152,7 @@ bool IntervalDomain<Ty, Prot, Cmp>::intersect(DomainBase const &other) const {
   else {
     IntervalDomain<Ty, Prot, Cmp> const &ref
       = dynamic_cast<IntervalDomain<Ty, Prot, Cmp> const &>(other);
-    return !(m_upper.min(ref.m_upper)<m_lower.max(ref.m_lower));
+    return intersect(ref.m_lower, ref.m_upper);
   }
 }
 
@@ -0,0 +1,314 @@
+/* -*- C++ -*- */
+/** @file "bits/flat_set.hh"
+ * @brief flat ordered set with inline storage
+ *
+ * This file defines the container used to store the values of
+ * enumerated domains.
+ *
+ * @ingroup domains
+ */
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ * 
+ *  Copyright (c) 2011, MBARI.
+ *  All rights reserved.
+ * 
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ * 
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the TREX Project nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ * 
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef H_trex_domain_flat_set
+# define H_trex_domain_flat_set
+
+# include <algorithm>
+# include <cstddef>
+# include <functional>
+# include <memory>
+# include <new>
+
+# include <boost/type_traits/aligned_storage.hpp>
+# include <boost/type_traits/alignment_of.hpp>
+
+namespace TREX {
+  namespace transaction {
+    namespace details {
+      
+      /** @brief Flat ordered set
+       *
+       * @tparam Ty   Type of the elements
+       * @tparam Comp Ordering functor
+       * @tparam N    Number of elements stored inline
+       *
+       * A set of unique elements stored in a sorted contiguous array. The 
+       * first @p N elements are stored within the instance itself so small
+       * sets do not allocate any memory, and larger sets switch to a heap 
+       * allocated array.
+       *
+       * As opposed to a @c std::set, copies allocate at most one block and
+       * set operations are linear merges over contiguous memory. Insertion
+       * of a single element is linear but ranges are inserted with a single
+       * sort and merge.
+       *
+       * @pre @p Comp is a strict weak ordering over @p Ty
+       *
+       * @ingroup domains
+       */
+      template<typename Ty, class Comp=std::less<Ty>, size_t N=4>
+      class flat_set {
+      public:
+        typedef Ty         value_type;
+        typedef Comp       key_compare;
+        typedef Ty const  *const_iterator;
+        
+        flat_set()
+        :m_data(inline_data()), m_size(0), m_capacity(N) {}
+        template<class Iter>
+        flat_set(Iter from, Iter to)
+        :m_data(inline_data()), m_size(0), m_capacity(N) {
+          insert(from, to);
+        }
+        flat_set(flat_set const &other)
+        :m_comp(other.m_comp), m_data(inline_data()), m_size(0),
+        m_capacity(N) {
+          assign(other);
+        }
+        ~flat_set() {
+          clear();
+          release();
+        }
+        
+        flat_set &operator=(flat_set const &other) {
+          if( this!=&other ) {
+            clear();
+            assign(other);
+          }
+          return *this;
+        }
+        
+        bool empty() const {
+          return 0==m_size;
+        }
+        size_t size() const {
+          return m_size;
+        }
+        const_iterator begin() const {
+          return m_data;
+        }
+        const_iterator end() const {
+          return m_data+m_size;
+        }
+        /** @brief Element access
+         * @param[in] i An index
+         * @pre @p i is less than size()
+         * @return The @p i th smallest element of the set
+         */
+        Ty const &operator[](size_t i) const {
+          return m_data[i];
+        }
+        key_compare key_comp() const {
+          return m_comp;
+        }
+        
+        /** @brief Find an element
+         * @param[in] val A value
+         * @return An iterator to the element equivalent to @p val or end() 
+         *         if there's none
+         */
+        const_iterator find(Ty const &val) const {
+          const_iterator i = std::lower_bound(begin(), end(), val, m_comp);
+          if( end()!=i && !m_comp(val, *i) )
+            return i;
+          return end();
+        }
+        
+        /** @brief Insert an element
+         * @param[in] val A value
+         * @retval true if @p val was inserted
+         * @retval false if @p val was already in the set
+         */
+        bool insert(Ty const &val) {
+          size_t pos = std::lower_bound(begin(), end(), val, m_comp)-begin();
+          if( pos<m_size && !m_comp(val, m_data[pos]) )
+            return false;
+          
+          Ty tmp(val); // val may refer to one of our elements
+          if( m_size==m_capacity )
+            grow(2*m_capacity);
+          if( pos==m_size )
+            new(m_data+m_size) Ty(tmp);
+          else {
+            new(m_data+m_size) Ty(m_data[m_size-1]);
+            std::copy_backward(m_data+pos, m_data+m_size-1, m_data+m_size);
+            m_data[pos] = tmp;
+          }
+          ++m_size;
+          return true;
+        }
+        /** @brief Insert elements
+         * @tparam Iter An input iterator type
+         * @param[in] from An iterator
+         * @param[in] to An iterator
+         *
+         * Insert all the elements in [@p from, @p to). The new elements are 
+         * appended, sorted and then merged with the current ones.
+         */
+        template<class Iter>
+        void insert(Iter from, Iter to) {
+          size_t const mid = m_size;
+          for( ; to!=from; ++from) {
+            if( m_size==m_capacity )
+              grow(2*m_capacity);
+            new(m_data+m_size) Ty(*from);
+            ++m_size;
+          }
+          if( mid<m_size ) {
+            std::sort(m_data+mid, m_data+m_size, m_comp);
+            std::inplace_merge(m_data, m_data+mid, m_data+m_size, m_comp);
+            truncate(std::unique(m_data, m_data+m_size, equiv(m_comp))-m_data);
+          }
+        }
+        
+        /** @brief Intersection test
+         * @param[in] other Another set
+         * @retval true if this set and @p other have at least one element in 
+         *         common
+         * @retval false otherwise
+         */
+        bool intersects(flat_set const &other) const {
+          const_iterator i = begin(), j = other.begin();
+          
+          while( end()!=i && other.end()!=j ) {
+            if( m_comp(*i, *j) )
+              ++i;
+            else if( m_comp(*j, *i) )
+              ++j;
+            else
+              return true;
+          }
+          return false;
+        }
+        /** @brief Restrict to intersection
+         * @param[in] other Another set
+         *
+         * Remove all the elements that are not in @p other. 
+         *
+         * @retval true if the resulting set is not empty
+         * @retval false if the intersection with @p other is empty. The set 
+         *         is then left unchanged
+         */
+        bool intersect_with(flat_set const &other) {
+          size_t i = 0, w = 0;
+          const_iterator j = other.begin();
+          
+          while( i<m_size && other.end()!=j ) {
+            if( m_comp(m_data[i], *j) )
+              ++i;
+            else if( m_comp(*j, m_data[i]) )
+              ++j;
+            else {
+              if( w!=i )
+                m_data[w] = m_data[i];
+              ++w;
+              ++i;
+              ++j;
+            }
+          }
+          if( 0==w )
+            return false;
+          truncate(w);
+          return true;
+        }
+        
+        void clear() {
+          truncate(0);
+        }
+        
+        bool operator==(flat_set const &other) const {
+          return m_size==other.m_size && std::equal(begin(), end(), other.begin());
+        }
+        bool operator!=(flat_set const &other) const {
+          return !operator==(other);
+        }
+        
+      private:
+        struct equiv {
+          explicit equiv(Comp const &c):comp(c) {}
+          bool operator()(Ty const &a, Ty const &b) const {
+            return !(comp(a, b) || comp(b, a));
+          }
+          Comp comp;
+        };
+        
+        Ty *inline_data() {
+          return static_cast<Ty *>(static_cast<void *>(&m_inline));
+        }
+        void assign(flat_set const &other) {
+          if( other.m_size>m_capacity )
+            grow(other.m_size);
+          std::uninitialized_copy(other.begin(), other.end(), m_data);
+          m_size = other.m_size;
+        }
+        void truncate(size_t n) {
+          for(size_t i=n; i<m_size; ++i)
+            m_data[i].~Ty();
+          if( n<m_size )
+            m_size = n;
+        }
+        void grow(size_t n) {
+          Ty *buf = static_cast<Ty *>(::operator new(n*sizeof(Ty)));
+          try {
+            std::uninitialized_copy(begin(), end(), buf);
+          } catch(...) {
+            ::operator delete(buf);
+            throw;
+          }
+          size_t count = m_size;
+          clear();
+          release();
+          m_data = buf;
+          m_size = count;
+          m_capacity = n;
+        }
+        void release() {
+          if( inline_data()!=m_data ) {
+            ::operator delete(m_data);
+            m_data = inline_data();
+            m_capacity = N;
+          }
+        }
+        
+        Comp   m_comp;
+        Ty    *m_data;
+        size_t m_size, m_capacity;
+        typename boost::aligned_storage<sizeof(Ty)*N,
+          boost::alignment_of<Ty>::value>::type m_inline;
+      }; // TREX::transaction::details::flat_set<>
+      
+    } // TREX::transaction::details
+  } // TREX::transaction
+} // TREX
+
+#endif // H_trex_domain_flat_set
@@ -0,0 +1,249 @@
+/* -*- C++ -*- */
+/** @file "interval_batch.hh"
+ * @brief Batch operations over interval domains
+ *
+ * This file defines a compact representation of a collection of
+ * intervals that allows to test them all at once.
+ *
+ * @ingroup domains
+ */
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ * 
+ *  Copyright (c) 2011, MBARI.
+ *  All rights reserved.
+ * 
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ * 
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the TREX Project nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ * 
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef H_trex_domain_interval_batch
+# define H_trex_domain_interval_batch
+
+# include "IntervalDomain.hh"
+
+# include <limits>
+# include <vector>
+
+namespace TREX {
+  namespace transaction {
+    namespace details {
+      
+      /** @brief Infinity encoding for interval batches
+       *
+       * @tparam Ty A numeric type
+       * @tparam Inf whether @p Ty has an infinity representation
+       *
+       * Gives the values used to represent -inf and +inf bounds in an
+       * interval_batch. For types with no infinity (such as integers) these
+       * are the smallest and largest finite values which does not change
+       * the result of intersection and inclusion tests on non empty 
+       * intervals.
+       *
+       * @relates interval_batch
+       */
+      template<typename Ty, 
+               bool Inf=std::numeric_limits<Ty>::has_infinity>
+      struct batch_inf {
+        static Ty lowest() {
+          return std::numeric_limits<Ty>::min();
+        }
+        static Ty highest() {
+          return std::numeric_limits<Ty>::max();
+        }
+      }; // TREX::transaction::details::batch_inf<>
+      
+      template<typename Ty>
+      struct batch_inf<Ty, true> {
+        static Ty lowest() {
+          return -std::numeric_limits<Ty>::infinity();
+        }
+        static Ty highest() {
+          return std::numeric_limits<Ty>::infinity();
+        }
+      }; // TREX::transaction::details::batch_inf<,true>
+      
+    } // TREX::transaction::details
+    
+    /** @brief Batch of intervals
+     *
+     * @tparam Ty The numeric type of the interval bounds
+     *
+     * A collection of intervals stored as two contiguous arrays of lower 
+     * and upper bounds. It allows to test many intervals against a single
+     * one -- such as a set of goals start windows against a dispatching 
+     * window -- through tight branch free loops with no virtual call and 
+     * that the compiler can vectorize.
+     *
+     * @pre @p Ty is a built-in numeric type using the default ordering
+     *
+     * @note details::external::dispatch does not use this class: its 
+     * goal queue is sorted on the goals start and dispatching stops at 
+     * the first goal that cannot start within the window, while 
+     * Goal::startsAfter may restrict the goal start as a side effect. 
+     * Gathering all the pending start domains into a batch would then 
+     * cost as many attribute lookups as the tests it replaces.
+     *
+     * @ingroup domains
+     */
+    template<typename Ty>
+    class interval_batch {
+    public:
+      typedef Ty                       value_type;
+      /** @brief Test results
+       *
+       * The type used to store the result of a batch test: the element
+       * @e i is non zero if the test succeeded on the @e i th interval
+       */
+      typedef std::vector<unsigned char> result_type;
+      
+      interval_batch() {}
+      ~interval_batch() {}
+      
+      size_t size() const {
+        return m_lo.size();
+      }
+      bool empty() const {
+        return m_lo.empty();
+      }
+      void reserve(size_t n) {
+        m_lo.reserve(n);
+        m_hi.reserve(n);
+      }
+      void clear() {
+        m_lo.clear();
+        m_hi.clear();
+      }
+      
+      /** @brief Add an interval
+       * @param[in] lo The lower bound
+       * @param[in] hi The upper bound
+       */
+      void push_back(Ty lo, Ty hi) {
+        m_lo.push_back(lo);
+        m_hi.push_back(hi);
+      }
+      /** @brief Add a domain
+       * @param[in] dom An interval domain
+       *
+       * Add the interval [dom.lowerBound(), dom.upperBound()] to this batch
+       */
+      template<bool Prot>
+      void push_back(IntervalDomain<Ty, Prot> const &dom) {
+        push_back(dom.hasLower()?dom.lowerBound().value():inf::lowest(),
+                  dom.hasUpper()?dom.upperBound().value():inf::highest());
+      }
+      
+      /** @brief Batch intersection test
+       *
+       * @param[in] dom An interval domain
+       * @param[out] out The result of the test for each interval
+       *
+       * Test which intervals of this batch do intersect @p dom
+       *
+       * @return the number of intervals that intersect @p dom
+       */
+      template<bool Prot>
+      size_t intersect(IntervalDomain<Ty, Prot> const &dom, 
+                       result_type &out) const {
+        return intersect(dom.hasLower()?dom.lowerBound().value():inf::lowest(),
+                         dom.hasUpper()?dom.upperBound().value():inf::highest(),
+                         out);
+      }
+      /** @brief Batch intersection test
+       *
+       * @param[in] lo A lower bound
+       * @param[in] hi An upper bound
+       * @param[out] out The result of the test for each interval
+       *
+       * Test which intervals of this batch do intersect [@p lo, @p hi]
+       *
+       * @return the number of intervals that intersect [@p lo, @p hi]
+       */
+      size_t intersect(Ty lo, Ty hi, result_type &out) const {
+        size_t const n = size();
+        size_t count = 0;
+        
+        out.resize(n);
+        if( n>0 ) {
+          Ty const *l = &m_lo[0], *h = &m_hi[0];
+          unsigned char *r = &out[0];
+          for(size_t i=0; i<n; ++i) {
+            r[i] = (l[i]<=hi) & (lo<=h[i]);
+            count += r[i];
+          }
+        }
+        return count;
+      }
+      /** @brief Batch inclusion test
+       *
+       * @param[in] val A value
+       * @param[out] out The result of the test for each interval
+       *
+       * Test which intervals of this batch do contain @p val
+       *
+       * @return the number of intervals that contain @p val
+       */
+      size_t contains(Ty val, result_type &out) const {
+        return intersect(val, val, out);
+      }
+      /** @brief Batch lower bound test
+       *
+       * @param[in] val A value
+       * @param[out] out The result of the test for each interval
+       *
+       * Test which intervals of this batch have their lower bound strictly
+       * before @p val. This corresponds to the goal test 
+       * Goal::startsBefore when the batch holds the goals start domains.
+       *
+       * @return the number of intervals with a lower bound less than @p val
+       */
+      size_t starts_before(Ty val, result_type &out) const {
+        size_t const n = size();
+        size_t count = 0;
+        
+        out.resize(n);
+        if( n>0 ) {
+          Ty const *l = &m_lo[0];
+          unsigned char *r = &out[0];
+          for(size_t i=0; i<n; ++i) {
+            r[i] = l[i]<val;
+            count += r[i];
+          }
+        }
+        return count;
+      }
+      
+    private:
+      typedef details::batch_inf<Ty> inf;
+      
+      std::vector<Ty> m_lo, m_hi;
+    }; // TREX::transaction::interval_batch<>
+    
+  } // TREX::transaction
+} // TREX
+
+#endif // H_trex_domain_interval_batch
@@ -43,6 +43,7 @@
 
 
 #include "exception_helper.hh"
+#include "python_thread.hh"
 
 using namespace boost::python;
 namespace ta=TREX::agent;
@@ -80,6 +81,19 @@ namespace {
     return MAKE_SHARED<ta::FastClock>(base, epoch,
                                       CHRONO::duration_cast<ta::Clock::duration_type>(my_secs), no_skip);
   }
+  
+  // The agent loop runs without the python lock : python reactors
+  // acquire it only when they call python
+  
+  void agent_run(ta::Agent &agent) {
+    TREX::python::scoped_gil_unlock unlock;
+    agent.run();
+  }
+  
+  bool agent_step(ta::Agent &agent) {
+    TREX::python::scoped_gil_unlock unlock;
+    return agent.doNext();
+  }
 }
 
 void export_agent() {
@@ -206,7 +220,7 @@ void export_agent() {
        " add new components to the agent.\n"
        "Raises:\n"
        "  agent_exception: something went wrong during initialization.")
-  .def("run", &ta::Agent::run, arg("self"),
+  .def("run", &agent_run, arg("self"),
        "run the agent until completion.\n\n"
        "Note: run calls initialize on its own so you do not need to\n\n"
        "Raise:\n"
@@ -214,7 +228,7 @@ void export_agent() {
        "   trex.util.exception: something went wrong during the run\n"
        "   ...: any exception that could be trown by a reactor."
        )
-  .def("step", &ta::Agent::doNext, arg("self"),
+  .def("step", &agent_step, arg("self"),
        "run one tick for the agent.\n\n"
        "Note: this method is for simulation purpose and not recommended\n"
        "      to be used. Often it is better to call self.run() instead.\n\n"
@@ -42,11 +42,13 @@
 #include <boost/python/stl_iterator.hpp>
 
 #include "exception_helper.hh"
+#include "numeric_column.hh"
 
 using namespace boost::python;
 
 namespace tu=TREX::utils;
 namespace tt=TREX::transaction;
+namespace tp=TREX::python;
 
 namespace {
   
@@ -248,6 +250,71 @@ namespace {
   tt::Variable var_from_xml(boost::property_tree::ptree::value_type &xml) {
     return tt::Variable(xml);
   }
+  
+  double domain_numeric(tt::DomainBase const &dom, std::string const &what) {
+    return tp::numeric_column::value(dom, tp::numeric_column::kind(what));
+  }
+  
+  double column_get(tp::numeric_column const &col, long idx) {
+    if( idx<0 )
+      idx += col.size();
+    if( idx<0 || static_cast<size_t>(idx)>=col.size() ) {
+      // python iteration relies on IndexError to detect the end
+      PyErr_SetString(PyExc_IndexError, "column index out of range");
+      throw_error_already_set();
+    }
+    return col.data()[idx];
+  }
+  
+  /*
+   * Python buffer protocol for trex.domains.column : gives a read only
+   * access to the column values as a flat array of doubles. The shape 
+   * and strides are allocated with the buffer and freed on release.
+   */
+  int column_get_buffer(PyObject *self, Py_buffer *view, int flags) {
+    static double dummy = 0.0;
+    
+    if( flags & PyBUF_WRITABLE ) {
+      PyErr_SetString(PyExc_BufferError, "trex column is read only");
+      view->obj = NULL;
+      return -1;
+    }
+    tp::numeric_column const &col = extract<tp::numeric_column const &>(self);
+    Py_ssize_t *dims = new Py_ssize_t[2];
+    
+    dims[0] = col.size();
+    dims[1] = sizeof(double);
+    
+    view->buf = col.empty()?&dummy:const_cast<double *>(col.data());
+    view->obj = self;
+    Py_INCREF(self);
+    view->len = dims[0]*dims[1];
+    view->readonly = 1;
+    view->itemsize = dims[1];
+    view->format = (flags & PyBUF_FORMAT)?const_cast<char *>("d"):NULL;
+    view->ndim = 1;
+    view->shape = ((flags & PyBUF_ND)==PyBUF_ND)?dims:NULL;
+    view->strides = ((flags & PyBUF_STRIDES)==PyBUF_STRIDES)?dims+1:NULL;
+    view->suboffsets = NULL;
+    view->internal = dims;
+    return 0;
+  }
+  
+  void column_release_buffer(PyObject *, Py_buffer *view) {
+    delete[] static_cast<Py_ssize_t *>(view->internal);
+  }
+  
+  void enable_buffer(object const &cls) {
+    static PyBufferProcs procs;
+    PyTypeObject *type = reinterpret_cast<PyTypeObject *>(cls.ptr());
+    
+    procs.bf_getbuffer = &column_get_buffer;
+    procs.bf_releasebuffer = &column_release_buffer;
+    type->tp_as_buffer = &procs;
+# if PY_MAJOR_VERSION<3
+    type->tp_flags |= Py_TPFLAGS_HAVE_NEWBUFFER;
+# endif
+  }
 }
 
 void export_domain() {
@@ -328,6 +395,12 @@ void export_domain() {
        "serialize self into an json formatted string")
   .def("__str__", pure_virtual(&str_impl<tt::DomainBase>), arg("self"),
        "serialize self into a human-readable string")
+  .def("numeric", &domain_numeric, (arg("self"), arg("bound")="value"),
+       "Numeric value of this domain as a float.\n"
+       "bound is either \"value\" for the singleton value, \"lower\"\n"
+       "or \"upper\" for the domain bounds. The result is nan if the\n"
+       "domain is not an int, float or bool or, for \"value\", if it\n"
+       "is not a singleton. Infinite bounds are given as +/-inf.")
   ;
   
   class_<tt::DomainExcept, bases<tu::Exception> > dom_e
@@ -521,6 +594,26 @@ void export_domain() {
   
   s_py_err->attach<tt::VariableException>(var_e.ptr());
   
+  // class trex.domains.column
+  //   A read only array of floats
+  //    - __len__()     number of elements
+  //    - __getitem__() access to one element
+  //   it also supports the buffer protocol
+  class_<tp::numeric_column> col
+  ("column",
+   "Read only array of numeric values.\n"
+   "A column holds one numeric attribute extracted from a set of\n"
+   "predicates (see trex.transaction.column). It supports the\n"
+   "buffer protocol with a \"d\" format: numpy.asarray(col) or\n"
+   "memoryview(col) access its values without any copy.",
+   no_init);
+  col.def("__len__", &tp::numeric_column::size, arg("self"),
+          "Number of values in this column")
+  .def("__getitem__", &column_get, args("self", "index"),
+       "Access the value at index")
+  ;
+  enable_buffer(col);
+  
 }
 
 
@@ -0,0 +1,122 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2015, Frederic Py.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the TREX Project nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "numeric_column.hh"
+
+#include <trex/domain/BooleanDomain.hh>
+#include <trex/domain/IntegerDomain.hh>
+#include <trex/domain/FloatDomain.hh>
+
+#include <limits>
+#include <sstream>
+
+using namespace TREX::python;
+using namespace TREX::transaction;
+
+namespace {
+  
+  double const s_nan = std::numeric_limits<double>::quiet_NaN();
+  double const s_inf = std::numeric_limits<double>::infinity();
+
+  template<class Dom>
+  double interval_value(Dom const &dom, numeric_column::bound_kind what) {
+    switch( what ) {
+      case numeric_column::lower_bound:
+        return dom.hasLower()?static_cast<double>(dom.lowerBound().value()):-s_inf;
+      case numeric_column::upper_bound:
+        return dom.hasUpper()?static_cast<double>(dom.upperBound().value()):s_inf;
+      default:
+        return dom.isSingleton()?static_cast<double>(dom.lowerBound().value()):s_nan;
+    }
+  }
+  
+}
+
+/*
+ * class TREX::python::numeric_column
+ */
+
+// statics
+
+numeric_column::bound_kind numeric_column::kind(std::string const &name) {
+  if( "value"==name )
+    return singleton_value;
+  else if( "lower"==name )
+    return lower_bound;
+  else if( "upper"==name )
+    return upper_bound;
+  throw utils::Exception("Invalid bound \""+name+
+                         "\": expected value, lower or upper");
+}
+
+double numeric_column::value(DomainBase const &dom, bound_kind what) {
+  FloatDomain const *f = dynamic_cast<FloatDomain const *>(&dom);
+  if( NULL!=f )
+    return interval_value(*f, what);
+  
+  IntegerDomain const *i = dynamic_cast<IntegerDomain const *>(&dom);
+  if( NULL!=i )
+    return interval_value(*i, what);
+  
+  BooleanDomain const *b = dynamic_cast<BooleanDomain const *>(&dom);
+  if( NULL!=b ) {
+    // a full boolean is the interval [false, true]
+    if( singleton_value==what && !b->isSingleton() )
+      return s_nan;
+    return (upper_bound==what)?b->getTypedUpper<bool, true>():
+                               b->getTypedLower<bool, true>();
+  }
+  return s_nan;
+}
+
+// observers
+
+double numeric_column::at(size_t i) const {
+  if( i>=size() ) {
+    std::ostringstream oss;
+    oss<<"Index "<<i<<" is out of bounds";
+    throw utils::Exception(oss.str());
+  }
+  return m_values[i];
+}
+
+// modifiers
+
+void numeric_column::push_back(Predicate const &pred, 
+                               utils::Symbol const &attr,
+                               bound_kind what) {
+  if( pred.hasAttribute(attr) )
+    push_back(value(pred.getAttribute(attr).domain(), what));
+  else
+    push_back(s_nan);
+}
@@ -0,0 +1,161 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2015, Frederic Py.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the TREX Project nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef H_trex_python_numeric_column
+# define H_trex_python_numeric_column
+
+# include <trex/transaction/Predicate.hh>
+
+# include <vector>
+
+namespace TREX {
+  namespace python {
+    
+    /** @brief Numeric attribute column
+     *
+     * A flat array of doubles that extracts one numeric attribute from a
+     * collection of predicates -- typically the observations received 
+     * during a tick. It is exported to python as a read only buffer so 
+     * numpy can wrap it (@c numpy.asarray) without copying its content 
+     * nor converting each attribute into a python object.
+     *
+     * An entry is NaN when the predicate does not have the attribute, 
+     * when the attribute is not numeric (int, float or bool) or when a 
+     * singleton value is requested from a domain that is not a singleton.
+     * Infinite bounds are given as +/-inf.
+     */
+    class numeric_column {
+    public:
+      typedef double value_type;
+      
+      /** @brief Extracted value
+       *
+       * Identifies what value of a numeric domain is stored in a column
+       */
+      enum bound_kind {
+        /** The value of a singleton domain */
+        singleton_value,
+        /** The lower bound of the domain */
+        lower_bound,
+        /** The upper bound of the domain */
+        upper_bound
+      };
+      
+      numeric_column() {}
+      ~numeric_column() {}
+      
+      /** @brief Parse a bound kind
+       * @param[in] name "value", "lower" or "upper"
+       *
+       * @throw TREX::utils::Exception @p name is not a valid bound kind
+       */
+      static bound_kind kind(std::string const &name);
+      /** @brief Numeric value of a domain
+       *
+       * @param[in] dom A domain
+       * @param[in] what The value to extract
+       *
+       * @return the value @p what of @p dom or NaN if @p dom is not numeric
+       */
+      static double value(transaction::DomainBase const &dom, 
+                          bound_kind what);
+      
+      size_t size() const {
+        return m_values.size();
+      }
+      bool empty() const {
+        return m_values.empty();
+      }
+      void reserve(size_t n) {
+        m_values.reserve(n);
+      }
+      
+      /** @brief Element access
+       * @param[in] i An index
+       * @throw TREX::utils::Exception @p i is out of bounds
+       * @return The @p i th value of the column
+       */
+      double at(size_t i) const;
+      /** @brief Raw data
+       *
+       * @return A pointer to the contiguous values of this column. This 
+       * pointer remains valid as long as this column is not modified
+       */
+      double const *data() const {
+        return m_values.empty()?NULL:&m_values[0];
+      }
+      
+      /** @brief Append a value
+       * @param[in] val A value
+       */
+      void push_back(double val) {
+        m_values.push_back(val);
+      }
+      /** @brief Append a predicate attribute
+       * @param[in] pred A predicate
+       * @param[in] attr An attribute name
+       * @param[in] what The value to extract
+       *
+       * Append the value @p what of the attribute @p attr of @p pred
+       */
+      void push_back(transaction::Predicate const &pred,
+                     utils::Symbol const &attr,
+                     bound_kind what);
+      
+      /** @brief Extract an attribute from a collection
+       *
+       * @tparam Iter A forward iterator to predicate pointers
+       * @param[in] from The beginning of the collection
+       * @param[in] to The end of the collection
+       * @param[in] attr An attribute name
+       * @param[in] what The value to extract
+       *
+       * Append the value @p what of the attribute @p attr of all the 
+       * predicates in [@p from, @p to)
+       */
+      template<class Iter>
+      void extract(Iter from, Iter to, utils::Symbol const &attr,
+                   bound_kind what) {
+        reserve(size()+std::distance(from, to));
+        for( ; to!=from; ++from)
+          push_back(**from, attr, what);
+      }
+      
+    private:
+      std::vector<double> m_values;
+    }; // TREX::python::numeric_column
+    
+  } // TREX::python
+} // TREX
+
+#endif // H_trex_python_numeric_column
@@ -45,7 +45,8 @@ namespace tlog=TREX::utils::log;
  */
 
 python_env::python_env()
-:m_strand(m_log->service(), false) {
+:m_thread(NULL), m_strand(m_log->service(), false) {
+  bool owner = false;
 
 #if PY_MAJOR_VERSION >= 3
   typedef wchar_t py_char;
@@ -60,12 +61,18 @@ python_env::python_env()
   if( !Py_IsInitialized() ) {
     m_log->syslog("python", tlog::info)<<"Initializing python";
     Py_Initialize();
+    PyEval_InitThreads();
     // Needed for some python libs inclufing rospy
     PySys_SetArgv(1, argv);
-    
+    owner = true;
   }
   m_log->syslog("python", tlog::info)<<"Getting __main__ module";
   m_main = bp::import("__main__");
+  if( owner ) {
+    // Release the lock so the reactors can acquire it from any thread
+    m_owner = boost::this_thread::get_id();
+    m_thread = PyEval_SaveThread();
+  }
   
   
   m_log->syslog("python", tlog::info)<<"Starting queue";
@@ -73,6 +80,17 @@ python_env::python_env()
 }
 
 python_env::~python_env() {
+  if( NULL!=m_thread && boost::this_thread::get_id()==m_owner )
+    // Back to the state python had before we released the lock
+    PyEval_RestoreThread(m_thread);
+  else {
+    // The singleton can be released by any thread : take the lock
+    // just long enough to release our python objects
+    PyGILState_STATE state = PyGILState_Ensure();
+    m_loaded.clear();
+    m_main = bp::object();
+    PyGILState_Release(state);
+  }
 }
 
 bp::object &python_env::import(std::string const &module) {
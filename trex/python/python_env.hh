@@ -37,6 +37,7 @@
 # include <trex/utils/LogManager.hh>
 # include <trex/utils/priority_strand.hh>
 # include <boost/python.hpp>
+# include <boost/thread/thread.hpp>
 # include <map>
 
 namespace TREX {
@@ -66,6 +67,19 @@ namespace TREX {
       typedef std::map<std::string, boost::python::object> object_map;
       object_map m_loaded;
       boost::python::object m_main;
+      /** @brief Main thread state
+       *
+       * When python was initialized by this class, the lock is 
+       * released right after and this is the state of the thread that 
+       * initialized it. It is null otherwise.
+       */
+      PyThreadState        *m_thread;
+      /** @brief Thread that initialized python
+       *
+       * The thread state m_thread can only be restored from this 
+       * thread.
+       */
+      boost::thread::id     m_owner;
       
       
       python_env();
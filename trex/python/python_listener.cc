@@ -33,6 +33,7 @@
  */
 #include <trex/transaction/TeleoReactor.hh>
 #include "python_listener.hh"
+#include "python_thread.hh"
 
 using namespace TREX::python;
 using TREX::transaction::graph;
@@ -85,6 +86,7 @@ void py_tl_listener::py_unused(Symbol const &name) {
 // internal handlers
 
 void py_tl_listener::declared(timeline const &tl) {
+  scoped_gil_release lock;
   try {
     py_declared(tl.name());
   } catch(...) {
@@ -93,6 +95,7 @@ void py_tl_listener::declared(timeline const &tl) {
 }
 
 void py_tl_listener::undeclared(timeline const &tl) {
+  scoped_gil_release lock;
   try {
     py_undeclared(tl.name());
   } catch(...) {
@@ -101,6 +104,7 @@ void py_tl_listener::undeclared(timeline const &tl) {
 }
 
 void py_tl_listener::connected(Relation const &r) {
+  scoped_gil_release lock;
   try {
     py_used(r.name());
   } catch(...) {
@@ -109,6 +113,7 @@ void py_tl_listener::connected(Relation const &r) {
 }
 
 void py_tl_listener::disconnected(Relation const &r) {
+  scoped_gil_release lock;
   try {
     py_unused(r.name());
   } catch(...) {
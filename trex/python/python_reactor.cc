@@ -45,6 +45,27 @@ namespace  {
   TeleoReactor::xml_factory::declare<py_reactor> decl("PyReactor");
 }
 
+/*
+ * struct TREX::python::tick_batch
+ */
+
+void tick_batch::clear() {
+  observations.clear();
+  requests.clear();
+  recalls.clear();
+  new_plans.clear();
+  cancelled_plans.clear();
+}
+
+void tick_batch::swap(tick_batch &other) {
+  std::swap(tick, other.tick);
+  observations.swap(other.observations);
+  requests.swap(other.requests);
+  recalls.swap(other.recalls);
+  new_plans.swap(other.new_plans);
+  cancelled_plans.swap(other.cancelled_plans);
+}
+
 /*
  * class TREX::python::reactor_proxy
  */
@@ -212,6 +233,25 @@ bool reactor_proxy::has_work() {
   return false;
 }
 
+void reactor_proxy::handle_batch(tick_batch const &b) {
+  handle_new_tick();
+  for(std::vector<observation_id>::const_iterator i=b.observations.begin();
+      b.observations.end()!=i; ++i)
+    notify(**i);
+  for(std::vector<goal_id>::const_iterator i=b.requests.begin();
+      b.requests.end()!=i; ++i)
+    handle_request(*i);
+  for(std::vector<goal_id>::const_iterator i=b.recalls.begin();
+      b.recalls.end()!=i; ++i)
+    handle_recall(*i);
+  for(std::vector<goal_id>::const_iterator i=b.new_plans.begin();
+      b.new_plans.end()!=i; ++i)
+    new_plan(*i);
+  for(std::vector<goal_id>::const_iterator i=b.cancelled_plans.begin();
+      b.cancelled_plans.end()!=i; ++i)
+    cancelled_plan(*i);
+}
+
 
 /*
  * class TREX::python::reactor_wrap
@@ -227,6 +267,13 @@ reactor_wrap::reactor_wrap(py_wrapper const &r)
 reactor_wrap::~reactor_wrap() {
 }
 
+// observers
+
+bool reactor_wrap::overrides(char const *name) const {
+  bp::override f = this->get_override(name);
+  return f?true:false;
+}
+
 // callbacks
 
 void reactor_wrap::terminate() {
@@ -355,6 +402,18 @@ void reactor_wrap::cancelled_plan_default(goal_id const &g) {
   this->reactor_proxy::cancelled_plan(g);
 }
 
+void reactor_wrap::handle_batch(tick_batch const &b) {
+  bp::override f = this->get_override("handle_batch");
+  if( f )
+    f(boost::ref(b));
+  else
+    handle_batch_default(b);
+}
+
+void reactor_wrap::handle_batch_default(tick_batch const &b) {
+  this->reactor_proxy::handle_batch(b);
+}
+
 
 
 /*
@@ -364,7 +423,9 @@ void reactor_wrap::cancelled_plan_default(goal_id const &g) {
 // structors
 
 py_reactor::py_reactor(xml_arg_type arg)
-:TeleoReactor(arg, false, true) {
+:TeleoReactor(arg, false, true),
+ m_batch(parse_attr<bool>(false, xml_factory::node(arg), "batch")),
+ m_deliberative(true) {
   try {
     boost::property_tree::ptree::value_type &node = xml_factory::node(arg);
     std::string class_name = parse_attr<std::string>(node, "python_class");
@@ -422,16 +483,28 @@ py_reactor::py_reactor(xml_arg_type arg)
       throw ReactorException(*this, "Python class "+class_name+
                              " is not a reactor");
     }
+    // No need to acquire the lock on has_work if python does not define it
+    m_deliberative = extractor().overrides("has_work");
+    if( m_batch )
+      syslog()<<"Python callbacks are delivered once per tick";
   } catch(bp::error_already_set const &e) {
     m_exc->unwrap_py_error();
   }
 }
 
 py_reactor::~py_reactor() {
+  scoped_gil_release lock;
   if( !m_obj.is_none() ) {
     syslog()<<"Destroying obj";
-    self().terminate();
+    try {
+      self().terminate();
+    } catch(bp::error_already_set const &e) {
+      PyErr_Print();
+    }
   }
+  // release python objects while holding the lock
+  m_obj = bp::object();
+  m_scope = bp::object();
 }
 
 
@@ -446,6 +519,7 @@ reactor_proxy &py_reactor::self() {
 
 void py_reactor::handleInit() {
   syslog()<<" init";
+  scoped_gil_release lock;
   try {
     self().handle_init();
   } catch(bp::error_already_set const &e) {
@@ -455,6 +529,12 @@ void py_reactor::handleInit() {
 }
 
 void py_reactor::handleRequest(goal_id const &g) {
+  if( m_batch ) {
+    boost::mutex::scoped_lock batch(m_mtx);
+    m_pending.requests.push_back(g);
+    return;
+  }
+  scoped_gil_release lock;
   try {
     self().handle_request(g);
   } catch(bp::error_already_set const &e) {
@@ -464,6 +544,12 @@ void py_reactor::handleRequest(goal_id const &g) {
 }
 
 void py_reactor::handleRecall(goal_id const &g) {
+  if( m_batch ) {
+    boost::mutex::scoped_lock batch(m_mtx);
+    m_pending.recalls.push_back(g);
+    return;
+  }
+  scoped_gil_release lock;
   try {
     self().handle_recall(g);
   } catch(bp::error_already_set const &e) {
@@ -473,6 +559,12 @@ void py_reactor::handleRecall(goal_id const &g) {
 }
 
 void py_reactor::handleTickStart() {
+  if( m_batch ) {
+    boost::mutex::scoped_lock batch(m_mtx);
+    m_pending.tick = getCurrentTick();
+    return;
+  }
+  scoped_gil_release lock;
   try {
     self().handle_new_tick();
   } catch(bp::error_already_set const &e) {
@@ -482,9 +574,16 @@ void py_reactor::handleTickStart() {
 }
 
 
-void py_reactor::notify(Observation const &o) {
+void py_reactor::handleObservation(observation_id const &o) {
+  if( m_batch ) {
+    // observations are immutable : just keep a reference
+    boost::mutex::scoped_lock batch(m_mtx);
+    m_pending.observations.push_back(o);
+    return;
+  }
+  scoped_gil_release lock;
   try {
-    self().notify(o);
+    self().notify(*o);
   } catch(bp::error_already_set const &e) {
     m_exc->unwrap_py_error();
 //    unpack_error("notify", e, false);
@@ -493,7 +592,18 @@ void py_reactor::notify(Observation const &o) {
 
 
 bool py_reactor::synchronize() {
+  tick_batch cur;
+  
+  if( m_batch ) {
+    boost::mutex::scoped_lock batch(m_mtx);
+    cur.swap(m_pending);
+    m_pending.tick = cur.tick;
+  }
+  // Only one lock acquisition for the whole tick in batch mode
+  scoped_gil_release lock;
   try {
+    if( m_batch )
+      self().handle_batch(cur);
     return self().synchronize();
   } catch(bp::error_already_set const &e) {
     m_exc->unwrap_py_error();
@@ -503,6 +613,9 @@ bool py_reactor::synchronize() {
 }
 
 bool py_reactor::hasWork() {
+  if( !m_deliberative )
+    return false;
+  scoped_gil_release lock;
   try {
     return self().has_work();
   } catch(bp::error_already_set const &e) {
@@ -513,6 +626,7 @@ bool py_reactor::hasWork() {
 }
 
 void py_reactor::resume() {
+  scoped_gil_release lock;
   try {
     self().resume();
   } catch(bp::error_already_set const &e) {
@@ -522,6 +636,12 @@ void py_reactor::resume() {
 }
 
 void py_reactor::newPlanToken(goal_id const &g) {
+  if( m_batch ) {
+    boost::mutex::scoped_lock batch(m_mtx);
+    m_pending.new_plans.push_back(g);
+    return;
+  }
+  scoped_gil_release lock;
   try {
     self().new_plan(g);
   } catch(bp::error_already_set const &e) {
@@ -531,6 +651,12 @@ void py_reactor::newPlanToken(goal_id const &g) {
 }
 
 void py_reactor::cancelledPlanToken(goal_id const &g) {
+  if( m_batch ) {
+    boost::mutex::scoped_lock batch(m_mtx);
+    m_pending.cancelled_plans.push_back(g);
+    return;
+  }
+  scoped_gil_release lock;
   try {
     self().cancelled_plan(g);
   } catch(bp::error_already_set const &e) {
@@ -538,4 +664,3 @@ void py_reactor::cancelledPlanToken(goal_id const &g) {
 //    unpack_error("cancelled_plan", e, false);
   }
 }
-
@@ -39,11 +39,44 @@
 # include "python_env.hh"
 
 # include <boost/python.hpp>
+# include <boost/thread/mutex.hpp>
 
 namespace TREX {
   namespace python {
     class py_reactor;
     
+    /** @brief Events of a tick
+     *
+     * The events received by a python reactor between two 
+     * synchronizations. A reactor created with the @c batch attribute 
+     * set receives them all at once through reactor_proxy::handle_batch 
+     * right before its synchronization, which allows to deliver a whole 
+     * tick with a single acquisition of the python interpreter lock.
+     */
+    struct tick_batch {
+      tick_batch():tick(0) {}
+      
+      bool empty() const {
+        return observations.empty() && requests.empty() && recalls.empty()
+          && new_plans.empty() && cancelled_plans.empty();
+      }
+      void clear();
+      void swap(tick_batch &other);
+      
+      /** @brief Tick of the batch */
+      transaction::TICK                         tick;
+      /** @brief Observations received during the tick */
+      std::vector<transaction::observation_id>  observations;
+      /** @brief Goals requested during the tick */
+      std::vector<transaction::goal_id>         requests;
+      /** @brief Goals recalled during the tick */
+      std::vector<transaction::goal_id>         recalls;
+      /** @brief Plan tokens added during the tick */
+      std::vector<transaction::goal_id>         new_plans;
+      /** @brief Plan tokens cancelled during the tick */
+      std::vector<transaction::goal_id>         cancelled_plans;
+    };
+    
     struct py_wrapper {
       py_wrapper(py_reactor *r, boost::property_tree::ptree::value_type &node):me(r), xml_ref(node) {
       }
@@ -112,6 +145,15 @@ namespace TREX {
       virtual void resume() {}
       virtual void new_plan(transaction::goal_id const &g) {}
       virtual void cancelled_plan(transaction::goal_id const &g) {}
+      /** @brief Batch delivery
+       *
+       * @param[in] b The events of the current tick
+       *
+       * The default implementation calls handle_new_tick followed by 
+       * the callback of each event of @p b in this order: notify, 
+       * handle_request, handle_recall, new_plan and cancelled_plan
+       */
+      virtual void handle_batch(tick_batch const &b);
       
       virtual void terminate() {}
       
@@ -149,6 +191,14 @@ namespace TREX {
       void new_plan_default(transaction::goal_id const &g);
       void cancelled_plan(transaction::goal_id const &g);
       void cancelled_plan_default(transaction::goal_id const &g);
+      void handle_batch(tick_batch const &b);
+      void handle_batch_default(tick_batch const &b);
+      
+      /** @brief Check for python override
+       * @param[in] name A method name
+       * @retval true if the python class overrides @p name
+       */
+      bool overrides(char const *name) const;
       
       void terminate();
       
@@ -166,7 +216,7 @@ namespace TREX {
       void handleRequest(transaction::goal_id const &g);
       void handleRecall(transaction::goal_id const &g);
       void handleTickStart();
-      void notify(transaction::Observation const &o);
+      void handleObservation(transaction::observation_id const &o);
       bool synchronize();
       bool hasWork();
       void resume();
@@ -177,6 +227,21 @@ namespace TREX {
       utils::SingletonUse<exception_table> m_exc;
       utils::SingletonUse<python_env> m_python;
       
+      /** @brief Batch mode flag
+       *
+       * When set, the events are accumulated in m_pending and given 
+       * to python in one call on synchronize (@c batch attribute)
+       */
+      bool const   m_batch;
+      /** @brief Python has_work override flag
+       *
+       * Indicates if the python class defines has_work. If not the 
+       * reactor has no work and python is not called.
+       */
+      bool         m_deliberative;
+      boost::mutex m_mtx;
+      tick_batch   m_pending;
+      
       friend class reactor_proxy;
     };
     
@@ -48,5 +48,17 @@ scoped_gil_release::~scoped_gil_release() {
   PyGILState_Release(m_state);
 }
 
+/*
+ * class TREX::python::scoped_gil_unlock
+ */
+
+scoped_gil_unlock::scoped_gil_unlock() {
+  m_state = PyEval_SaveThread();
+}
+
+scoped_gil_unlock::~scoped_gil_unlock() {
+  PyEval_RestoreThread(m_state);
+}
+
 
 
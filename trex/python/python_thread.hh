@@ -50,6 +50,26 @@ namespace TREX {
       utils::SingletonUse<python_env> m_python;
     };
     
+    /** @brief Python lock free section
+     *
+     * Releases the python global interpreter lock held by the current 
+     * thread for the lifetime of this instance. It allows long C++ 
+     * calls made from python, such as running the agent, to let other 
+     * threads -- including python reactors executed by other threads 
+     * -- acquire the lock through scoped_gil_release.
+     *
+     * @pre the current thread holds the lock
+     * @sa scoped_gil_release
+     */
+    class scoped_gil_unlock:boost::noncopyable {
+    public:
+      scoped_gil_unlock();
+      ~scoped_gil_unlock();
+      
+    private:
+      PyThreadState *m_state;
+    };
+    
   } // TREX::python
 } // TREX
 
@@ -33,6 +33,11 @@
  */
 #include "python_reactor.hh"
 #include "python_listener.hh"
+#include "numeric_column.hh"
+
+#include <boost/python/stl_iterator.hpp>
+
+#include <limits>
 
 namespace bp=boost::python;
 
@@ -78,9 +83,111 @@ namespace {
     return reinterpret_cast<unsigned long long>(g.get());
   }
   
-  observation_id obs_from_xml(boost::property_tree::ptree::value_type &node) {
-    return observation_id(new Observation(node));
+  template<class Ty>
+  bp::list py_list(std::vector<Ty> const &v) {
+    bp::list ret;
+    for(typename std::vector<Ty>::const_iterator i=v.begin(); v.end()!=i; ++i)
+      ret.append(*i);
+    return ret;
+  }
+  
+  bp::list batch_obs(tick_batch const &b) {
+    return py_list(b.observations);
+  }
+  bp::list batch_requests(tick_batch const &b) {
+    return py_list(b.requests);
   }
+  bp::list batch_recalls(tick_batch const &b) {
+    return py_list(b.recalls);
+  }
+  bp::list batch_plans(tick_batch const &b) {
+    return py_list(b.new_plans);
+  }
+  bp::list batch_cancelled(tick_batch const &b) {
+    return py_list(b.cancelled_plans);
+  }
+  
+  numeric_column batch_column(tick_batch const &b, Symbol const &attr,
+                              std::string const &what) {
+    numeric_column ret;
+    ret.extract(b.observations.begin(), b.observations.end(), attr,
+                numeric_column::kind(what));
+    return ret;
+  }
+  
+  numeric_column preds_column(bp::object preds, Symbol const &attr,
+                              std::string const &what) {
+    bp::stl_input_iterator< boost::shared_ptr<Predicate> > i(preds), end;
+    numeric_column::bound_kind kind = numeric_column::kind(what);
+    numeric_column ret;
+    
+    for( ; end!=i; ++i)
+      ret.push_back(**i, attr, kind);
+    return ret;
+  }
+  
+  /*
+   * Dictionary like read only view of a predicate attributes. It only
+   * refers to the predicate : the attributes are wrapped into python
+   * objects on access.
+   */
+  class attribute_view {
+  public:
+    explicit attribute_view(boost::shared_ptr<Predicate> const &pred)
+    :m_pred(pred) {}
+    
+    size_t size() const {
+      return std::distance(m_pred->begin(), m_pred->end());
+    }
+    bool contains(Symbol const &name) const {
+      return m_pred->hasAttribute(name);
+    }
+    DomainBase const &get(Symbol const &name) const {
+      if( !m_pred->hasAttribute(name) ) {
+        PyErr_SetString(PyExc_KeyError, name.str().c_str());
+        bp::throw_error_already_set();
+      }
+      return m_pred->getAttribute(name).domain();
+    }
+    double numeric(Symbol const &name, std::string const &what) const {
+      numeric_column::bound_kind kind = numeric_column::kind(what);
+      if( m_pred->hasAttribute(name) )
+        return numeric_column::value(m_pred->getAttribute(name).domain(), 
+                                     kind);
+      return std::numeric_limits<double>::quiet_NaN();
+    }
+    bp::list keys() const {
+      bp::list ret;
+      for(Predicate::const_iterator i=m_pred->begin(); m_pred->end()!=i; ++i)
+        ret.append(i->first);
+      return ret;
+    }
+    bp::object iter() const {
+      return keys().attr("__iter__")();
+    }
+    
+  private:
+    boost::shared_ptr<Predicate> m_pred;
+  };
+  
+  attribute_view pred_attrs(boost::shared_ptr<Predicate> const &pred) {
+    return attribute_view(pred);
+  }
+  
+  SHARED_PTR<Observation> obs_from_xml(boost::property_tree::ptree::value_type &node) {
+    return MAKE_SHARED<Observation>(node);
+  }
+  
+  /*
+   * observation_id refers to a const Observation that is shared by all
+   * the clients of its timeline. Python has no notion of const so it is 
+   * exposed as a regular obs which should be treated as read only
+   */
+  struct obs_id_to_python {
+    static PyObject *convert(observation_id const &o) {
+      return bp::incref(bp::object(SHARED_NS::const_pointer_cast<Observation>(o)).ptr());
+    }
+  };
   goal_id goal_from_xml(boost::property_tree::ptree::value_type &node) {
     return goal_id(new Goal(node));
   }
@@ -172,8 +279,55 @@ void export_transactions() {
   .def("from_xml", &pred_factory, bp::arg("xml"),
        "Create a new instance from an xml definition")
   .staticmethod("from_xml")
+  .add_property("attributes", &pred_attrs,
+                "A read only dictionary like view of the predicate\n"
+                "attributes. Each attribute domain is only converted\n"
+                "into a python object when accessed")
+  ;
+  
+  /*
+   * class attributes:
+   *   read only view of a predicate attributes
+   *  methods
+   *    - __len__(self)
+   *    - __contains__(self, name)
+   *    - __getitem__(self, name) -> domain
+   *    - __iter__(self)
+   *    - keys(self)
+   *    - numeric(self, name, bound) -> float
+   */
+  bp::class_<attribute_view>
+  ("attributes", "Read only view of a predicate attributes.\n"
+   "It gives access to the attribute domains by name without\n"
+   "copying the predicate.", bp::no_init)
+  .def("__len__", &attribute_view::size, bp::arg("self"),
+       "Number of attributes of the predicate")
+  .def("__contains__", &attribute_view::contains, bp::args("self", "name"),
+       "Check if the predicate has the attribute name")
+  .def("__getitem__", &attribute_view::get, bp::return_internal_reference<>(),
+       bp::args("self", "name"),
+       "The domain of the attribute name.\n\n"
+       "Raises:\n"
+       "  KeyError: the predicate has no attribute name")
+  .def("__iter__", &attribute_view::iter, bp::arg("self"),
+       "Iterate through the attribute names")
+  .def("keys", &attribute_view::keys, bp::arg("self"),
+       "List of the attribute names")
+  .def("numeric", &attribute_view::numeric,
+       (bp::arg("self"), bp::arg("name"), bp::arg("bound")="value"),
+       "Numeric value of the attribute name as a float.\n"
+       "It is equivalent to self[name].numeric(bound) but does not create\n"
+       "the domain python object. The result is nan if the predicate\n"
+       "does not have this attribute.")
   ;
   
+  bp::def("column", &preds_column,
+          (bp::arg("preds"), bp::arg("name"), bp::arg("bound")="value"),
+          "Extract the numeric attribute name of the predicates preds.\n"
+          "The result is a trex.domains.column that numpy can wrap with\n"
+          "no copy. Its values are the same as pred.attributes.numeric(name,\n"
+          "bound) for each pred in preds.");
+  
   bp::class_<PredicateException, bp::bases<Exception> > pred_e
   ("predicate_error", "Exception related to predicate", bp::no_init);
   
@@ -186,7 +340,7 @@ void export_transactions() {
    *    - __init__(self, predicate)
    *    - __init__(self, symbol, symbol)
    */
-  bp::class_<Observation, observation_id, bp::bases<Predicate> >
+  bp::class_<Observation, SHARED_PTR<Observation>, bp::bases<Predicate> >
   ("obs", "trex observation.\n\n"
    "A Trex observation is a predicate that applies to the current tick.\n"
    "It is the state value of the timeline self.object",
@@ -200,6 +354,8 @@ void export_transactions() {
   .def("from_xml", &obs_from_xml, (bp::arg("xml")),
        "Create an observation from its xml description").staticmethod("from_xml")
   ;
+  bp::to_python_converter<observation_id, obs_id_to_python>();
+  bp::implicitly_convertible<SHARED_PTR<Observation>, observation_id>();
   
   /*
    * class goal(predicate):
@@ -294,6 +450,30 @@ void export_transactions() {
                                   bp::return_internal_reference<>()),
                 "Get xml tag used to create to this reactor");
   
+  bp::class_<tick_batch, boost::noncopyable>
+  ("tick_batch", "Events received by a reactor during a tick.\n"
+   "A reactor created with the attribute batch=\"1\" gets them\n"
+   "all at once through its handle_batch callback", bp::no_init)
+  .def_readonly("tick", &tick_batch::tick, "The tick of this batch")
+  .add_property("observations", &batch_obs,
+                "List of the observations received")
+  .add_property("requests", &batch_requests,
+                "List of the goals requested")
+  .add_property("recalls", &batch_recalls,
+                "List of the goals recalled")
+  .add_property("new_plans", &batch_plans,
+                "List of the plan tokens received")
+  .add_property("cancelled_plans", &batch_cancelled,
+                "List of the plan tokens cancelled")
+  .add_property("empty", &tick_batch::empty,
+                "True if no event was received during the tick")
+  .def("column", &batch_column,
+       (bp::arg("self"), bp::arg("name"), bp::arg("bound")="value"),
+       "Extract the numeric attribute name of the observations.\n"
+       "Same as trex.transaction.column(self.observations, name, bound)\n"
+       "without building the observation list.")
+  ;
+  
   bp::class_<reactor_wrap, boost::noncopyable>
   ("reactor", "Python api for reactor.\n"
    "This class allow user to define their own reactor\n"
@@ -518,6 +698,20 @@ void export_transactions() {
        "      use this functionality\n\n"
        "Warning: this method is a callback and hence is not meant to\n"
        "         be called directly. It is called by trex automatically")
+  .def("handle_batch", &reactor_proxy::handle_batch,
+       &reactor_wrap::handle_batch_default,
+       bp::args("self", "batch"),
+       "Give all the events of the tick at once right before\n"
+       "synchronize. It is only called when the reactor was created\n"
+       "with the attribute batch=\"1\" and then replaces all the\n"
+       "calls to handle_new_tick, notify, handle_request,\n"
+       "handle_recall, new_plan and cancelled_plan. This allows\n"
+       "to handle a whole tick with a single acquisition of the\n"
+       "python interpreter lock.\n"
+       "The default implementation calls these callbacks for each\n"
+       "event of batch.\n\n"
+       "Warning: this method is a callback and hence is not meant to\n"
+       "         be called directly. It is called by trex automatically")
   .def("info", &reactor_proxy::info,
        bp::args("self", "msg"),
        "Log msg in TREX.log as an info message")
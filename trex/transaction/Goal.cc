@@ -84,12 +84,13 @@ Goal::Goal(boost::property_tree::ptree::value_type &node)
   :Predicate(node), m_start(s_startName, s_dateDomain), 
    m_duration(s_durationName, s_durationDomain), 
    m_end(s_endName, s_dateDomain) {
+  // note: remove invalidates the iterators so end() is reevaluated
+  //       after each removal
   iterator iStart = find(s_startName), 
     iDuration, iEnd;
-  iterator const endi = end();
   IntegerDomain dStart(s_dateDomain), dDuration(s_durationDomain),
     dEnd(s_dateDomain);
-  if( endi!=iStart ) {
+  if( end()!=iStart ) {
     try {
       dStart.restrictWith(iStart->second.domain());
     } catch( EmptyDomain const &e ) {
@@ -98,7 +99,7 @@ Goal::Goal(boost::property_tree::ptree::value_type &node)
     remove(iStart);
   }
   iDuration = find(s_durationName);
-  if( endi!=iDuration ) {
+  if( end()!=iDuration ) {
     try {
       dDuration.restrictWith(iDuration->second.domain());
     } catch( EmptyDomain const &e ) {
@@ -107,7 +108,7 @@ Goal::Goal(boost::property_tree::ptree::value_type &node)
     remove(iDuration);
   }
   iEnd = find(s_endName);
-  if( endi!=iEnd ) {
+  if( end()!=iEnd ) {
     try {
       dEnd.restrictWith(iEnd->second.domain());
     } catch( EmptyDomain const &e ) {
@@ -139,25 +140,25 @@ void Goal::restrictTime(IntegerDomain const &s,
   IntegerDomain::bound sLo, sHi, dLo, dHi, eLo, eHi;
   IntegerDomain::bound mLo, mHi, aLo, aHi;
 
-  if( !( m_start.domain().intersect(s) && 
-	 m_duration.domain().intersect(d) &&
-	 m_end.domain().intersect(e) ) )
+  if( !( getStart().intersect(s) && 
+	 getDuration().intersect(d) &&
+	 getEnd().intersect(e) ) )
     throw PredicateException("Invalid time constraint on Goal");
   // Compute the new domains
-  m_start.typedDomain<IntegerDomain>().getBounds(sLo, sHi);
+  getStart().getBounds(sLo, sHi);
   
   s.getBounds(aLo, aHi);
   // s = s inter start
   sLo = sLo.max(aLo);
   sHi = sHi.min(aHi);
 
-  m_duration.typedDomain<IntegerDomain>().getBounds(dLo, dHi);
+  getDuration().getBounds(dLo, dHi);
   d.getBounds(aLo, aHi);
   // d = d inter duration 
   dLo = dLo.max(aLo);
   dHi = dHi.min(aHi);
 
-  m_end.typedDomain<IntegerDomain>().getBounds(eLo, eHi);
+  getEnd().getBounds(eLo, eHi);
   e.getBounds(aLo, aHi);
   // e = e inter end
   eLo = eLo.max(aLo);
@@ -210,10 +211,16 @@ void Goal::restrictTime(IntegerDomain const &s,
 }
 
 bool Goal::startsAfter(TICK date, TICK delay) {
-  IntegerDomain test_window(date+delay, IntegerDomain::plus_inf),
-    cstr_window(date, IntegerDomain::plus_inf);
-  if( m_start.typedDomain<IntegerDomain>().intersect(test_window) ) {
-    restrictTime(cstr_window, s_durationDomain, s_dateDomain);
+  IntegerDomain const &start = getStart();
+  
+  if( start.intersect(IntegerDomain::bound(date+delay), 
+                      IntegerDomain::plus_inf) ) {
+    // Only propagate when the start is actually restricted: the time 
+    // attributes are always kept consistent otherwise
+    if( start.lowerBound()<IntegerDomain::bound(date) ) {
+      IntegerDomain cstr_window(date, IntegerDomain::plus_inf);
+      restrictTime(cstr_window, s_durationDomain, s_dateDomain);
+    }
     return true;
   }
   return false;
@@ -232,16 +239,20 @@ Variable const &Goal::getAttribute(Symbol const &name) const {
     return Predicate::getAttribute(name);
 }
 
+// The temporal attributes are private and only restricted through 
+// restrictTime with IntegerDomain values, their type is then statically
+// known
+
 IntegerDomain const &Goal::getStart() const {
-  return m_start.typedDomain<IntegerDomain>();
+  return static_cast<IntegerDomain const &>(m_start.domain());
 }
 
 IntegerDomain const &Goal::getDuration() const {
-  return m_duration.typedDomain<IntegerDomain>();
+  return static_cast<IntegerDomain const &>(m_duration.domain());
 }
 
 IntegerDomain const &Goal::getEnd() const {
-  return m_end.typedDomain<IntegerDomain>();
+  return static_cast<IntegerDomain const &>(m_end.domain());
 }
 
 
@@ -33,6 +33,11 @@
  */
 #include "LogPlayer.hh"
 #include <set>
+#include <fstream>
+#include <iterator>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 
 
 namespace TREX {
@@ -453,7 +458,80 @@ namespace TREX {
         bool m_work;
       };
       
+      /** @brief Decoded event
+       *
+       * An event decoded from a binary log. It just embeds the call
+       * to the LogPlayer replaying this event.
+       *
+       * @relates LogPlayer
+       * @ingroup transaction
+       */
+      class tr_call :public tr_event {
+      public:
+        tr_call(LogPlayer &owner, boost::function<void ()> const &fn)
+        :tr_event(owner), m_fn(fn) {}
+        ~tr_call() {}
+      private:
+        void play() {
+          m_fn();
+        }
+        boost::function<void ()> m_fn;
+      }; // TREX::transaction::details::tr_call
+      
     } // TREX::transaction::details
+    
+    /** @brief Binary log source
+     *
+     * The memory mapped content of a binary log along with the symbols
+     * declared so far in this log.
+     *
+     * @relates LogPlayer
+     * @ingroup transaction
+     */
+    class LogPlayer::binary_source :boost::noncopyable {
+    public:
+      explicit binary_source(std::string const &file_name);
+      ~binary_source() {}
+      
+      details::binary_log::decoder &input() {
+        return m_in;
+      }
+      size_t size() const {
+        return m_region.get_size();
+      }
+      char const *at(boost::uint64_t offset) const {
+        return m_data+std::min(offset, boost::uint64_t(size()));
+      }
+      details::binary_log::tick_index const &index() const {
+        return m_index;
+      }
+      
+      /** @brief Load the tick index
+       * @param[in] file_name The tick index file
+       *
+       * Load the tick index from @p file_name and complete it with the
+       * ticks of the log that are not in the file. If the file does not
+       * exist or is invalid the index is rebuilt from the log.
+       *
+       * @return the number of ticks added to the index loaded from
+       *         @p file_name
+       */
+      size_t load_index(std::string const &file_name);
+      
+      void declare(details::binary_log::decoder &in);
+      std::string const &text(boost::uint32_t id) const;
+      void attributes(details::binary_log::decoder &in, Predicate &pred);
+      
+    private:
+      boost::interprocess::file_mapping  m_file;
+      boost::interprocess::mapped_region m_region;
+      char const                        *m_data;
+      details::binary_log::decoder       m_in;
+      details::binary_log::tick_index    m_index;
+      
+      std::vector<std::string>           m_symbols;
+    }; // TREX::transaction::LogPlayer::binary_source
+    
   } // TREX::transaction
 } // TREX
 
@@ -495,6 +573,18 @@ namespace {
   details::tr_event::factory::declare<details::tr_work>
   d_work("work");
   
+  /*
+   * Key of a goal in a binary log. Requests and plan tokens are kept
+   * apart as the same goal can be both posted and part of the plan.
+   */
+  std::string const request_prefix("request:");
+  std::string const token_prefix("token:");
+  
+  std::string binary_goal_key(std::string const &prefix, 
+                              boost::uint64_t id) {
+    return prefix+boost::lexical_cast<std::string>(id);
+  }
+  
 } // ::
 
 /*
@@ -516,6 +606,97 @@ LogPlayer::phase::phase(LogPlayer *owner,
     m_events.push_back(event);
 }
 
+/*
+ * class TREX::transaction::LogPlayer::binary_source
+ */
+
+LogPlayer::binary_source::binary_source(std::string const &file_name)
+:m_file(file_name.c_str(), boost::interprocess::read_only),
+m_region(m_file, boost::interprocess::read_only) {
+  namespace bl=details::binary_log;
+  m_data = static_cast<char const *>(m_region.get_address());
+  m_in = bl::decoder(m_data, m_data+m_region.get_size());
+  for(size_t i=0; i<sizeof(bl::magic); ++i)
+    if( m_in.get_u8()!=static_cast<boost::uint8_t>(bl::magic[i]) )
+      throw bl::format_error("invalid magic number");
+  if( m_in.get_u8()!=bl::version )
+    throw bl::format_error("unsupported version");
+}
+
+size_t LogPlayer::binary_source::load_index(std::string const &file_name) {
+  namespace bl=details::binary_log;
+  std::ifstream in(file_name.c_str(), std::ios::binary);
+  
+  if( in ) {
+    std::string content((std::istreambuf_iterator<char>(in)),
+                        std::istreambuf_iterator<char>());
+    bl::decoder idx(content.data(), content.data()+content.length());
+    
+    try {
+      m_index.decode(idx);
+      if( !m_index.empty() ) {
+        // Check that the last entry refers to its tick in the log
+        bl::decoder check(at(m_index.back().second), at(size())), payload;
+        
+        if( bl::rec_tick!=check.get_record(payload) ||
+            payload.get_i64()!=m_index.back().first )
+          throw bl::format_error("tick index does not match the log");
+      }
+    } catch(bl::format_error const &e) {
+      m_index = bl::tick_index();
+    }
+  }
+  size_t loaded = m_index.size();
+  
+  // Index the ticks that are not in the file
+  bl::decoder log(at(m_index.empty()?bl::header_size:m_index.back().second),
+                  at(size())), payload;
+  
+  if( !m_index.empty() )
+    log.get_record(payload); // skip the last tick indexed
+  while( !log.empty() ) {
+    char const *pos = log.position();
+    
+    if( bl::rec_tick==log.get_record(payload) )
+      m_index.add(payload.get_i64(), pos-m_data);
+  }
+  if( m_index.size()>loaded ) {
+    // Try to save the updated index for later replays
+    bl::encoder out;
+    
+    bl::tick_index::encode_header(out);
+    for(bl::tick_index::iterator i=m_index.begin(); m_index.end()!=i; ++i)
+      bl::tick_index::encode_entry(out, i->first, i->second);
+    std::ofstream save(file_name.c_str(), std::ios::binary|std::ios::trunc);
+    save.write(out.str().c_str(), out.str().length());
+  }
+  return m_index.size()-loaded;
+}
+
+void LogPlayer::binary_source::declare(details::binary_log::decoder &in) {
+  boost::uint32_t id = in.get_u32();
+  
+  if( id!=m_symbols.size() )
+    throw details::binary_log::format_error("symbol declared out of order");
+  m_symbols.push_back(in.get_str());
+}
+
+std::string const &LogPlayer::binary_source::text(boost::uint32_t id) const {
+  if( id>=m_symbols.size() )
+    throw details::binary_log::format_error("reference to undeclared symbol");
+  return m_symbols[id];
+}
+
+void LogPlayer::binary_source::attributes(details::binary_log::decoder &in,
+                                          Predicate &pred) {
+  for(boost::uint32_t n = in.get_u32(); n>0; --n) {
+    Symbol name(text(in.get_u32()));
+    UNIQ_PTR<DomainBase> dom(details::binary_log::decode_domain(in));
+    
+    pred.restrictAttribute(Variable(name, *dom));
+  }
+}
+
 /*
  * class TREX::transaction::LogPlayer
  */
@@ -537,18 +718,46 @@ TeleoReactor::xml_arg_type &LogPlayer::alter_cfg(TeleoReactor::xml_arg_type &arg
 
 LogPlayer::LogPlayer(TeleoReactor::xml_arg_type arg)
 :TeleoReactor(arg, false, false) {
+  boost::property_tree::ptree::value_type &node = xml_factory::node(arg);
   std::string
-  file_name = utils::parse_attr<std::string>(getName().str()+".tr.log",
-                                             xml_factory::node(arg),
-                                             "file");
+  file_name = utils::parse_attr<std::string>("", node, "file");
+  
+  m_start = utils::parse_attr< boost::optional<TICK> >(node, "start");
+  m_end = utils::parse_attr< boost::optional<TICK> >(node, "end");
+  if( m_start && m_end && *m_end<*m_start )
+    throw utils::XmlError(node, "end tick is before start tick");
   bool found;
-  file_name = manager().use(file_name, found);
+  if( file_name.empty() ) {
+    // Look for a XML log first and then for a binary one
+    file_name = manager().use(getName().str()+".tr.log", found);
+    if( !found )
+      file_name = manager().use(getName().str()+".tr.bin", found);
+  } else
+    file_name = manager().use(file_name, found);
   if( !found ) {
     syslog(null, error)<<"Unable to locate transaction log \""
     <<file_name<<"\".";
     throw ReactorException(*this,
                            "Unable to locate specified transaction log file.");
   }
+  // Identify the log format from its first bytes
+  char head[sizeof(details::binary_log::magic)];
+  std::ifstream in(file_name.c_str(), std::ios::binary);
+  
+  if( in.read(head, sizeof(head)) &&
+      std::equal(head, head+sizeof(head), details::binary_log::magic) ) {
+    in.close();
+    load_binary(file_name);
+  } else {
+    in.close();
+    load_xml(file_name);
+  }
+}
+
+LogPlayer::~LogPlayer() {
+}
+
+void LogPlayer::load_xml(std::string const &file_name) {
   boost::property_tree::ptree pt;
   read_xml(file_name, pt, xml::no_comments|xml::trim_whitespace);
   
@@ -586,6 +795,8 @@ LogPlayer::LogPlayer(TeleoReactor::xml_arg_type arg)
   bool first = true;
   for( ; last!=i; ++i) {
     TICK cur = utils::parse_attr<TICK>(*i, "value");
+    if( m_end && cur>*m_end )
+      break;
     for(boost::property_tree::ptree::iterator j=i->second.begin();
         i->second.end()!=j; ++j) {
       if( s_init==j->first ) {
@@ -614,13 +825,126 @@ LogPlayer::LogPlayer(TeleoReactor::xml_arg_type arg)
   m_goal_map.clear();
 }
 
-LogPlayer::~LogPlayer() {
+void LogPlayer::load_binary(std::string const &file_name) {
+  namespace bl=details::binary_log;
+  
+  try {
+    m_binary.reset(new binary_source(file_name));
+  } catch(bl::format_error const &e) {
+    syslog(null, error)<<"Transaction log \""<<file_name<<"\": "<<e;
+    throw ReactorException(*this, "Invalid binary transaction log file.");
+  }
+  
+  bl::decoder &in = m_binary->input(), payload;
+  
+  // Play the header : all the events before the first tick
+  while( !in.empty() ) {
+    bl::decoder rec = in;
+    bl::record_type type = rec.get_record(payload);
+    
+    if( bl::rec_tick==type )
+      break;
+    else if( bl::rec_symbol==type )
+      m_binary->declare(payload);
+    else {
+      SHARED_PTR<details::tr_event> event = decode_event(type, payload);
+      if( event )
+        event->play();
+    }
+    in = rec;
+  }
+  if( in.empty() )
+    syslog(null, warn)<<" this reactor has no event to play.";
+  else {
+    syslog(null, info)<<"Mapped "<<m_binary->size()<<" bytes of binary log \""
+    <<file_name<<"\".";
+    if( m_start ) {
+      size_t added = m_binary->load_index(file_name+".idx");
+      if( added>0 )
+        syslog(null, info)<<"Indexed "<<added<<" ticks missing from \""
+        <<file_name<<".idx\"";
+      seek(*m_start);
+    }
+  }
+}
+
+void LogPlayer::seek(TICK target) {
+  namespace bl=details::binary_log;
+  
+  bl::tick_index::iterator pos = m_binary->index().seek(target);
+  bl::decoder &in = m_binary->input(), payload;
+  char const *dest;
+  
+  if( m_binary->index().end()==pos )
+    dest = m_binary->at(m_binary->size());
+  else
+    dest = m_binary->at(pos->second);
+  if( dest<=in.position() )
+    return;
+  
+  // Skim through the records before the target: only the timeline
+  // declarations are played and the last observation of each timeline is
+  // kept to be posted when we reach the target
+  std::map<boost::uint32_t, bl::decoder> last_obs;
+  size_t skipped = 0;
+  
+  while( in.position()<dest ) {
+    bl::record_type type = in.get_record(payload);
+    
+    switch( type ) {
+      case bl::rec_symbol:
+        m_binary->declare(payload);
+        break;
+      case bl::rec_unprovide:
+        last_obs.erase(bl::decoder(payload).get_u32());
+        // no break : the unprovide needs to be played too
+      case bl::rec_use:
+      case bl::rec_unuse:
+      case bl::rec_provide:
+      case bl::rec_latency:
+      case bl::rec_horizon:
+      {
+        SHARED_PTR<details::tr_event> event = decode_event(type, payload);
+        if( event )
+          event->play();
+      }
+        break;
+      case bl::rec_obs:
+        last_obs[bl::decoder(payload).get_u32()] = payload;
+        break;
+      case bl::rec_tick:
+      case bl::rec_phase:
+      case bl::rec_comment:
+        break;
+      default:
+        ++skipped;
+    }
+  }
+  syslog(null, info)<<"Skipped to tick "<<target<<" ("<<skipped
+  <<" events ignored).";
+  if( last_obs.empty() || !has_phase() )
+    return;
+  
+  // Post the current state of the timelines on the first synchronization
+  TICK tick = m_log.front().first;
+  std::list<tick_event>::iterator i = m_log.begin();
+  
+  while( m_log.end()!=i && tick==i->first &&
+        ( s_init==i->second->type() || s_new_tick==i->second->type() ) )
+    ++i;
+  if( m_log.end()==i || tick!=i->first ||
+     s_synchronize!=i->second->type() )
+    i = m_log.insert(i, std::make_pair(tick,
+                                       SHARED_PTR<phase>(new phase(s_synchronize))));
+  for(std::map<boost::uint32_t, bl::decoder>::reverse_iterator o=last_obs.rbegin();
+      last_obs.rend()!=o; ++o)
+    i->second->add_front(decode_event(bl::rec_obs, o->second));
 }
 
 // manipulators
 
 bool LogPlayer::next_phase(TICK tck, utils::Symbol const &kind) {
-  if( !m_log.empty() ) {
+  if( has_phase() ) {
     if( m_log.front().first==tck  ) {
       SHARED_PTR<phase> nxt = m_log.front().second;
       if( nxt->type()==kind ) {
@@ -630,13 +954,197 @@ bool LogPlayer::next_phase(TICK tck, utils::Symbol const &kind) {
         return true;
       }
     }
-  } else
+  } else if( !m_end || tck<=*m_end )
     syslog(warn)<<"No more phase to replay (tick="<<tck<<')';
   return false;
 }
 
-bool LogPlayer::in_tick(TICK tck) const {
-  return !m_log.empty() && m_log.front().first==tck;
+bool LogPlayer::in_tick(TICK tck) {
+  return has_phase() && m_log.front().first==tck;
+}
+
+bool LogPlayer::has_phase() {
+  if( m_log.empty() )
+    load_tick();
+  return !m_log.empty();
+}
+
+bool LogPlayer::load_tick() {
+  namespace bl=details::binary_log;
+  
+  if( !m_binary )
+    return false;
+  
+  prune_requests();
+  
+  bl::decoder &in = m_binary->input(), payload;
+  SHARED_PTR<phase> cur;
+  TICK tick = 0;
+  bool started = false;
+  
+  while( !in.empty() ) {
+    bl::decoder rec = in;
+    bl::record_type type = rec.get_record(payload);
+    
+    if( bl::rec_tick==type ) {
+      if( started )
+        break; // this is the next tick : keep it for later
+      tick = payload.get_i64();
+      if( m_end && tick>*m_end )
+        break; // end of the replay window
+      started = true;
+    } else if( bl::rec_symbol==type )
+      m_binary->declare(payload);
+    else if( bl::rec_phase==type ) {
+      switch( payload.get_u8() ) {
+        case bl::phase_init:
+          cur.reset(new phase(s_init));
+          break;
+        case bl::phase_new_tick:
+          cur.reset(new phase(s_new_tick));
+          break;
+        case bl::phase_synchronize:
+          cur.reset(new phase(s_synchronize));
+          break;
+        case bl::phase_has_work:
+          cur.reset(new phase(s_has_work));
+          break;
+        case bl::phase_step:
+          cur.reset(new phase(s_step));
+          break;
+        default:
+          syslog(null, warn)<<"Skipping unknown phase in tick "<<tick;
+          cur.reset();
+      }
+      if( cur )
+        m_log.push_back(std::make_pair(tick, cur));
+    } else if( cur ) {
+      SHARED_PTR<details::tr_event> event = decode_event(type, payload);
+      if( event )
+        cur->add(event);
+    }
+    in = rec;
+  }
+  return started;
+}
+
+void LogPlayer::prune_requests() {
+  // A request only referred by m_goal_map is no longer known by the
+  // agent : it is completed and its recall -- if any -- would be a no-op
+  std::map<std::string, goal_id>::iterator i = m_goal_map.begin();
+  
+  while( m_goal_map.end()!=i ) {
+    if( 0==i->first.compare(0, request_prefix.size(), request_prefix) &&
+        1==i->second.use_count() )
+      m_goal_map.erase(i++);
+    else
+      ++i;
+  }
+}
+
+SHARED_PTR<details::tr_event>
+LogPlayer::decode_event(details::binary_log::record_type type,
+                        details::binary_log::decoder &in) {
+  namespace bl=details::binary_log;
+  boost::function<void ()> fn;
+  
+  switch( type ) {
+    case bl::rec_use:
+    case bl::rec_provide:
+    {
+      Symbol tl(m_binary->text(in.get_u32()));
+      bool goals = in.get_u8(), plan = in.get_u8();
+      
+      if( bl::rec_use==type )
+        fn = boost::bind(&LogPlayer::play_use, this, tl, goals, plan);
+      else
+        fn = boost::bind(&LogPlayer::play_provide, this, tl, goals, plan);
+    }
+      break;
+    case bl::rec_unuse:
+      fn = boost::bind(&LogPlayer::play_unuse, this,
+                       Symbol(m_binary->text(in.get_u32())));
+      break;
+    case bl::rec_unprovide:
+      fn = boost::bind(&LogPlayer::play_unprovide, this,
+                       Symbol(m_binary->text(in.get_u32())));
+      break;
+    case bl::rec_latency:
+      fn = boost::bind(&LogPlayer::play_latency, this, TICK(in.get_i64()));
+      break;
+    case bl::rec_horizon:
+      fn = boost::bind(&LogPlayer::play_horizon, this, TICK(in.get_i64()));
+      break;
+    case bl::rec_failed:
+      fn = boost::bind(&LogPlayer::play_failed, this);
+      break;
+    case bl::rec_work:
+      fn = boost::bind(&LogPlayer::set_work, this, in.get_u8()!=0);
+      break;
+    case bl::rec_obs:
+    {
+      Observation obs(Symbol(m_binary->text(in.get_u32())),
+                      Symbol(m_binary->text(in.get_u32())));
+      m_binary->attributes(in, obs);
+      fn = boost::bind(&LogPlayer::play_obs, this, obs);
+    }
+      break;
+    case bl::rec_request:
+    case bl::rec_token:
+    {
+      std::string key = binary_goal_key(bl::rec_request==type ? 
+                                        request_prefix : token_prefix,
+                                        in.get_u64());
+      Symbol obj(m_binary->text(in.get_u32())),
+        pred(m_binary->text(in.get_u32()));
+      goal_id g(new Goal(obj, pred));
+      
+      m_binary->attributes(in, *g);
+      m_goal_map[key] = g;
+      if( bl::rec_request==type )
+        fn = boost::bind(&LogPlayer::play_request, this, g);
+      else
+        fn = boost::bind(&LogPlayer::play_add, this, g);
+    }
+      break;
+    case bl::rec_recall:
+    case bl::rec_cancel:
+    {
+      std::string key = binary_goal_key(bl::rec_recall==type ?
+                                        request_prefix : token_prefix,
+                                        in.get_u64());
+      std::map<std::string, goal_id>::iterator
+      pos = m_goal_map.find(key);
+      
+      if( m_goal_map.end()==pos ) {
+        if( m_start ) {
+          // the goal was probably posted before the start of the replay
+          syslog(null, warn)<<"Ignoring event on goal "<<key
+          <<" posted before tick "<<(*m_start);
+          return SHARED_PTR<details::tr_event>();
+        }
+        if( bl::rec_recall==type ) {
+          // the request was already completed and pruned
+          syslog(null, warn)<<"Ignoring recall of completed goal "<<key;
+          return SHARED_PTR<details::tr_event>();
+        }
+        throw ReactorException(*this, "Unable to find goal for id \""+key+"\".");
+      }
+      if( bl::rec_recall==type )
+        fn = boost::bind(&LogPlayer::play_recall, this, pos->second);
+      else
+        fn = boost::bind(&LogPlayer::play_cancel, this, pos->second);
+      // the writer no longer refers to this goal
+      m_goal_map.erase(pos);
+    }
+      break;
+    case bl::rec_comment:
+      return SHARED_PTR<details::tr_event>();
+    default:
+      syslog(null, warn)<<"Skipping unknown binary record "<<int(type);
+      return SHARED_PTR<details::tr_event>();
+  }
+  return SHARED_PTR<details::tr_event>(new details::tr_call(*this, fn));
 }
 
 // callbacks
@@ -651,7 +1159,7 @@ void LogPlayer::handleTickStart() {
   if( !next_phase(getCurrentTick(), s_new_tick) ) {
     size_t skipped =0;
     std::ostringstream oss;
-    while( !m_log.empty() && m_log.front().first<getCurrentTick() ) {
+    while( has_phase() && m_log.front().first<getCurrentTick() ) {
       oss<<"\n\t- ["<<m_log.front().first<<"]: "
       <<m_log.front().second->type();
       size_t n = m_log.front().second->execute();
@@ -741,6 +1249,10 @@ void LogPlayer::play_cancel(goal_id const &g) {
   cancelPlanToken(g);
 }
 
+void LogPlayer::play_failed() {
+  throw ReactorException(*this, "Played failed log event.");
+}
+
 using namespace TREX::transaction::details;
 
 /*
@@ -752,6 +1264,9 @@ using namespace TREX::transaction::details;
 tr_event::tr_event(tr_event::factory::argument_type const &arg)
 :m_reactor(*(arg.second)) {}
 
+tr_event::tr_event(LogPlayer &owner)
+:m_reactor(owner) {}
+
 // manipulators
 
 goal_id tr_event::get_goal(std::string const &key) {
@@ -35,6 +35,9 @@
 # define H_trex_transaction_LogPlayer
 
 # include "TeleoReactor.hh"
+# include "bits/binary_log.hh"
+
+# include <boost/optional.hpp>
 
 namespace TREX {
   namespace transaction {
@@ -72,6 +75,13 @@ namespace TREX {
 	 * associate the new instance to this reactor.
 	 */
 	tr_event(factory::argument_type const &arg);
+	/** @brief Constructor
+	 * @param[in] owner A LogPlayer
+	 *
+	 * Create a new event attached to @p owner. This constructor is
+	 * used for events that are not extracted from an XML log.
+	 */
+	explicit tr_event(LogPlayer &owner);
 	/** @brief Destructor */
 	virtual ~tr_event() {}
 
@@ -146,7 +156,7 @@ namespace TREX {
        * @p arg. The XML format is:
        * @code 
        * <LogPlayer name="<name>" latency="<latency>" lookahead="<lookahead>"
-       *            file="<logfile>" />
+       *            file="<logfile>" start="<start>" end="<end>" />
        * @endcode 
        * Where:
        * @li @c <name> is the reactor name
@@ -155,7 +165,20 @@ namespace TREX {
        * @li @c <logfile> is an optional attribute pointing 
        *     to the transaction log file to replay. If this 
        *     is not specified then the reactor will olook for 
-       *     @c <name>.tr.log
+       *     @c <name>.tr.log and then for @c <name>.tr.bin
+       * @li @c <start> is an optional tick from which the replay starts
+       * @li @c <end> is an optional tick after which the replay stops
+       *
+       * The log can be either in XML or binary format. Binary logs are 
+       * memory mapped and decoded one tick at a time during the replay 
+       * while XML logs are fully loaded by this constructor.
+       *
+       * When @c <start> is given for a binary log, the player uses the 
+       * tick index of the log (rebuilding it if it is missing) to jump 
+       * directly to this tick. Only the timeline declarations and the 
+       * last observation of each timeline preceding @c <start> are then 
+       * replayed, goals and plan tokens posted before this tick are 
+       * ignored.
        * 
        * @pre the log file loaded is a valid transaction log file.
        *
@@ -262,6 +285,8 @@ namespace TREX {
       void play_horizon(TICK val);
 
     private:
+      class binary_source;
+
       void handleInit();
       void handleTickStart();
       bool synchronize();
@@ -290,8 +315,17 @@ namespace TREX {
       class phase {
       public:
 	phase(LogPlayer *owner, boost::property_tree::ptree::value_type &node);
+	explicit phase(utils::Symbol const &type)
+	:m_type(type) {}
 	~phase() {}
 
+	void add(SHARED_PTR<details::tr_event> const &event) {
+	  m_events.push_back(event);
+	}
+	void add_front(SHARED_PTR<details::tr_event> const &event) {
+	  m_events.push_front(event);
+	}
+
 	utils::Symbol const &type() const {
 	  return m_type;
 	}
@@ -314,7 +348,30 @@ namespace TREX {
       std::map<std::string, goal_id> m_goal_map;
 
       bool next_phase(TICK tck, utils::Symbol const &kind); 
-      bool in_tick(TICK tck) const;
+      bool in_tick(TICK tck);
+      bool has_phase();
+      
+      void load_xml(std::string const &file_name);
+      void load_binary(std::string const &file_name);
+      bool load_tick();
+      void prune_requests();
+      void seek(TICK target);
+      SHARED_PTR<details::tr_event>
+      decode_event(details::binary_log::record_type type,
+                   details::binary_log::decoder &in);
+      void play_failed();
+      
+      /** @brief Binary log source
+       *
+       * The memory mapped binary log being replayed or NULL if the log
+       * is in XML
+       */
+      UNIQ_PTR<binary_source> m_binary;
+      /** @brief Replay window
+       *
+       * The optional first and last ticks to replay
+       */
+      boost::optional<TICK> m_start, m_end;
       
       static TeleoReactor::xml_arg_type &alter_cfg(TeleoReactor::xml_arg_type &arg);
 
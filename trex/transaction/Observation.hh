@@ -113,18 +113,15 @@ namespace TREX {
     
     /** @brief An observation id
      *
-     * A type (not yet) used to refer to a specific observation.
-     * This class is part of a long term plan t orefactor observations
-     * in a similar way goals are manipulated in ucrrent trex version.
-     * While there is not plan yet on when this will be done, we do
-     * believe  that this refactoring would be benefitial for further
-     * evolutions of the framework such as allowing to post/refine
-     * observations in the past.
+     * A type used to refer to a specific observation. Observations are
+     * allocated once when posted and then shared by the timeline, all
+     * its clients and the transaction logs. An observation refered by
+     * an observation_id is therefore const.
      *
      * @relates class Observation
      * @sa goal_id
      */
-    typedef SHARED_PTR<Observation> observation_id;
+    typedef SHARED_PTR<Observation const> observation_id;
     
   } // TREX::transaction
 } // TREX
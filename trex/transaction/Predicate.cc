@@ -39,6 +39,8 @@
  */
 #include "Predicate.hh"
 
+#include <trex/utils/json_writer.hh>
+
 using namespace TREX::utils;
 using namespace TREX::transaction;
 
@@ -86,19 +88,19 @@ Predicate::~Predicate() {}
 void Predicate::restrictAttribute(Variable const &var) {
   if( !var.isComplete() )
     throw PredicateException("Predicate attribute is not fully defined");
-  iterator pos = m_vars.lower_bound(var.name());
-  if( end()!=pos && var.name()==pos->second.name() ) {
+  iterator pos = lower_bound(var.name());
+  if( end()!=pos && var.name()==pos->first ) {
     pos->second.restrict(var);
   } else {
     // probably need to check if the varaible is valid/OK
-    m_vars.insert(pos, std::make_pair(var.name(), var));
+    m_vars.insert(pos.m_pos, std::make_pair(var.name(), var));
   }
 }
 
 // observers :
 
 Variable const &Predicate::getAttribute(Symbol const &name) const {
-  const_iterator pos = m_vars.find(name);
+  const_iterator pos = find(name);
   if( end()==pos ) 
     throw PredicateException("Attribute \""+name.str()+"\" is unknown");
   return pos->second;
@@ -162,6 +164,36 @@ boost::property_tree::ptree Predicate::as_tree(bool all) const {
   return ret;
 }
 
+void Predicate::json_content(json_writer &out, bool all) const {
+  out.begin_object();
+  out.key("on").value(object().str());
+  out.key("pred").value(predicate().str());
+  if( all ) {
+    std::list<Symbol> vars;
+    listAttributes(vars, false);
+    
+    if( !vars.empty() ) {
+      out.key("Variable").begin_array();
+      for( ; !vars.empty(); vars.pop_front() )
+        getAttribute(vars.front()).to_json(out);
+      out.end_array();
+    }
+  } else if( !m_vars.empty() ) {
+    out.key("Variable").begin_array();
+    for(const_iterator i=begin(); end()!=i; ++i)
+      i->second.to_json(out);
+    out.end_array();
+  }
+  out.end_object();
+}
+
+void Predicate::json_value(json_writer &out) const {
+  out.begin_object();
+  out.key(getPredTag().str());
+  json_content(out, true);
+  out.end_object();
+}
+
 
 void Predicate::listAttributes(std::list<TREX::utils::Symbol> &attrs,
 			       bool all) const {
@@ -182,9 +214,9 @@ bool Predicate::consistentWith(Predicate const &other) const {
     const_iterator i = begin(), j=other.begin();
     while( end()!=i && other.end()!=j ) {
       if( i->first < j->first )
-        i = m_vars.lower_bound(j->first);
+        i = lower_bound(j->first);
       else if( j->first < i->first )
-        j = other.m_vars.lower_bound(i->first);
+        j = other.lower_bound(i->first);
       else {
         if( !i->second.domain().intersect(j->second.domain()) ) {
           //std::cerr << i->second << " != " << j->second << std::endl;
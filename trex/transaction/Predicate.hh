@@ -45,8 +45,12 @@
 #ifndef H_Predicate
 # define H_Predicate
 
-# include <map>
+# include <vector>
 # include <list>
+# include <algorithm>
+# include <iterator>
+
+# include <boost/iterator/iterator_facade.hpp>
 
 // put it this way to avoid conflict with Europa
 # include <trex/domain/Variable.hh>
@@ -91,20 +95,102 @@ namespace TREX {
      * A goal has just the specificity to also define the @c start,
      * @c duration and @c end temporal attributes.
      *
+     * The attributes are stored in a flat vector sorted by name. As the
+     * variables share their domains between copies, copying a predicate
+     * only needs to allocate this vector.
+     *
      * @author Frederic Py <fpy@mbari.org>
      * @ingroup transaction
      */
     class Predicate :public TREX::utils::ostreamable, public TREX::utils::ptree_convertible {
     protected:
       /** @brief Type used to store predicate attributes */
-      typedef std::map<TREX::utils::Symbol, Variable> attr_set;
+      typedef std::vector< std::pair<TREX::utils::Symbol, Variable> > attr_set;
       
     public:
-      /** @brief Predicate attributes' iterator */
-      typedef attr_set::iterator iterator;
       /** @brief Predicate attributes' const iterator */
       typedef attr_set::const_iterator const_iterator;
       
+      /** @brief Mutable attribute reference
+       *
+       * The value returned when dereferencing a predicate iterator. It
+       * gives write access to the attribute variable while keeping its
+       * name read only as the attributes are kept sorted by name.
+       */
+      struct attribute_ref {
+        attribute_ref(attr_set::value_type &attr)
+        :first(attr.first), second(attr.second) {}
+        
+        /** @brief attribute name */
+        TREX::utils::Symbol const &first;
+        /** @brief attribute variable */
+        Variable &second;
+      }; // TREX::transaction::Predicate::attribute_ref
+      
+      /** @brief Predicate attributes' iterator
+       *
+       * Iterate through the attributes of a predicate yielding an
+       * attribute_ref. As opposed to a plain @c attr_set iterator the
+       * name of the attribute cannot be modified.
+       */
+      class iterator
+      :public boost::iterator_facade<iterator, attr_set::value_type,
+                                     std::random_access_iterator_tag,
+                                     attribute_ref> {
+      public:
+        iterator() {}
+        
+        operator const_iterator() const {
+          return m_pos;
+        }
+        
+        friend bool operator==(iterator const &a, iterator const &b) {
+          return a.m_pos==b.m_pos;
+        }
+        friend bool operator!=(iterator const &a, iterator const &b) {
+          return a.m_pos!=b.m_pos;
+        }
+        friend bool operator==(iterator const &a, const_iterator const &b) {
+          return const_iterator(a.m_pos)==b;
+        }
+        friend bool operator==(const_iterator const &a, iterator const &b) {
+          return a==const_iterator(b.m_pos);
+        }
+        friend bool operator!=(iterator const &a, const_iterator const &b) {
+          return !(a==b);
+        }
+        friend bool operator!=(const_iterator const &a, iterator const &b) {
+          return !(a==b);
+        }
+        
+      private:
+        explicit iterator(attr_set::iterator const &pos):m_pos(pos) {}
+        
+        attribute_ref dereference() const {
+          return attribute_ref(*m_pos);
+        }
+        bool equal(iterator const &other) const {
+          return m_pos==other.m_pos;
+        }
+        void increment() {
+          ++m_pos;
+        }
+        void decrement() {
+          --m_pos;
+        }
+        void advance(difference_type n) {
+          m_pos += n;
+        }
+        difference_type distance_to(iterator const &other) const {
+          return other.m_pos-m_pos;
+        }
+        
+        attr_set::iterator m_pos;
+        
+        friend class Predicate;
+        friend class boost::iterator_core_access;
+      }; // TREX::transaction::Predicate::iterator
+      
       
       static utils::Symbol const &undefined_pred();
       static utils::Symbol const &failed_pred();
@@ -148,7 +234,7 @@ namespace TREX {
        * @sa iterator end()
        */
       iterator begin() {
-        return m_vars.begin();
+        return iterator(m_vars.begin());
       }
       /** @brief end of the attributes set
        *
@@ -160,7 +246,7 @@ namespace TREX {
        * @sa iterator begin()
        */
       iterator end() {
-        return m_vars.end();
+        return iterator(m_vars.end());
       }
       /** @brief beginning of the attributes set
        *
@@ -230,7 +316,7 @@ namespace TREX {
        * @sa Variable const &getAttribute(TREX::utils::Symbol const &) const
        */
       bool hasAttribute(TREX::utils::Symbol const &name) const {
-        return end()!=m_vars.find(name);
+        return end()!=find(name);
       }
       /** @brief Attribute access
        * @param name The name of an attribute
@@ -298,6 +384,17 @@ namespace TREX {
       }
       
       boost::property_tree::ptree as_tree(bool all) const;
+      /** @brief json content
+       *
+       * @param[in,out] out A json writer
+       * @param[in] all Output all the attributes
+       *
+       * Write into @p out the json object describing this predicate. 
+       * This is the same document as the content of as_tree(all), 
+       * excluding the predicate tag, but produced without building a 
+       * property tree.
+       */
+      void json_content(TREX::utils::json_writer &out, bool all) const;
       
       /** @brief XML output
        * @param out An output stream
@@ -396,7 +493,37 @@ namespace TREX {
        * @retval end() if the attribute @e name is not found
        */
       iterator find(TREX::utils::Symbol const &name) {
-        return m_vars.find(name);
+        iterator pos = lower_bound(name);
+        if( end()!=pos && name==pos->first )
+          return pos;
+        return end();
+      }
+      /** @brief Search for attribute
+       * @param name Attribute name
+       *
+       * This method search for attribute @e name
+       * @retval An iterator pointing to the attribute @e name if it exists
+       * @retval end() if the attribute @e name is not found
+       */
+      const_iterator find(TREX::utils::Symbol const &name) const {
+        const_iterator pos = lower_bound(name);
+        if( end()!=pos && name==pos->first )
+          return pos;
+        return end();
+      }
+      /** @brief Attribute position
+       * @param name Attribute name
+       *
+       * @return An iterator to the first attribute which name is not 
+       *         less than @p name
+       */
+      iterator lower_bound(TREX::utils::Symbol const &name) {
+        return iterator(std::lower_bound(m_vars.begin(), m_vars.end(), name,
+                                         attr_less()));
+      }
+      const_iterator lower_bound(TREX::utils::Symbol const &name) const {
+        return std::lower_bound(m_vars.begin(), m_vars.end(), name, 
+                                attr_less());
       }
       /** @brief removce an attribute
        * @param i An iterator
@@ -404,7 +531,7 @@ namespace TREX {
        * remove the attribute pointed by @e i
        */
       void remove(iterator const &i) {
-        m_vars.erase(i);
+        m_vars.erase(i.m_pos);
       }
       
       /** @brief XML tag name
@@ -422,8 +549,16 @@ namespace TREX {
                                utils::Symbol const &name,
                                bool &first) const;
       virtual std::ostream &print_to(std::ostream &out) const;
+      void json_value(TREX::utils::json_writer &out) const;
       
     private:
+      struct attr_less {
+        bool operator()(attr_set::value_type const &a,
+                        TREX::utils::Symbol const &b) const {
+          return a.first<b;
+        }
+      };
+      
       /** @brief object name */
       TREX::utils::Symbol m_object;
       /** @brief predicate type */
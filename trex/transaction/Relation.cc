@@ -57,11 +57,11 @@ utils::Symbol const timeline::s_failed(Predicate::failed_pred());
 
 timeline::timeline(TICK date, utils::Symbol const &name)
   :m_name(name), m_owner(NULL), m_plan_listeners(0),
-   m_last_obs(Observation(name, Predicate::failed_pred())), m_obs_date(date), m_shouldPrint(false) {}
+   m_last_obs(MAKE_SHARED<Observation>(name, Predicate::failed_pred())), m_obs_date(date), m_shouldPrint(false) {}
 
 timeline::timeline(TICK date, utils::Symbol const &name, TeleoReactor &serv, transaction_flags const &flags)
   :m_name(name), m_owner(&serv), m_transactions(flags), m_plan_listeners(0), 
-   m_last_obs(Observation(name, Predicate::failed_pred())), m_obs_date(date), m_shouldPrint(false)  {}
+   m_last_obs(MAKE_SHARED<Observation>(name, Predicate::failed_pred())), m_obs_date(date), m_shouldPrint(false)  {}
 
 timeline::~timeline() {
   // maybe some clean-up to do (?)
@@ -176,7 +176,7 @@ void timeline::unsubscribe(Relation const &rel) {
   m_clients.erase(rel.m_pos);
 }
 
-void timeline::postObservation(Observation const &obs,
+void timeline::postObservation(observation_id const &obs,
 			       bool verbose) {
   verbose = verbose || ( owned() && owner().is_verbose() );
 
@@ -194,6 +194,9 @@ void timeline::synchronize(TICK date) {
     m_last_obs = m_next_obs;
     m_obs_date = date;
     m_next_obs.reset();
+    // wake up the clients waiting for this observation
+    for(client_set::iterator i=m_clients.begin(); m_clients.end()!=i; ++i)
+      i->first->wakeup();
     if( owned() )
       owner().syslog(name(), TeleoReactor::obs)<<(*m_last_obs);
     else {
@@ -341,6 +344,10 @@ Observation const &Relation::lastObservation() const {
   return m_timeline->lastObservation();
 }
 
+observation_id const &Relation::lastObservationId() const {
+  return m_timeline->lastObservationId();
+}
+
 utils::Symbol const &Relation::name() const {
   return m_timeline->name();
 }
@@ -281,6 +281,17 @@ namespace TREX {
        * @sa details::timeline::lastObservation() const
        */
       Observation const &lastObservation() const; 
+      /** @brief Last observation
+       *
+       * @pre the relation is valid
+       *
+       * @return the shared instance of the last observation for this 
+       *         timeline
+       *
+       * @sa Relation::lastObservation() const
+       * @sa details::timeline::lastObservationId() const
+       */
+      observation_id const &lastObservationId() const;
 
       /** @brief client for this relation
        *
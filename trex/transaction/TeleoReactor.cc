@@ -43,6 +43,7 @@
 // #include <boost/chrono/clock_string.hpp>
 
 #include "TeleoReactor.hh"
+#include "bits/binary_log.hh"
 #include <trex/domain/FloatDomain.hh>
 
 #include <boost/scope_exit.hpp>
@@ -57,7 +58,8 @@ namespace TREX {
     
     class TeleoReactor::Logger {
     public:
-      Logger(std::string const &dest, boost::asio::io_service &io);
+      Logger(std::string const &dest, boost::asio::io_service &io,
+             bool binary=false);
       ~Logger();
       
       void provide(Symbol const &name, bool goals, bool plan);
@@ -75,7 +77,7 @@ namespace TREX {
       void work(bool ret);
       void step();
       
-      void observation(Observation const &obs);
+      void observation(observation_id const &obs);
       void request(goal_id const &goal);
       void recall(goal_id const &goal);
       
@@ -111,7 +113,7 @@ namespace TREX {
       tick_phase m_phase;
       TICK m_current;
       
-      void obs(Observation o);
+      void obs(observation_id o);
       void goal_event(std::string tag, goal_id g, bool full);
       
       void post_event(boost::function<void ()> fn);
@@ -125,13 +127,38 @@ namespace TREX {
       void set_tick(TICK val, tick_phase p);
       void set_phase(tick_phase p);
       void direct_write(std::string const &content, bool nl);
+      void terminate();
       
+      // binary format
+      typedef details::binary_log::record_type record_type;
+      typedef details::binary_log::encoder     encoder;
+      
+      bool m_binary;
+      std::map<std::string, boost::uint32_t> m_symbols;
+      utils::async_ofstream  m_index;
+      boost::uint64_t        m_offset;
+      
+      boost::uint32_t intern(std::string const &str);
+      void index_write(encoder const &content);
+      void bin_record(record_type type, encoder const &payload);
+      void bin_predicate(encoder &out, Predicate const &pred);
+      void bin_tl(record_type type, Symbol name, bool goals, bool plan,
+                  bool flags);
+      void bin_obs(observation_id o);
+      void bin_goal(record_type type, goal_id g, bool full);
     };
     
   }
 }
 
-
+namespace {
+  
+  utils::log::format const
+  fmt_pending("%1% added %2%[%3%] to the pending queue of %4%");
+  utils::log::format const 
+  fmt_dispatch("Dispatching %1%[%2%] on \"%3%\".");
+  
+}
 
 using namespace TREX::transaction;
 
@@ -160,19 +187,103 @@ std::string DispatchError::build_msg(goal_id const &g, std::string const &msg) t
 
 
 /*
- * class TREX::transaction::details::external
+ * class TREX::transaction::details::goal_queue
  */
 
-bool TREX::transaction::details::external::cmp_goals(IntegerDomain const &a, IntegerDomain const &b) {
+// structors
+
+details::goal_queue::goal_queue(details::goal_queue const &other) {
+  *this = other;
+}
+
+// modifiers
+
+details::goal_queue &details::goal_queue::operator= (details::goal_queue const &other) {
+  if( &other!=this ) {
+    for(index_type::const_iterator i=m_index.begin(); m_index.end()!=i; ++i)
+      if( i->second.scheduled )
+        m_wheel.erase(i->second.timer);
+    m_queue.clear();
+    m_index.clear();
+    // Rebuild the index as it refers to this queue iterators and wheel 
+    // handles
+    for(index_type::const_iterator i=other.m_index.begin();
+        other.m_index.end()!=i; ++i) {
+      value_type const &v(i->second.scheduled?other.m_wheel.get(i->second.timer)
+                          :i->second.pos->second);
+      insert(v.first, v.second);
+    }
+  }
+  return *this;
+}
+
+bool details::goal_queue::insert(goal_id const &g, bool ok) {
+  index_type::iterator i = m_index.find(g.get());
+
+  if( m_index.end()!=i )
+    return false;
+  
+  IntegerDomain const &start(g->getStart());
+  
+  if( start.hasLower() && start.lowerBound().value()>=m_wheel.now() ) {
+    // not yet within reach : wait in the wheel
+    m_index.insert(index_type::value_type(g.get(),
+                                          m_wheel.insert(start.lowerBound().value(),
+                                                         value_type(g, ok))));
+  } else 
+    enqueue(value_type(g, ok));
+  return true;
+}
+
+details::goal_queue::iterator details::goal_queue::enqueue(details::goal_queue::value_type const &v) {
+  IntegerDomain const &start(v.first->getStart());
   // sorting order
   //   - based on upperBound
   //   - if same upperBound : sorted based on lower bound
   //
   // this way I can safely update lower bounds without impacting tokens order
-  return a.upperBound()<b.upperBound() ||
-    ( a.upperBound()==b.upperBound() && a.lowerBound()<b.lowerBound() );
+  iterator pos = m_queue.insert(std::make_pair(key_type(start.upperBound(),
+                                                        start.lowerBound()),
+                                               v));
+  std::pair<index_type::iterator, bool>
+    ret = m_index.insert(index_type::value_type(v.first.get(), pos));
+  if( !ret.second )
+    ret.first->second = position(pos);
+  return pos;
+}
+
+size_t details::goal_queue::advance(TICK horizon) {
+  std::list<value_type> due;
+  
+  m_wheel.advance(horizon, due);
+  for(std::list<value_type>::const_iterator i=due.begin(); due.end()!=i; ++i)
+    enqueue(*i);
+  return due.size();
 }
 
+bool details::goal_queue::erase(goal_id const &g) {
+  index_type::iterator i = m_index.find(g.get());
+
+  if( m_index.end()!=i ) {
+    if( i->second.scheduled )
+      m_wheel.erase(i->second.timer);
+    else
+      m_queue.erase(i->second.pos);
+    m_index.erase(i);
+    return true;
+  }
+  return false;
+}
+
+details::goal_queue::iterator details::goal_queue::erase(details::goal_queue::iterator i) {
+  m_index.erase(i->second.first.get());
+  m_queue.erase(i++);
+  return i;
+}
+
+/*
+ * class TREX::transaction::details::external
+ */
 
 // structors
 
@@ -187,54 +298,41 @@ TREX::transaction::details::external::external(details::external_set::iterator c
                                                details::external_set::iterator const &last)
   :m_pos(pos), m_last(last) {}
 
-// manipulators
-
-details::goal_queue::iterator details::external::lower_bound(IntegerDomain const &dom) {
-  details::goal_queue::iterator i = m_pos->second.begin();
-
-  for(; m_pos->second.end()!=i && cmp_goals(i->first->getStart(), dom); ++i);
-  return i;
-}
-
 // modifiers
 
 bool details::external::post_goal(goal_id const &g) {
-  IntegerDomain const &g_start(g->getStart());
-  // locate goal position
-  details::goal_queue::iterator i = lower_bound(g_start);
-
-  // check that it is not already posted
-  for( ; m_pos->second.end()!=i && !cmp_goals(g_start, i->first->getStart()); ++i)
-    if( g==i->first )
-      return false;
-  // insert the new goal
-  m_pos->second.insert(i, std::make_pair(g, true));
+  // insert the new goal unless already posted
+  if( !m_pos->second.insert(g) )
+    return false;
   if( m_pos->first.client().is_verbose() ) {
-    syslog(info)<<m_pos->first.client().getName()
-      <<" added "<<g->predicate()<<'['<<g<<"] to the pending queue of "
-      <<m_pos->first.name();
+    record(fmt_pending, info)<<m_pos->first.client().getName()
+      <<g->predicate()<<g.get()<<m_pos->first.name();
   }
   return true;
 }
 
-void details::external::dispatch(TICK current, details::goal_queue &sent) {
-  details::goal_queue::iterator i=m_pos->second.begin();
+void details::external::dispatch(TICK current, std::list<goal_id> &sent) {
   IntegerDomain dispatch_w = m_pos->first.dispatch_window(current);
+  // bring in the goals that may now start within the dispatch window
+  m_pos->second.advance(dispatch_w.upperBound().value());
+  details::goal_queue::iterator i=m_pos->second.begin();
 
-  for( ; m_pos->second.end()!=i && i->first->startsBefore(dispatch_w.upperBound());  ) {
-    bool future = i->first->startsAfter(current);
+  for( ; m_pos->second.end()!=i && 
+         i->second.first->startsBefore(dispatch_w.upperBound());  ) {
+    goal_id const &g = i->second.first;
+    bool future = g->startsAfter(current);
 
-    if( future || i->first->endsAfter(current+1) ) {
+    if( future || g->endsAfter(current+1) ) {
       // Need to check for dispatching
-        if( i->second && m_pos->first.accept_goals() ) {
+        if( i->second.second && m_pos->first.accept_goals() ) {
           if( m_pos->first.client().is_verbose() )
-            syslog(info)<<"Dispatching "<<i->first->predicate()
-                        <<'['<<(i->first)<<"] on \""
-                        <<m_pos->first.name()<<"\".";
+            record(fmt_dispatch, info)<<g->predicate()<<g.get()
+                                      <<m_pos->first.name();
           bool posted = false;
           try {
-            m_pos->first.request(i->first);
+            m_pos->first.request(g);
             posted = true;
+            sent.push_back(g);
             i = m_pos->second.erase(i);
           } catch(utils::Exception const &e) {
             syslog(warn)<<"Exception received while sending request: "<<e;
@@ -246,13 +344,13 @@ void details::external::dispatch(TICK current, details::goal_queue &sent) {
           }
           if( !posted ) {
             syslog(warn)<<"Marking goal as non-postable.";
-            i->second = false;
+            i->second.second = false;
           }
         } else
           ++i;
     } else if( !future ) {
-      syslog(warn)<<"Goal "<<i->first->predicate()<<'['<<(i->first)
-                  <<"] is in the past: removing it\n\t"<<(*(i->first));
+      syslog(warn)<<"Goal "<<g->predicate()<<'['<<g
+                  <<"] is in the past: removing it\n\t"<<(*g);
       i = m_pos->second.erase(i);
     } else if( !m_pos->first.accept_goals() )
       break; // no need to  look further ... this guy do not accept goals
@@ -263,23 +361,15 @@ void details::external::unblock() {
   // just mark all the 
   for(details::goal_queue::iterator i=m_pos->second.begin();
       m_pos->second.end()!=i; ++i) 
-    i->second = true;
+    i->second.second = true;
 }
 
 void details::external::recall(goal_id const &g) {
-  IntegerDomain const &g_start(g->getStart());
-  // locate goal position
-  details::goal_queue::iterator i = lower_bound(g_start);
-  for( ; m_pos->second.end()!=i && !cmp_goals(g_start, i->first->getStart()); 
-       ++i) {
-    if( g==i->first ) {
-      // was still pending => just remove it
-      m_pos->second.erase(i);
-      return;
-    }
+  // was still pending => just remove it
+  if( !m_pos->second.erase(g) ) {
+    // not found => send a recall
+    m_pos->first.recall(g);
   }
-  // not found => send a recall
-  m_pos->first.recall(g);
 }
 
 void details::external::increment() {
@@ -301,6 +391,11 @@ TREX::utils::log::stream details::external::syslog(utils::Symbol const &kind) {
   return m_pos->first.client().syslog(m_pos->first.name(), kind);
 }
 
+TREX::utils::log::record details::external::record(utils::log::format const &fmt,
+                                                   utils::Symbol const &kind) {
+  return m_pos->first.client().record(fmt, m_pos->first.name(), kind);
+}
+
 Relation const &details::external::dereference() const {
   return *(m_pos->first);
 }
@@ -311,6 +406,18 @@ Relation const &details::external::dereference() const {
 
 utils::Symbol const TeleoReactor::obs("ASSERT");
 utils::Symbol const TeleoReactor::plan("PLAN");
+utils::Symbol const TeleoReactor::dedicated_executor("dedicated");
+
+utils::Symbol const &TeleoReactor::phase_name(TeleoReactor::latency_phase p) {
+  static utils::Symbol const names[nb_phases] = {
+    utils::Symbol("handleTickStart"),
+    utils::Symbol("dispatch"),
+    utils::Symbol("notify"),
+    utils::Symbol("synchronize"),
+    utils::Symbol("step")
+  };
+  return names[p];
+}
 
 
 // structors
@@ -318,9 +425,13 @@ utils::Symbol const TeleoReactor::plan("PLAN");
 TeleoReactor::TeleoReactor(TeleoReactor::xml_arg_type &arg, bool loadTL,
                            bool log_default)
   :m_inited(false), m_firstTick(true), m_graph(*(arg.second)),
-   m_have_goals(0),
+   m_have_goals(0), m_mailbox(NULL),
    m_verbose(utils::parse_attr<bool>(arg.second->is_verbose(),
                                      xml_factory::node(arg), "verbose")),
+   m_event_driven(utils::parse_attr<bool>(false, xml_factory::node(arg),
+                                          "event_driven")),
+   m_executor(utils::parse_attr<Symbol>(Symbol(), xml_factory::node(arg),
+                                        "executor")),
    m_trLog(NULL),
    m_name(utils::parse_attr<Symbol>(xml_factory::node(arg), "name")),
    m_latency(utils::parse_attr<TICK>(xml_factory::node(arg), "latency")),
@@ -330,14 +441,34 @@ TeleoReactor::TeleoReactor(TeleoReactor::xml_arg_type &arg, bool loadTL,
    m_stat_log(m_log->service()) {
   boost::property_tree::ptree::value_type &node(xml_factory::node(arg));
 
+  try {
+    m_placement.cpus(utils::parse_attr<std::string>("", node, "cpus"));
+  } catch(utils::Exception const &e) {
+    throw utils::XmlError(node, e.what());
+  }
+  boost::optional<int> nice = utils::parse_attr< boost::optional<int> >(node, "nice");
+  if( nice )
+    m_placement.nice(*nice);
+  if( dedicated_executor!=m_executor && !m_placement.empty() )
+    syslog(warn)<<"cpus and nice attributes are ignored as this reactor"
+                <<" does not run on a dedicated executor.";
+
   utils::LogManager::path_type fname = file_name("stat.csv");
   m_stat_log.open(fname.c_str());
   m_stat_log<<"tick, tick_ns, tick_rt_ns, synch_ns, synch_rt_ns, delib_ns, delib_rt_ns, n_steps\n";
+  init_latency();
      
   if( utils::parse_attr<bool>(log_default, node, "log") ) {
-    std::string base = getName().str()+".tr.log";
+    std::string format = utils::parse_attr<std::string>("xml", node,
+                                                        "log_format");
+    bool binary = ("binary"==format);
+    
+    if( !binary && "xml"!=format )
+      throw utils::XmlError(node, "Unknown log_format \""+format+"\"");
+    
+    std::string base = getName().str()+(binary?".tr.bin":".tr.log");
     fname = manager().file_name(base);
-    m_trLog = new Logger(fname.string(), manager().service());
+    m_trLog = new Logger(fname.string(), manager().service(), binary);
     utils::LogManager::path_type cfg = manager().file_name("cfg"), 
       pwd = boost::filesystem::current_path(), 
       short_name(base), location("../"+base);
@@ -375,12 +506,14 @@ TeleoReactor::TeleoReactor(TeleoReactor::xml_arg_type &arg, bool loadTL,
 TeleoReactor::TeleoReactor(graph *owner, Symbol const &name,
                            TICK latency, TICK lookahead, bool log)
   :m_inited(false), m_firstTick(true), m_graph(*owner),
-   m_have_goals(0),
-   m_verbose(owner->is_verbose()), m_trLog(NULL), m_name(name),
+   m_have_goals(0), m_mailbox(NULL),
+   m_verbose(owner->is_verbose()), m_event_driven(false), m_trLog(NULL),
+   m_name(name),
    m_latency(latency), m_maxDelay(0), m_lookahead(lookahead),
    m_nSteps(0), m_stat_log(m_log->service()) {
   utils::LogManager::path_type fname = file_name("stat.csv");
   m_stat_log.open(fname.string());
+  init_latency();
      
   if( log ) {
     fname = manager().file_name(getName().str()+".tr.log");
@@ -390,8 +523,23 @@ TeleoReactor::TeleoReactor(graph *owner, Symbol const &name,
   }
 }
 
+void TeleoReactor::init_latency() {
+  utils::latency_registry &reg = m_graph.latency();
+  
+  for(int p=0; p<nb_phases; ++p)
+    m_phase_latency[p] = reg.get(getName(),
+                                 phase_name(static_cast<latency_phase>(p)));
+}
+
 TeleoReactor::~TeleoReactor() {
   isolate(false);
+  // discard the transactions that were never applied
+  for(mail *m=m_mailbox.exchange(NULL, ATOMIC_NS::memory_order_acquire); 
+      NULL!=m; ) {
+    mail *next = m->next;
+    delete m;
+    m = next;
+  }
   if( !m_firstTick ) {
     m_stat_log<<", "<<m_deliberation_usage.count()
               <<", "<<m_delib_rt.count()
@@ -475,6 +623,12 @@ void TeleoReactor::queue(std::list<goal_id> &l, goal_id g) {
     *m_have_goals += 1;
   }
   l.push_back(g);
+  wakeup();
+}
+
+void TeleoReactor::wakeup() {
+  if( m_event_driven )
+    m_graph.wakeup(this);
 }
 
 
@@ -548,6 +702,8 @@ double TeleoReactor::workRatio() {
     }
   }
   
+  flush_mailbox();
+  
   bool ret = false;
   
   if( NULL!=m_trLog )
@@ -576,7 +732,7 @@ double TeleoReactor::workRatio() {
     } else {
       // Dispatched goals management
       details::external i = ext_begin();
-      details::goal_queue dispatched; // store the goals that got dispatched 
+      std::list<goal_id> dispatched; // store the goals that got dispatched 
                                       // on this tick ...
                                       // I do nothing with it for now
       
@@ -600,22 +756,33 @@ double TeleoReactor::workRatio() {
   return NAN;
 }
 
-void TeleoReactor::observation_sync(Observation o, bool verbose) {
-  internal_set::iterator i = m_internals.find(o.object());
+void TeleoReactor::observation_sync(observation_id o, bool verbose) {
+  internal_set::iterator i = m_internals.find(o->object());
   
   if( m_internals.end()==i )
     throw boost::enable_current_exception(SynchronizationError(*this, "attempted to post observation on "+
-                               o.object().str()+" which is not Internal."));
+                               o->object().str()+" which is not Internal."));
   
   (*i)->postObservation(o, verbose);
   m_updates.insert(*i);
 }
 
 void TeleoReactor::postObservation(Observation const &obs, bool verbose) {
-  boost::function<void ()> fn(boost::bind(&TeleoReactor::observation_sync,
-                                          this, obs, verbose));
-  // m_graph.strand().dispatch(fn);
-  utils::strand_run(m_graph.strand(), fn);
+  postObservation(MAKE_SHARED<Observation>(obs), verbose);
+}
+
+void TeleoReactor::postObservation(observation_id const &obs, bool verbose) {
+  if( !obs )
+    throw SynchronizationError(*this, "Invalid observation Id");
+  {
+    utils::SharedVar< std::set<utils::Symbol> >::scoped_lock 
+      lock(m_internal_names);
+    if( m_internal_names->end()==m_internal_names->find(obs->object()) )
+      throw SynchronizationError(*this, "attempted to post observation on "+
+                                 obs->object().str()+" which is not Internal.");
+  }
+  post_transaction(boost::bind(&TeleoReactor::observation_sync,
+                               this, obs, verbose));
 }
 
 bool TeleoReactor::goal_sync(goal_id g) {
@@ -638,6 +805,31 @@ bool TeleoReactor::postGoal(goal_id const &g) {
   return utils::strand_run(m_graph.strand(), fn);
 }
 
+size_t TeleoReactor::goals_sync(std::list<goal_id> const &goals) {
+  size_t ret = 0;
+  
+  for(std::list<goal_id>::const_iterator i=goals.begin(); goals.end()!=i; ++i) {
+    if( *i ) {
+      details::external tl(m_externals.find((*i)->object()), m_externals.end());
+      if( tl.valid() ) {
+        if( NULL!=m_trLog )
+          m_trLog->request(*i);
+        if( tl.post_goal(*i) )
+          ++ret;
+      }
+    }
+  }
+  return ret;
+}
+
+size_t TeleoReactor::postGoals(std::list<goal_id> const &goals) {
+  if( goals.empty() )
+    return 0;
+  boost::function<size_t ()> fn(boost::bind(&TeleoReactor::goals_sync,
+                                            this, boost::cref(goals)));
+  return utils::strand_run(m_graph.strand(), fn);
+}
+
 goal_id TeleoReactor::postGoal(Goal const &g) {
   goal_id tmp(new Goal(g));
 
@@ -675,7 +867,8 @@ bool TeleoReactor::postRecall(goal_id const &g) {
 }
 
 bool TeleoReactor::plan_sync(goal_id t) {
-  
+  // apply pending transactions first to preserve their order
+  mailbox_sync();
   // Look for the internal timeline
   internal_set::const_iterator tl = m_internals.find(t->object());
   if( m_internals.end()==tl )
@@ -718,11 +911,55 @@ goal_id TeleoReactor::postPlanToken(Goal const &g) {
 }
 
 void TeleoReactor::cancelPlanToken(goal_id const &g) {
-  if( g ) {
-    boost::function<void ()> fn(boost::bind(&TeleoReactor::cancel_sync,
-                                            this, g));
-    utils::strand_run(m_graph.strand(), fn);
+  if( g )
+    post_transaction(boost::bind(&TeleoReactor::cancel_sync, this, g));
+}
+
+void TeleoReactor::post_transaction(TeleoReactor::transaction_fn const &fn) {
+  mail *m = new mail(fn);
+  
+  m->next = m_mailbox.load(ATOMIC_NS::memory_order_relaxed);
+  while( !m_mailbox.compare_exchange_weak(m->next, m,
+                                          ATOMIC_NS::memory_order_release,
+                                          ATOMIC_NS::memory_order_relaxed) );
+}
+
+void TeleoReactor::mailbox_sync() {
+  mailbox_type batch;
+  mail *m = m_mailbox.exchange(NULL, ATOMIC_NS::memory_order_acquire);
+  
+  // The mailbox is a stack : restore the posting order
+  while( NULL!=m ) {
+    mail *next = m->next;
+    batch.push_front(transaction_fn());
+    batch.front().swap(m->fn);
+    delete m;
+    m = next;
   }
+  m_pending.splice(m_pending.end(), batch);
+  while( !m_pending.empty() ) {
+    transaction_fn fn;
+    
+    fn.swap(m_pending.front());
+    m_pending.pop_front();
+    // an exception is propagated to the caller as it would have been if 
+    // the transaction was applied directly : the transactions left are
+    // applied on next call
+    fn();
+  }
+}
+
+void TeleoReactor::flush_mailbox() {
+  if( NULL==m_mailbox.load(ATOMIC_NS::memory_order_acquire) )
+    return;
+  boost::function<void ()> fn(boost::bind(&TeleoReactor::mailbox_sync, this));
+  utils::strand_run(m_graph.strand(), fn);
+}
+
+void TeleoReactor::updates_sync(TICK date) {
+  mailbox_sync();
+  for(internal_set::iterator i=m_updates.begin(); m_updates.end()!=i; ++i)
+    (*i)->synchronize(date);
 }
 
 
@@ -841,15 +1078,21 @@ bool TeleoReactor::newTick() {
     
       handleTickStart(); // allow derived class processing
     }
+    m_phase_latency[phase_tick_start]->record(m_start_rt);
 
     // Dispatched goals management
     details::external i = ext_begin();
-    details::goal_queue dispatched; // store the goals that got dispatched on this tick ...
+    std::list<goal_id> dispatched; // store the goals that got dispatched on this tick ...
                                     // I do nothing with it for now
     
     // Manage goal dispatching
-    for( ; i.valid(); ++i )
-      i.dispatch(getCurrentTick(), dispatched);
+    rt_clock::duration dispatch_rt;
+    {
+      utils::chronograph<rt_clock> rt_chron(dispatch_rt);
+      for( ; i.valid(); ++i )
+        i.dispatch(getCurrentTick(), dispatched);
+    }
+    m_phase_latency[phase_dispatch]->record(dispatch_rt);
     return true;
   } catch(TREX::utils::Exception const &e) {
     syslog(error)<<"Exception caught during new tick:\n"<<e;
@@ -861,13 +1104,13 @@ bool TeleoReactor::newTick() {
   return false;
 }
 
-void TeleoReactor::collect_obs_sync(std::list<Observation> &l) {
+void TeleoReactor::collect_obs_sync(std::list<observation_id> &l) {
   for(external_set::iterator i = m_externals.begin();
       m_externals.end()!=i; ++i) {
     // syslog(info)<<"Checking for new observation on "<<i->first.name();
     if( i->first.lastObsDate()==getCurrentTick() ) {
       // syslog(info)<<"Collecting new obs: "<<i->first.lastObservation();
-      l.push_back( i->first.lastObservation() );
+      l.push_back( i->first.lastObservationId() );
     } //else
      // syslog(info)<<"Last observation date ("<<i->first.lastObsDate()<<") is before current tick";
   }
@@ -876,14 +1119,20 @@ void TeleoReactor::collect_obs_sync(std::list<Observation> &l) {
 
 
 void TeleoReactor::doNotify() {
-  std::list<Observation> obs;
+  std::list<observation_id> obs;
   boost::function<void ()> fn(boost::bind(&TeleoReactor::collect_obs_sync,
                                           this, boost::ref(obs)));
   utils::strand_run(m_graph.strand(), fn);
-  for(std::list<Observation>::const_iterator i=obs.begin(); obs.end()!=i; ++i) {
-    // syslog("NOTIFY")<<(*i);
-    notify(*i);
+  
+  rt_clock::duration notify_rt;
+  {
+    utils::chronograph<rt_clock> rt_chron(notify_rt);
+    for(std::list<observation_id>::const_iterator i=obs.begin(); obs.end()!=i; ++i) {
+      // syslog("NOTIFY")<<(**i);
+      handleObservation(*i);
+    }
   }
+  m_phase_latency[phase_notify]->record(notify_rt);
 }
 
 
@@ -905,6 +1154,7 @@ bool TeleoReactor::doSynchronize() {
         utils::chronograph<stat_clock> usage(m_synch_usage);
         success = synchronize();
       }
+      m_phase_latency[phase_synchronize]->record(m_synch_rt);
       m_stat_log<<now<<", "<<m_start_usage.count()
       <<", "<<m_start_rt.count()
       <<", "<<m_synch_usage.count()
@@ -912,15 +1162,16 @@ bool TeleoReactor::doSynchronize() {
       stat_logged = true;
     }
     if( success ) {
+      // Apply the pending transactions and publish all the updated
+      // timelines in a single strand round-trip
+      boost::function<void ()> fn(boost::bind(&TeleoReactor::updates_sync,
+                                              this, now));
+      utils::strand_run(m_graph.strand(), fn);
+      
       for(internal_set::iterator i=m_updates.begin();
           m_updates.end()!=i; ++i) {
         bool echo;
-        
-        boost::function<void ()> fn(boost::bind(&details::timeline::synchronize,
-                                                *i, now));
-        utils::strand_run(m_graph.strand(), fn);
-
-        Observation const &observ = (*i)->lastObservation(echo);
+        observation_id const &observ = (*i)->lastObservation(echo);
         
         // if( echo || is_verbose() || NULL==m_trLog )
         //   syslog(obs)<<observ;
@@ -957,7 +1208,9 @@ void TeleoReactor::step() {
     utils::chronograph<rt_clock> rt_chron(delta_rt);
     utils::chronograph<stat_clock> stat_chron(delta);
     resume();
+    flush_mailbox();
   }
+  m_phase_latency[phase_step]->record(delta_rt);
   m_deliberation_usage += delta;
   m_delib_rt += delta_rt;
   m_nSteps += 1;
@@ -1077,6 +1330,11 @@ void TeleoReactor::clear_externals() {
 
 void TeleoReactor::assigned(details::timeline *tl) {
   m_internals.insert(tl);
+  {
+    utils::SharedVar< std::set<utils::Symbol> >::scoped_lock 
+      lock(m_internal_names);
+    m_internal_names->insert(tl->name());
+  }
   if( is_verbose() )
     syslog(null, info)<<"Declared \""<<tl->name()<<"\" with rights "<<tl->rights()<<".";
   if( NULL!=m_trLog ) {
@@ -1085,11 +1343,17 @@ void TeleoReactor::assigned(details::timeline *tl) {
   for(graph::listen_set::const_iterator i=m_graph.m_listeners.begin();
       m_graph.m_listeners.end()!=i; ++i)
     (*i)->declared(*tl);
+  m_graph.topology_changed();
 }
 
 void TeleoReactor::unassigned(details::timeline *tl) {
   internal_set::iterator i = m_internals.find(tl);
   m_internals.erase(i);
+  {
+    utils::SharedVar< std::set<utils::Symbol> >::scoped_lock 
+      lock(m_internal_names);
+    m_internal_names->erase(tl->name());
+  }
   if( is_verbose() )
     syslog(null, info)<<"Undeclared \""<<tl->name()<<"\".";
   if( NULL!=m_trLog ) {
@@ -1098,6 +1362,7 @@ void TeleoReactor::unassigned(details::timeline *tl) {
   for(graph::listen_set::const_iterator i=m_graph.m_listeners.begin();
       m_graph.m_listeners.end()!=i; ++i)
     (*i)->undeclared(*tl);
+  m_graph.topology_changed();
 }
 
 void TeleoReactor::subscribed(Relation const &r) {
@@ -1114,6 +1379,7 @@ void TeleoReactor::subscribed(Relation const &r) {
   for(graph::listen_set::const_iterator i=m_graph.m_listeners.begin();
       m_graph.m_listeners.end()!=i; ++i) 
     (*i)->connected(r);
+  m_graph.topology_changed();
 }
 
 void TeleoReactor::unsubscribed(Relation const &r) {
@@ -1134,6 +1400,7 @@ void TeleoReactor::unsubscribed(Relation const &r) {
   for(graph::listen_set::const_iterator i=m_graph.m_listeners.begin();
       m_graph.m_listeners.end()!=i; ++i) 
     (*i)->disconnected(r);
+  m_graph.topology_changed();
 }
 
 
@@ -1172,11 +1439,25 @@ void TeleoReactor::unblock(Symbol const &name) {
 
 // structors
 
-TeleoReactor::Logger::Logger(std::string const &dest, boost::asio::io_service &io)
-:m_strand(io), m_file(io, dest) {
+TeleoReactor::Logger::Logger(std::string const &dest, boost::asio::io_service &io,
+                             bool binary)
+:m_strand(io), m_file(io, dest), m_binary(binary), m_index(io),
+m_offset(0) {
   m_flags.set(header);
-  m_strand.post(boost::bind(&Logger::direct_write, this, "<Log>\n <header>",
-                            true));
+  if( m_binary ) {
+    std::string head(details::binary_log::magic,
+                     sizeof(details::binary_log::magic));
+    head.push_back(static_cast<char>(details::binary_log::version));
+    m_offset = head.length();
+    m_strand.post(boost::bind(&Logger::direct_write, this, head, false));
+    // Create the tick index along with the log
+    encoder idx;
+    details::binary_log::tick_index::encode_header(idx);
+    m_index.open(dest+".idx");
+    m_strand.post(boost::bind(&Logger::index_write, this, idx));
+  } else
+    m_strand.post(boost::bind(&Logger::direct_write, this, "<Log>\n <header>",
+                              true));
 }
 
 TeleoReactor::Logger::~Logger() {
@@ -1185,9 +1466,7 @@ TeleoReactor::Logger::~Logger() {
   
   m_strand.post(boost::bind(&Logger::close_tick, this));
   //std::cerr<<" - build task : close the main tag"<<std::endl;
-  boost::packaged_task<void> close_xml(boost::bind(&Logger::direct_write,
-                                                   this, "</Log>",
-                                                   true));
+  boost::packaged_task<void> close_xml(boost::bind(&Logger::terminate, this));
   //std::cerr<<" - get future of the task"<<std::endl;
   boost::unique_future<void> completed = close_xml.get_future();
   //std::cerr<<" - scedulled task execution"<<std::endl;
@@ -1197,13 +1476,21 @@ TeleoReactor::Logger::~Logger() {
   completed.wait();
   //std::cerr<<" - close the file"<<std::endl;
   m_file.close();
+  if( m_binary )
+    m_index.close();
 }
 
 // interface
 
 void TeleoReactor::Logger::comment(std::string const &msg) {
-  m_strand.post(boost::bind(&Logger::direct_write, this, "<!-- "+msg+" -->",
-                            true));
+  if( m_binary ) {
+    encoder payload;
+    payload.put_str(msg);
+    m_strand.post(boost::bind(&Logger::bin_record, this,
+                              details::binary_log::rec_comment, payload));
+  } else
+    m_strand.post(boost::bind(&Logger::direct_write, this, "<!-- "+msg+" -->",
+                              true));
 }
 
 void TeleoReactor::Logger::init(TICK val) {
@@ -1219,8 +1506,12 @@ void TeleoReactor::Logger::synchronize() {
 }
 
 void TeleoReactor::Logger::failed() {
-  post_event(boost::bind(&Logger::direct_write,
-                         this, "   <failed/>", true));
+  if( m_binary )
+    post_event(boost::bind(&Logger::bin_record, this,
+                           details::binary_log::rec_failed, encoder()));
+  else
+    post_event(boost::bind(&Logger::direct_write,
+                           this, "   <failed/>", true));
 }
 
 void TeleoReactor::Logger::has_work() {
@@ -1232,6 +1523,13 @@ void TeleoReactor::Logger::step() {
 }
 
 void TeleoReactor::Logger::work(bool ret) {
+  if( m_binary ) {
+    encoder payload;
+    payload.put_u8(ret);
+    post_event(boost::bind(&Logger::bin_record, this,
+                           details::binary_log::rec_work, payload));
+    return;
+  }
   std::ostringstream oss;
   oss<<"   <work value=\""<<ret<<"\" />";
   post_event(boost::bind(&Logger::direct_write,
@@ -1239,6 +1537,11 @@ void TeleoReactor::Logger::work(bool ret) {
 }
 
 void TeleoReactor::Logger::provide(Symbol const &name, bool goals, bool plan) {
+  if( m_binary ) {
+    post_event(boost::bind(&Logger::bin_tl, this,
+                           details::binary_log::rec_provide, name, goals, plan, true));
+    return;
+  }
   std::ostringstream oss;
   oss<<"   <provide name=\""<<name
   <<"\" goals=\""<<goals
@@ -1248,6 +1551,11 @@ void TeleoReactor::Logger::provide(Symbol const &name, bool goals, bool plan) {
 }
 
 void TeleoReactor::Logger::unprovide(Symbol const &name) {
+  if( m_binary ) {
+    post_event(boost::bind(&Logger::bin_tl, this,
+                           details::binary_log::rec_unprovide, name, false, false, false));
+    return;
+  }
   std::ostringstream oss;
   oss<<"   <unprovide name=\""<<name<<"\" />";
   post_event(boost::bind(&Logger::direct_write,
@@ -1255,6 +1563,11 @@ void TeleoReactor::Logger::unprovide(Symbol const &name) {
 }
 
 void TeleoReactor::Logger::use(Symbol const &name, bool goals, bool plan) {
+  if( m_binary ) {
+    post_event(boost::bind(&Logger::bin_tl, this,
+                           details::binary_log::rec_use, name, goals, plan, true));
+    return;
+  }
   std::ostringstream oss;
   oss<<"   <use name=\""<<name
   <<"\" goals=\""<<goals
@@ -1264,6 +1577,11 @@ void TeleoReactor::Logger::use(Symbol const &name, bool goals, bool plan) {
 }
 
 void TeleoReactor::Logger::unuse(Symbol const &name) {
+  if( m_binary ) {
+    post_event(boost::bind(&Logger::bin_tl, this,
+                           details::binary_log::rec_unuse, name, false, false, false));
+    return;
+  }
   std::ostringstream oss;
   oss<<"   <unuse name=\""<<name<<"\" />";
   post_event(boost::bind(&Logger::direct_write,
@@ -1271,6 +1589,13 @@ void TeleoReactor::Logger::unuse(Symbol const &name) {
 }
 
 void TeleoReactor::Logger::latency_updated(TICK val) {
+  if( m_binary ) {
+    encoder payload;
+    payload.put_i64(val);
+    post_event(boost::bind(&Logger::bin_record, this,
+                           details::binary_log::rec_latency, payload));
+    return;
+  }
   std::ostringstream oss;
   oss<<"   <latency value=\""<<val<<"\"/>";
   post_event(boost::bind(&Logger::direct_write,
@@ -1278,6 +1603,13 @@ void TeleoReactor::Logger::latency_updated(TICK val) {
 }
 
 void TeleoReactor::Logger::horizon_updated(TICK val) {
+  if( m_binary ) {
+    encoder payload;
+    payload.put_i64(val);
+    post_event(boost::bind(&Logger::bin_record, this,
+                           details::binary_log::rec_horizon, payload));
+    return;
+  }
   std::ostringstream oss;
   oss<<"   <horizon value=\""<<val<<"\"/>";
   post_event(boost::bind(&Logger::direct_write,
@@ -1285,32 +1617,51 @@ void TeleoReactor::Logger::horizon_updated(TICK val) {
 }
 
 
-void TeleoReactor::Logger::observation(Observation const &o) {
-  post_event(boost::bind(&Logger::obs, this, o));
+void TeleoReactor::Logger::observation(observation_id const &o) {
+  if( m_binary )
+    post_event(boost::bind(&Logger::bin_obs, this, o));
+  else
+    post_event(boost::bind(&Logger::obs, this, o));
 }
 
 void TeleoReactor::Logger::request(goal_id const &goal) {
-  post_event(boost::bind(&Logger::goal_event, this, "request", goal, true));
+  if( m_binary )
+    post_event(boost::bind(&Logger::bin_goal, this,
+                           details::binary_log::rec_request, goal, true));
+  else
+    post_event(boost::bind(&Logger::goal_event, this, "request", goal, true));
 }
 
 void TeleoReactor::Logger::recall(goal_id const &goal) {
-  post_event(boost::bind(&Logger::goal_event, this, "recall", goal, false));
+  if( m_binary )
+    post_event(boost::bind(&Logger::bin_goal, this,
+                           details::binary_log::rec_recall, goal, false));
+  else
+    post_event(boost::bind(&Logger::goal_event, this, "recall", goal, false));
 }
 
 void TeleoReactor::Logger::notifyPlan(goal_id const &tok) {
-  post_event(boost::bind(&Logger::goal_event, this, "token", tok, true));
+  if( m_binary )
+    post_event(boost::bind(&Logger::bin_goal, this,
+                           details::binary_log::rec_token, tok, true));
+  else
+    post_event(boost::bind(&Logger::goal_event, this, "token", tok, true));
 }
 
 void TeleoReactor::Logger::cancelPlan(goal_id const &tok) {
-  post_event(boost::bind(&Logger::goal_event, this, "cancel", tok, false));
+  if( m_binary )
+    post_event(boost::bind(&Logger::bin_goal, this,
+                           details::binary_log::rec_cancel, tok, false));
+  else
+    post_event(boost::bind(&Logger::goal_event, this, "cancel", tok, false));
 }
 
 
 // asio methods
 
-void TeleoReactor::Logger::obs(Observation o) {
+void TeleoReactor::Logger::obs(observation_id o) {
   utils::async_ofstream::entry e = m_file.new_entry();
-  o.to_xml(e.stream())<<'\n';
+  o->to_xml(e.stream())<<'\n';
 }
 
 
@@ -1348,6 +1699,15 @@ void TeleoReactor::Logger::set_phase(TeleoReactor::Logger::tick_phase p) {
 void TeleoReactor::Logger::open_phase() {
   if( m_flags.test(in_phase) && !m_flags.test(has_data) ) {
     open_tick();
+    if( m_binary ) {
+      // phases are not closed in binary : they just last until the
+      // next phase or tick
+      encoder payload;
+      payload.put_u8(m_phase);
+      bin_record(details::binary_log::rec_phase, payload);
+      m_flags.set(has_data);
+      return;
+    }
     switch( m_phase ) {
       case in_init:
         direct_write("  <init>", true);
@@ -1373,7 +1733,9 @@ void TeleoReactor::Logger::open_phase() {
 
 void TeleoReactor::Logger::close_phase() {
   if( m_flags.test(in_phase) ) {
-    if( m_flags.test(has_data) ) {
+    if( m_binary )
+      m_flags.reset(has_data);
+    else if( m_flags.test(has_data) ) {
       switch( m_phase ) {
         case in_init:
           direct_write("  </init>", true);
@@ -1401,7 +1763,14 @@ void TeleoReactor::Logger::close_phase() {
 
 void TeleoReactor::Logger::open_tick() {
   if( m_flags.test(tick) && !m_flags.test(tick_opened) ) {
-    m_file<<" <tick value=\""<<m_current<<"\">";
+    if( m_binary ) {
+      encoder payload, idx;
+      details::binary_log::tick_index::encode_entry(idx, m_current, m_offset);
+      index_write(idx);
+      payload.put_i64(m_current);
+      bin_record(details::binary_log::rec_tick, payload);
+    } else
+      m_file<<" <tick value=\""<<m_current<<"\">";
     m_flags.set(tick_opened);
   }
 }
@@ -1410,11 +1779,13 @@ void TeleoReactor::Logger::close_tick() {
   if( m_flags.test(tick) ) {
     if( m_flags.test(tick_opened) ) {
       close_phase();
-      direct_write(" </tick>", true);
+      if( !m_binary )
+        direct_write(" </tick>", true);
       // std::flush(m_file); // Flush the buffer at every tick
     }
   } else if( m_flags.test(header) ) {
-    direct_write(" </header>", true);
+    if( !m_binary )
+      direct_write(" </header>", true);
     m_flags.reset(header);
     m_flags.reset(in_phase);
   }
@@ -1429,3 +1800,81 @@ void TeleoReactor::Logger::direct_write(std::string const &content, bool nl) {
   if( nl )
     e.stream().put('\n');
 }
+
+void TeleoReactor::Logger::terminate() {
+  if( !m_binary )
+    direct_write("</Log>", true);
+}
+
+boost::uint32_t TeleoReactor::Logger::intern(std::string const &str) {
+  std::map<std::string, boost::uint32_t>::iterator pos = m_symbols.find(str);
+  
+  if( m_symbols.end()==pos ) {
+    boost::uint32_t id = m_symbols.size();
+    encoder payload;
+    
+    payload.put_u32(id);
+    payload.put_str(str);
+    bin_record(details::binary_log::rec_symbol, payload);
+    m_symbols.insert(std::make_pair(str, id));
+    return id;
+  }
+  return pos->second;
+}
+
+void TeleoReactor::Logger::bin_record(TeleoReactor::Logger::record_type type,
+                                      TeleoReactor::Logger::encoder const &payload) {
+  encoder rec;
+  rec.put_record(type, payload);
+  
+  utils::async_ofstream::entry e = m_file.new_entry();
+  e.stream().write(rec.str().c_str(), rec.str().length());
+  m_offset += rec.str().length();
+}
+
+void TeleoReactor::Logger::index_write(TeleoReactor::Logger::encoder const &content) {
+  utils::async_ofstream::entry e = m_index.new_entry();
+  e.stream().write(content.str().c_str(), content.str().length());
+}
+
+void TeleoReactor::Logger::bin_predicate(TeleoReactor::Logger::encoder &out,
+                                         Predicate const &pred) {
+  std::list<Symbol> attrs;
+  pred.listAttributes(attrs, false);
+  
+  out.put_u32(intern(pred.object().str()));
+  out.put_u32(intern(pred.predicate().str()));
+  out.put_u32(attrs.size());
+  for(std::list<Symbol>::const_iterator i=attrs.begin(); attrs.end()!=i; ++i) {
+    // only the names are interned : the values are encoded natively
+    out.put_u32(intern(i->str()));
+    details::binary_log::encode_domain(out, pred.getAttribute(*i).domain());
+  }
+}
+
+void TeleoReactor::Logger::bin_tl(TeleoReactor::Logger::record_type type,
+                                  Symbol name, bool goals, bool plan,
+                                  bool flags) {
+  encoder payload;
+  payload.put_u32(intern(name.str()));
+  if( flags ) {
+    payload.put_u8(goals);
+    payload.put_u8(plan);
+  }
+  bin_record(type, payload);
+}
+
+void TeleoReactor::Logger::bin_obs(observation_id o) {
+  encoder payload;
+  bin_predicate(payload, *o);
+  bin_record(details::binary_log::rec_obs, payload);
+}
+
+void TeleoReactor::Logger::bin_goal(TeleoReactor::Logger::record_type type,
+                                    goal_id g, bool full) {
+  encoder payload;
+  payload.put_u64(reinterpret_cast<size_t>(g.get()));
+  if( full )
+    bin_predicate(payload, *g);
+  bin_record(type, payload);
+}
@@ -43,6 +43,7 @@
 # define H_TeleoReactor
 
 # include <cmath>
+# include <set>
 
 # include "bits/external.hh"
 # include "reactor_graph.hh"
@@ -51,6 +52,8 @@
 # include <trex/utils/chrono_helper.hh>
 # include <trex/utils/cpu_clock.hh>
 # include <trex/utils/asio_fstream.hh>
+# include <trex/utils/asio_runner.hh>
+# include <trex/utils/platform/atomic.hh>
 
 # if !defined(CPP11_HAS_CHRONO) && defined(BOOST_CHRONO_HAS_THREAD_CLOCK)
 #  include <boost/chrono/thread_clock.hpp>
@@ -106,8 +109,29 @@ namespace TREX {
 # endif // CPP11_HAS_CHRONO      
       
       typedef stat_clock::duration stat_duration;
-
       
+      /** @brief Reactor execution phases
+       *
+       * The execution phases of a reactor for which the real time
+       * durations are collected in the graph latency histograms
+       *
+       * @sa graph::latency() const
+       */
+      enum latency_phase {
+        phase_tick_start = 0, //*< handleTickStart
+        phase_dispatch,       //*< goal dispatching at tick start
+        phase_notify,         //*< handleObservation calls
+        phase_synchronize,    //*< synchronize
+        phase_step,           //*< a single deliberation step
+        nb_phases
+      };
+      /** @brief Phase name
+       * @param[in] p A phase
+       * @return The symbolic name of @p p as it appears in the latency 
+       *         registry
+       */
+      static utils::Symbol const &phase_name(latency_phase p);
+
       static utils::Symbol const obs;
       static utils::Symbol const plan;
       
@@ -155,7 +179,8 @@ namespace TREX {
        * A typical reactor  definition is as follow
        * @code
        * < <RType> name="<name>" lookahead="<lookahead>" latency="<latency>"
-       *           config="<config>" log="<logflag>" verbose="<verbflag>" >
+       *           config="<config>" log="<logflag>" log_format="<fmt>"
+       *           verbose="<verbflag>" event_driven="<evflag>" >
        *      <External name="<ename>" goals="<post goal flag>" />
        *      <Internal name="<iname>" />
        * </ <RType> >
@@ -169,11 +194,17 @@ namespace TREX {
        * @li @c @<logflag@> An optional flag used to indicate that observations and commands
        *                   issued from this reactor should be logged or not
        *                   (default is @p log_default)
+       * @li @c @<fmt@> An optional format for the transaction log. It can be
+       *               either @c xml (the default) which produces a
+       *               @c <name>.tr.log file or @c binary for a more compact
+       *               @c <name>.tr.bin file. Both can be replayed by a LogPlayer
        * @li @c @<config@> An optional extra file that extends the defintions
        *                    of this tag
        * @li @c @<verbflag@> An optional flag to indicates wheether this reactor
        *                     should be verbose in TREX.log or not. Defulat is
        *                     graph::is_verbose()
+       * @li @c @<evflag@> An optional flag that makes the reactor event driven
+       *                   (default is @c false)
        *
        * If @p loadTL is true then that class will also parse the External
        *              and Internal tags in order to declare internal and
@@ -368,6 +399,73 @@ namespace TREX {
       TICK getLookAhead() const {
         return m_lookahead;
       }
+      /** @brief Check if event driven
+       *
+       * An event driven reactor is not polled by the agent for new work
+       * after each deliberation step. Instead the reactor is woken up by
+       * its graph whenever it receives a new request, recall or plan
+       * token, or when a new observation is published on one of its
+       * @e External timelines. This allows the reactor to react to these
+       * events within the tick without the cost of evaluating hasWork()
+       * after every step of the other reactors.
+       *
+       * @retval true if the reactor is event driven
+       * @retval false otherwise
+       * @sa set_event_driven(bool)
+       * @sa graph::wakeup(reactor_id)
+       */
+      bool is_event_driven() const {
+        return m_event_driven;
+      }
+      /** @brief set event driven mode
+       * @param[in] flag event driven flag
+       *
+       * Sets whether this reactor is event driven or not
+       * @sa is_event_driven() const
+       */
+      void set_event_driven(bool flag=true) {
+        m_event_driven = flag;
+      }
+      
+      /** @brief Executor name
+       *
+       * Identifies the executor this reactor requested for running its 
+       * synchronization, deliberation and work ratio computation. The 
+       * tick start notification and goal dispatching are still executed 
+       * by the agent threads. This is set by the @c executor attribute 
+       * of the reactor XML definition:
+       * @li empty (the default) the reactor shares the agent threads
+       * @li @c "dedicated" the reactor runs on its own thread placed 
+       *     according to placement()
+       * @li otherwise the name of an executor pool declared in the agent 
+       *     configuration
+       *
+       * @return the executor name
+       * @sa placement() const
+       * @sa dedicated_executor
+       */
+      utils::Symbol const &executor() const {
+        return m_executor;
+      }
+      /** @brief Dedicated thread placement
+       *
+       * The cpu affinity and niceness given by the @c cpus and @c nice 
+       * attributes of the reactor XML definition. It is only used when 
+       * the reactor runs on a dedicated executor.
+       *
+       * @return the placement of this reactor thread
+       * @sa executor() const
+       */
+      utils::thread_placement const &placement() const {
+        return m_placement;
+      }
+      /** @brief Dedicated executor name
+       *
+       * The executor name used by a reactor to request its own thread
+       *
+       * @sa executor() const
+       */
+      static utils::Symbol const dedicated_executor;
       /** @btrief New observation callback
        *
        * @param[in] obs An observation
@@ -383,6 +481,23 @@ namespace TREX {
        * @sa synchronize()
        */
       virtual void notify(Observation const &obs) {}
+      /** @brief New shared observation callback
+       *
+       * @param[in] obs An observation
+       *
+       * This method is called by the agent for each new observation on one
+       * of the @p External timelines of this reactor. The observation @p obs
+       * is shared with all the other clients of this timeline and should
+       * not be modified. Reactors that need to keep the observation can
+       * override this method to store @p obs without copying it.
+       *
+       * The default implementation just calls notify(*obs)
+       *
+       * @sa notify(Observation const &)
+       */
+      virtual void handleObservation(observation_id const &obs) {
+        notify(*obs);
+      }
       
       /** @brief Final initialization
        *
@@ -629,6 +744,11 @@ namespace TREX {
        * It can be called internally to the reactor when a new state has been identified
        * for this timeline.
        *
+       * The observation is not posted immediately but queued in this reactor
+       * transaction mailbox which is flushed at the end of the synchronization
+       * or deliberation step. This avoids to block the reactor on the graph
+       * strand for every observation produced.
+       *
        * @pre @c o.object() is internal to this reactor
        * @post Unless postObservation is called in between with an observation on the
        *       same object, the observation @p o will be dispatched to all the
@@ -641,6 +761,18 @@ namespace TREX {
        * @sa doNotify()
        */
       void postObservation(Observation const &o, bool verbose=false);
+      /** @brief Produce an observation
+       *
+       * @param[in] o An observation id
+       *
+       * Similar to postObservation(Observation const &, bool) but shares
+       * the observation @p o with all the clients of its timeline instead
+       * of copying it. @p o should not be modified after this call.
+       *
+       * @throw SynchronizationError @p o is a null pointer
+       * @sa postObservation(Observation const &, bool)
+       */
+      void postObservation(observation_id const &o, bool verbose=false);
       
       /** @brief Post a goal
        *
@@ -686,6 +818,21 @@ namespace TREX {
        */
       goal_id postGoal(Goal const &g);
       
+      /** @brief Post a batch of goals
+       *
+       * @param[in] goals A list of goal ids
+       *
+       * Post all the goals in @p goals to their external timelines within a 
+       * single graph transaction. The goals that are either null or not on 
+       * an external timeline of this reactor are skipped.
+       *
+       * @return The number of goals from @p goals that were succesfully 
+       *         posted 
+       *
+       * @sa postGoal(goal_id const &)
+       */
+      size_t postGoals(std::list<goal_id> const &goals);
+      
       goal_id postGoal(boost::property_tree::ptree::value_type const &g) {
         goal_id gl=parse_goal(g);
         if( postGoal(gl) )
@@ -733,6 +880,16 @@ namespace TREX {
        * @sa postPlanToken(goal_id const &)
        */
       goal_id postPlanToken(Goal const &g);
+      /** @brief Cancel a planned token
+       *
+       * @param[in] g A goal id
+       *
+       * Inform that the token @p g is no longer part of the plan of the
+       * reactor. As for postObservation, this transaction is queued in the
+       * reactor mailbox and applied when this mailbox is flushed.
+       *
+       * @sa postPlanToken(goal_id const &)
+       */
       void cancelPlanToken(goal_id const &g);
       
       
@@ -1009,6 +1166,35 @@ namespace TREX {
       syslog(utils::log::id_type const &kind=null) const {
         return m_graph.syslog(getName(), kind);
       }
+      /** @brief Create a structured log record
+       *
+       * @param[in] fmt The message format
+       * @param[in] context log entry prefix
+       * @param[in] kind  type of message
+       *
+       * Create a new record in TREX.blog. Unlike syslog the message 
+       * arguments are stored in raw form and only formatted when the
+       * binary log is decoded which makes it suitable for frequent 
+       * messages.
+       *
+       * @return a record that can receive the message arguments
+       *
+       * @sa syslog(utils::log::id_type const &, utils::log::id_type const &) const
+       * @sa utils::log::record
+       */
+      utils::log::record
+      record(utils::log::format const &fmt, utils::log::id_type const &context,
+             utils::log::id_type const &kind) const {
+        utils::log::record ret = m_graph.record(fmt, getName(), kind);
+        if( !context.empty() )
+          ret.source(context);
+        return ret;
+      }
+      utils::log::record
+      record(utils::log::format const &fmt,
+             utils::log::id_type const &kind=null) const {
+        return m_graph.record(fmt, getName(), kind);
+      }
       
       /** @brief Find an external timeline
        *
@@ -1031,6 +1217,10 @@ namespace TREX {
     private:
       stat_duration m_start_usage, m_synch_usage, m_deliberation_usage;
       rt_clock::duration m_start_rt, m_synch_rt, m_delib_rt;
+      /** @brief Latency histograms of this reactor phases */
+      utils::latency_registry::histogram_ref m_phase_latency[nb_phases];
+      
+      void init_latency();
       
       
       bool internal_sync(TREX::utils::Symbol name) const;
@@ -1045,8 +1235,9 @@ namespace TREX {
       void provide_sync(TREX::utils::Symbol name, details::transaction_flags f);
       bool unprovide_sync(TREX::utils::Symbol name);
      
-      void observation_sync(Observation o, bool verbose);
+      void observation_sync(observation_id o, bool verbose);
       bool goal_sync(goal_id g);
+      size_t goals_sync(std::list<goal_id> const &goals);
       bool recall_sync(goal_id g);
       
       bool plan_sync(goal_id tok);
@@ -1062,6 +1253,15 @@ namespace TREX {
       class Logger;
     
       void queue(std::list<goal_id> &l, goal_id g);
+      /** @brief Wake up this reactor
+       *
+       * Notifies the graph that a new event has been received by this
+       * reactor if it is event driven. This method is called within the
+       * graph strand.
+       *
+       * @sa is_event_driven() const
+       */
+      void wakeup();
       
       void queue_goal(goal_id g);
       void queue_recall(goal_id g);
@@ -1076,7 +1276,53 @@ namespace TREX {
       
       bool have_goals();
       
-      void collect_obs_sync(std::list<Observation> &l);
+      typedef boost::function<void ()> transaction_fn;
+      typedef std::list<transaction_fn> mailbox_type;
+      
+      /** @brief Mailbox entry
+       *
+       * A transaction waiting in the mailbox along with the entry posted
+       * just before it
+       */
+      struct mail :boost::noncopyable {
+        explicit mail(transaction_fn const &f):fn(f), next(NULL) {}
+        
+        transaction_fn fn;
+        mail          *next;
+      };
+      
+      /** @brief Fire and forget transactions mailbox
+       *
+       * The transactions posted by this reactor that do not require
+       * an answer. They are applied in batch within the graph strand
+       * at the end of the synchronization and deliberation phases.
+       *
+       * This is a lock free stack of the posted transactions: the reactor
+       * pushes them from its own thread and the graph strand takes all 
+       * of them at once before applying them in their posting order
+       */
+      ATOMIC_NS::atomic<mail *> m_mailbox;
+      /** @brief Transactions taken from the mailbox not yet applied
+       *
+       * Only accessed within the graph strand. A transaction that failed 
+       * interrupts the batch and the ones following it are kept here 
+       * until the next mailbox synchronization
+       */
+      mailbox_type m_pending;
+      /** @brief Names of the Internal timelines
+       *
+       * A copy of the names of the timelines in m_internals that can be
+       * accessed outside of the graph strand. It allows postObservation to
+       * reject an observation on a non Internal timeline before queuing it
+       */
+      utils::SharedVar< std::set<utils::Symbol> > m_internal_names;
+      
+      void post_transaction(transaction_fn const &fn);
+      void mailbox_sync();
+      void flush_mailbox();
+      void updates_sync(TICK date);
+      
+      void collect_obs_sync(std::list<observation_id> &l);
       
       /** @brief Request new observations
        *
@@ -1093,6 +1339,10 @@ namespace TREX {
       void   doNotify();
       
       bool m_verbose;
+      bool m_event_driven;
+      
+      utils::Symbol           m_executor;
+      utils::thread_placement m_placement;
       
       /** @brief Transaction logger
        *
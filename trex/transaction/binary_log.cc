@@ -0,0 +1,214 @@
+/** @file "binary_log.cc"
+ * @brief binary transaction log domains encoding
+ *
+ * @ingroup transaction
+ */
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ * 
+ *  Copyright (c) 2011, MBARI.
+ *  All rights reserved.
+ * 
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ * 
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the TREX Project nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ * 
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "bits/binary_log.hh"
+
+#include <trex/domain/BooleanDomain.hh>
+#include <trex/domain/IntegerDomain.hh>
+#include <trex/domain/FloatDomain.hh>
+#include <trex/domain/StringDomain.hh>
+#include <trex/domain/EnumDomain.hh>
+
+#include <sstream>
+
+#include <boost/property_tree/xml_parser.hpp>
+
+using namespace TREX::transaction;
+namespace bl=TREX::transaction::details::binary_log;
+namespace xml=boost::property_tree::xml_parser;
+
+namespace {
+  
+  enum bound_kind {
+    finite_bound = 0,
+    minus_inf_bound = 1,
+    plus_inf_bound = 2
+  };
+  
+  template<class Dom>
+  void put_bound(bl::encoder &out, typename Dom::bound const &b) {
+    if( b.isInfinity() )
+      out.put_u8(b==Dom::plus_inf?plus_inf_bound:minus_inf_bound);
+    else {
+      out.put_u8(finite_bound);
+      out.put_i64(b.value());
+    }
+  }
+  
+  template<>
+  void put_bound<FloatDomain>(bl::encoder &out, FloatDomain::bound const &b) {
+    if( b.isInfinity() )
+      out.put_u8(b==FloatDomain::plus_inf?plus_inf_bound:minus_inf_bound);
+    else {
+      out.put_u8(finite_bound);
+      out.put_f64(b.value());
+    }
+  }
+  
+  template<class Dom>
+  typename Dom::bound get_bound(bl::decoder &in) {
+    switch( in.get_u8() ) {
+      case finite_bound:
+        return typename Dom::bound(in.get_i64());
+      case minus_inf_bound:
+        return Dom::minus_inf;
+      case plus_inf_bound:
+        return Dom::plus_inf;
+      default:
+        throw bl::format_error("invalid interval bound");
+    }
+  }
+  
+  template<>
+  FloatDomain::bound get_bound<FloatDomain>(bl::decoder &in) {
+    switch( in.get_u8() ) {
+      case finite_bound:
+        return FloatDomain::bound(in.get_f64());
+      case minus_inf_bound:
+        return FloatDomain::minus_inf;
+      case plus_inf_bound:
+        return FloatDomain::plus_inf;
+      default:
+        throw bl::format_error("invalid interval bound");
+    }
+  }
+  
+  template<class Dom>
+  void put_interval(bl::encoder &out, Dom const &dom) {
+    put_bound<Dom>(out, dom.lowerBound());
+    put_bound<Dom>(out, dom.upperBound());
+  }
+  
+  template<class Dom>
+  DomainBase *get_interval(bl::decoder &in) {
+    typename Dom::bound lb = get_bound<Dom>(in);
+    return new Dom(lb, get_bound<Dom>(in));
+  }
+  
+  std::string const &value_text(std::string const &val) {
+    return val;
+  }
+  std::string const &value_text(TREX::utils::Symbol const &val) {
+    return val.str();
+  }
+  
+  template<class Dom>
+  void put_values(bl::encoder &out, Dom const &dom) {
+    out.put_u32(dom.getSize());
+    for(typename Dom::iterator i=dom.begin(); dom.end()!=i; ++i)
+      out.put_str(value_text(*i));
+  }
+  
+  template<class Dom, typename Ty>
+  DomainBase *get_values(bl::decoder &in) {
+    std::vector<Ty> values;
+    
+    for(boost::uint32_t n=in.get_u32(); n>0; --n)
+      values.push_back(Ty(in.get_str()));
+    if( values.empty() )
+      return new Dom;
+    return new Dom(values.begin(), values.end());
+  }
+  
+}
+
+/*
+ * TREX::transaction::details::binary_log
+ */
+
+void bl::encode_domain(bl::encoder &out, DomainBase const &dom) {
+  // test the exact type : a derived class could be more specific
+  TREX::utils::Symbol const &type = dom.getTypeName();
+  
+  if( BooleanDomain::type_name==type ) {
+    out.put_u8(dom_bool);
+    out.put_u8(dom.isFull());
+    out.put_u8(!dom.isFull() && dom.getTypedSingleton<bool, false>());
+  } else if( IntegerDomain::type_name==type ) {
+    out.put_u8(dom_int);
+    put_interval(out, static_cast<IntegerDomain const &>(dom));
+  } else if( FloatDomain::type_name==type ) {
+    out.put_u8(dom_float);
+    put_interval(out, static_cast<FloatDomain const &>(dom));
+  } else if( StringDomain::type_name==type ) {
+    out.put_u8(dom_string);
+    put_values(out, static_cast<StringDomain const &>(dom));
+  } else if( EnumDomain::type_name==type ) {
+    out.put_u8(dom_enum);
+    put_values(out, static_cast<EnumDomain const &>(dom));
+  } else {
+    std::ostringstream oss;
+    
+    dom.toXml(oss);
+    out.put_u8(dom_xml);
+    out.put_str(oss.str());
+  }
+}
+
+DomainBase *bl::decode_domain(bl::decoder &in) {
+  switch( in.get_u8() ) {
+    case dom_bool:
+    {
+      bool full = in.get_u8()!=0, val = in.get_u8()!=0;
+      if( full )
+        return new BooleanDomain;
+      return new BooleanDomain(val);
+    }
+    case dom_int:
+      return get_interval<IntegerDomain>(in);
+    case dom_float:
+      return get_interval<FloatDomain>(in);
+    case dom_string:
+      return get_values<StringDomain, std::string>(in);
+    case dom_enum:
+      return get_values<EnumDomain, TREX::utils::Symbol>(in);
+    case dom_xml:
+    {
+      std::istringstream iss(in.get_str());
+      boost::property_tree::ptree pt;
+      TREX::utils::SingletonUse<DomainBase::xml_factory> dom_f;
+      
+      read_xml(iss, pt, xml::no_comments|xml::trim_whitespace);
+      if( pt.empty() )
+        throw format_error("empty domain");
+      return dom_f->produce(pt.front())->copy();
+    }
+    default:
+      throw format_error("unknown domain type");
+  }
+}
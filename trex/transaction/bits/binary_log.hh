@@ -0,0 +1,480 @@
+/** @file trex/transaction/bits/binary_log.hh
+ * @brief binary transaction log format
+ *
+ * This file defines the records and encoding helpers used by the
+ * binary transaction log format.
+ *
+ * @ingroup transaction
+ */
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ * 
+ *  Copyright (c) 2011, MBARI.
+ *  All rights reserved.
+ * 
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ * 
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the TREX Project nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ * 
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef H_BITS_binary_log
+# define H_BITS_binary_log
+
+# include <trex/utils/Exception.hh>
+
+# include <cstring>
+# include <string>
+# include <vector>
+# include <algorithm>
+
+# include <boost/cstdint.hpp>
+
+namespace TREX {
+  namespace transaction {
+    
+    class DomainBase;
+    
+    namespace details {
+      /** @brief binary transaction log utilities
+       *
+       * This namespace defines the format of the binary transaction
+       * logs produced by a reactor when its @c log_format is set to
+       * @c binary.
+       *
+       * The file starts with the 4 bytes magic "TRXB" followed by one
+       * byte for the format version. It is then followed by a sequence of
+       * records each of them having the form:
+       * @code
+       * <type:u8> <length:u32> <payload:length bytes>
+       * @endcode
+       * Where all integers are little endian. The length prefix allows a
+       * reader to skip records it does not need or know.
+       *
+       * All the names (timelines, predicates, attributes) are interned:
+       * the first time a name is used it is declared with a @c rec_symbol
+       * record associating it to an integer identifier, and further
+       * records only refer to this identifier. As the number of names
+       * used by a reactor is bounded, so is the symbol table.
+       *
+       * A predicate is encoded as:
+       * @code
+       * <object:sym> <predicate:sym> <count:u32> (<attribute:sym> <domain>)*
+       * @endcode
+       * where the domain values are encoded natively by type (see
+       * domain_type) so a reader never has to parse them. Only the
+       * domains of types unknown to this format are stored as their
+       * XML text.
+       *
+       * Along with the log the reactor produces a tick index (the log file
+       * name with the extra @c .idx extension) that gives the offset of
+       * each @c rec_tick record within the log. This index starts with the
+       * magic "TRXI" and the version byte and is followed by one fixed
+       * size entry per tick:
+       * @code
+       * <tick:i64> <offset:u64>
+       * @endcode
+       *
+       * @ingroup transaction
+       * @sa TREX::transaction::LogPlayer
+       */
+      namespace binary_log {
+
+        /** @brief Format magic number */
+        char const magic[] = { 'T', 'R', 'X', 'B' };
+        /** @brief Format version */
+        boost::uint8_t const version = 2;
+        /** @brief Tick index format version */
+        boost::uint8_t const index_version = 1;
+        /** @brief Tick index magic number */
+        char const index_magic[] = { 'T', 'R', 'X', 'I' };
+        /** @brief Size of the header of a binary log or its index */
+        size_t const header_size = sizeof(magic)+1;
+
+        /** @brief record types
+         *
+         * The type of all the records in a binary log
+         */
+        enum record_type {
+          /** @brief symbol declaration: <id:u32> <text:str> */
+          rec_symbol    = 0,
+          /** @brief new tick: <tick:i64> */
+          rec_tick      = 1,
+          /** @brief new phase within the tick: <phase:u8> */
+          rec_phase     = 2,
+          /** @brief External declaration: <tl:sym> <goals:u8> <plan:u8> */
+          rec_use       = 3,
+          /** @brief External undeclaration: <tl:sym> */
+          rec_unuse     = 4,
+          /** @brief Internal declaration: <tl:sym> <goals:u8> <plan:u8> */
+          rec_provide   = 5,
+          /** @brief Internal undeclaration: <tl:sym> */
+          rec_unprovide = 6,
+          /** @brief latency update: <value:i64> */
+          rec_latency   = 7,
+          /** @brief horizon update: <value:i64> */
+          rec_horizon   = 8,
+          /** @brief reactor failure (no payload) */
+          rec_failed    = 9,
+          /** @brief work request: <value:u8> */
+          rec_work      = 10,
+          /** @brief new observation: <predicate> */
+          rec_obs       = 11,
+          /** @brief goal request: <id:u64> <predicate> */
+          rec_request   = 12,
+          /** @brief goal recall: <id:u64> */
+          rec_recall    = 13,
+          /** @brief plan token: <id:u64> <predicate> */
+          rec_token     = 14,
+          /** @brief plan token cancellation: <id:u64> */
+          rec_cancel    = 15,
+          /** @brief comment: <text:str> */
+          rec_comment   = 16
+        };
+
+        /** @brief Tick phases
+         *
+         * The identifiers of the phases within a tick as stored in
+         * a @c rec_phase record
+         */
+        enum phase_type {
+          phase_init      = 0,
+          phase_new_tick  = 1,
+          phase_synchronize = 2,
+          phase_has_work  = 3,
+          phase_step      = 4
+        };
+
+        /** @brief Domain types
+         *
+         * The first byte of an encoded domain. It is followed by:
+         * @li @c dom_bool: <full:u8> <value:u8>
+         * @li @c dom_int: <lower:bound> <upper:bound> where a bound is
+         *     <kind:u8> followed by <value:i64> when kind is 0 (1 is
+         *     -inf and 2 +inf)
+         * @li @c dom_float: same as @c dom_int with <value:f64>
+         * @li @c dom_string and @c dom_enum: <count:u32> <value:str>*
+         *     where a count of 0 is the full domain
+         * @li @c dom_xml: <xml:str> for any other domain type
+         */
+        enum domain_type {
+          dom_xml    = 0,
+          dom_bool   = 1,
+          dom_int    = 2,
+          dom_float  = 3,
+          dom_string = 4,
+          dom_enum   = 5
+        };
+
+        /** @brief Binary log format error
+         *
+         * Exception thrown when a binary log is malformed
+         *
+         * @ingroup transaction
+         */
+        class format_error :public TREX::utils::Exception {
+        public:
+          format_error(std::string const &msg) throw()
+          :TREX::utils::Exception("binary log: "+msg) {}
+          ~format_error() throw() {}
+        }; // TREX::transaction::details::binary_log::format_error
+
+        /** @brief Binary record encoder
+         *
+         * A simple helper to build the payload of a record. Integers
+         * are written in little endian and strings are prefixed by
+         * their length.
+         *
+         * @ingroup transaction
+         */
+        class encoder {
+        public:
+          encoder() {}
+          ~encoder() {}
+
+          void put_u8(boost::uint8_t val) {
+            m_buf.push_back(static_cast<char>(val));
+          }
+          void put_u32(boost::uint32_t val) {
+            for(size_t i=0; i<4; ++i, val >>= 8)
+              put_u8(val & 0xff);
+          }
+          void put_u64(boost::uint64_t val) {
+            for(size_t i=0; i<8; ++i, val >>= 8)
+              put_u8(val & 0xff);
+          }
+          void put_i64(boost::int64_t val) {
+            put_u64(static_cast<boost::uint64_t>(val));
+          }
+          void put_f64(double val) {
+            boost::uint64_t bits;
+            std::memcpy(&bits, &val, sizeof(bits));
+            put_u64(bits);
+          }
+          void put_str(std::string const &str) {
+            put_u32(str.length());
+            m_buf.append(str);
+          }
+
+          /** @brief Record encoding
+           * @param[in] type A record type
+           * @param[in] payload A record payload
+           *
+           * Append to this encoder the record of type @p type with
+           * the content of @p payload
+           */
+          void put_record(record_type type, encoder const &payload) {
+            put_u8(type);
+            put_str(payload.m_buf);
+          }
+
+          std::string const &str() const {
+            return m_buf;
+          }
+          bool empty() const {
+            return m_buf.empty();
+          }
+          void clear() {
+            m_buf.clear();
+          }
+        private:
+          std::string m_buf;
+        }; // TREX::transaction::details::binary_log::encoder
+
+        /** @brief Binary record decoder
+         *
+         * A helper to decode the binary content written by an encoder
+         * from a memory buffer. The decoder does not own the buffer.
+         *
+         * @ingroup transaction
+         */
+        class decoder {
+        public:
+          decoder()
+          :m_cur(NULL), m_end(NULL) {}
+          decoder(char const *from, char const *to)
+          :m_cur(from), m_end(to) {}
+          ~decoder() {}
+
+          bool empty() const {
+            return m_cur>=m_end;
+          }
+          char const *position() const {
+            return m_cur;
+          }
+
+          boost::uint8_t get_u8() {
+            check(1);
+            return static_cast<boost::uint8_t>(*(m_cur++));
+          }
+          boost::uint32_t get_u32() {
+            boost::uint32_t ret = 0;
+            check(4);
+            for(size_t i=0; i<4; ++i)
+              ret |= static_cast<boost::uint32_t>(static_cast<boost::uint8_t>(m_cur[i])) << (8*i);
+            m_cur += 4;
+            return ret;
+          }
+          boost::uint64_t get_u64() {
+            boost::uint64_t ret = 0;
+            check(8);
+            for(size_t i=0; i<8; ++i)
+              ret |= static_cast<boost::uint64_t>(static_cast<boost::uint8_t>(m_cur[i])) << (8*i);
+            m_cur += 8;
+            return ret;
+          }
+          boost::int64_t get_i64() {
+            return static_cast<boost::int64_t>(get_u64());
+          }
+          double get_f64() {
+            boost::uint64_t bits = get_u64();
+            double ret;
+            std::memcpy(&ret, &bits, sizeof(ret));
+            return ret;
+          }
+          std::string get_str() {
+            boost::uint32_t len = get_u32();
+            check(len);
+            std::string ret(m_cur, len);
+            m_cur += len;
+            return ret;
+          }
+
+          /** @brief Record decoding
+           * @param[out] payload The record payload
+           *
+           * Extract the next record of this decoder and set @p payload
+           * to decode its content
+           *
+           * @return the type of the record
+           * @throw format_error the buffer does not contain a full record
+           */
+          record_type get_record(decoder &payload) {
+            record_type type = static_cast<record_type>(get_u8());
+            boost::uint32_t len = get_u32();
+            check(len);
+            payload = decoder(m_cur, m_cur+len);
+            m_cur += len;
+            return type;
+          }
+        private:
+          void check(size_t len) const {
+            // compare sizes as m_cur+len may overflow for a corrupt len
+            if( len>size_t(m_end-m_cur) )
+              throw format_error("truncated record");
+          }
+
+          char const *m_cur, *m_end;
+        }; // TREX::transaction::details::binary_log::decoder
+
+        /** @brief Tick index
+         *
+         * The in memory form of the tick index of a binary log. It
+         * associates to each tick the offset of its @c rec_tick record
+         * within the log allowing to seek directly to a given tick
+         * without decoding the records that precede it.
+         *
+         * @ingroup transaction
+         */
+        class tick_index {
+        public:
+          typedef std::pair<boost::int64_t, boost::uint64_t> entry;
+          typedef std::vector<entry>::const_iterator         iterator;
+
+          /** @brief Size of an index entry */
+          static size_t const entry_size = 16;
+
+          tick_index() {}
+          ~tick_index() {}
+
+          bool empty() const {
+            return m_entries.empty();
+          }
+          size_t size() const {
+            return m_entries.size();
+          }
+          iterator begin() const {
+            return m_entries.begin();
+          }
+          iterator end() const {
+            return m_entries.end();
+          }
+          entry const &back() const {
+            return m_entries.back();
+          }
+
+          /** @brief Add a new entry
+           * @param[in] tick A tick
+           * @param[in] offset The offset of @p tick in the log
+           *
+           * @pre @p tick is greater than the last tick in the index
+           * @throw format_error @p tick or @p offset are not greater
+           *        than the last entry
+           */
+          void add(boost::int64_t tick, boost::uint64_t offset) {
+            if( !m_entries.empty() &&
+                ( tick<=m_entries.back().first ||
+                  offset<=m_entries.back().second ) )
+              throw format_error("tick index is not sorted");
+            m_entries.push_back(entry(tick, offset));
+          }
+          /** @brief Seek a tick
+           * @param[in] tick A tick
+           *
+           * @return An iterator to the first entry which tick is
+           *         greater or equal to @p tick or end() if no such
+           *         entry exists
+           */
+          iterator seek(boost::int64_t tick) const {
+            return std::lower_bound(m_entries.begin(), m_entries.end(),
+                                    entry(tick, 0));
+          }
+
+          /** @brief Decode an index
+           * @param[in] in A decoder
+           *
+           * Replace the content of this index by the one decoded
+           * from @p in
+           *
+           * @throw format_error @p in is not a valid tick index
+           */
+          void decode(decoder &in) {
+            m_entries.clear();
+            for(size_t i=0; i<sizeof(index_magic); ++i)
+              if( in.get_u8()!=static_cast<boost::uint8_t>(index_magic[i]) )
+                throw format_error("invalid tick index magic number");
+            if( in.get_u8()!=index_version )
+              throw format_error("unsupported tick index version");
+            while( !in.empty() ) {
+              boost::int64_t tick = in.get_i64();
+              add(tick, in.get_u64());
+            }
+          }
+          /** @brief Encode the index header
+           * @param[out] out An encoder
+           */
+          static void encode_header(encoder &out) {
+            for(size_t i=0; i<sizeof(index_magic); ++i)
+              out.put_u8(index_magic[i]);
+            out.put_u8(index_version);
+          }
+          /** @brief Encode an entry
+           * @param[out] out An encoder
+           * @param[in] tick A tick
+           * @param[in] offset the offset of @p tick in the log
+           */
+          static void encode_entry(encoder &out, boost::int64_t tick,
+                                   boost::uint64_t offset) {
+            out.put_i64(tick);
+            out.put_u64(offset);
+          }
+
+        private:
+          std::vector<entry> m_entries;
+        }; // TREX::transaction::details::binary_log::tick_index
+
+        /** @brief Encode a domain
+         * @param[out] out An encoder
+         * @param[in] dom A domain
+         *
+         * Append to @p out the encoding of @p dom as described in 
+         * domain_type
+         */
+        void encode_domain(encoder &out, DomainBase const &dom);
+        /** @brief Decode a domain
+         * @param[in] in A decoder
+         *
+         * Decode the next domain of @p in
+         *
+         * @return The newly allocated domain
+         * @throw format_error @p in does not start with a valid domain
+         */
+        DomainBase *decode_domain(decoder &in);
+
+      } // TREX::transaction::details::binary_log
+    } // TREX::transaction::details
+  } // TREX::transaction
+} // TREX
+
+#endif // H_BITS_binary_log
@@ -45,9 +45,13 @@
 
 # include "../Goal.hh"
 # include "timeline.hh"
+# include "timer_wheel.hh"
+
+# include <map>
 
 # include <boost/iterator_adaptors.hpp>
 # include <boost/iterator/filter_iterator.hpp>
+# include <boost/unordered_map.hpp>
 
 namespace TREX {
   namespace transaction {
@@ -57,12 +61,175 @@ namespace TREX {
        *
        * The basic container used by external class to maintain and
        * process the set of goals being posted by a reactor and yet to
-       * be dipatched to the owner of this timeline
+       * be dipatched to the owner of this timeline.
+       *
+       * Goals are indexed by their start domain -- sorted first on
+       * its upper bound and then on its lower bound, this way the
+       * lower bound of a pending goal can be updated without impacting
+       * the order -- and by their id which allows to post and recall
+       * goals in logarithmic time even when the queue has thousands of
+       * goals pending.
+       *
+       * Each entry associates a goal with a flag indicating whether this
+       * goal can be dispatched or got blocked by an exception during a
+       * former attempt.
+       *
+       * Only the goals that may start within the dispatch horizon reached 
+       * so far are kept in this sorted queue. Goals starting later are 
+       * parked in a timer_wheel keyed on the lower bound of their start and 
+       * only moved to the queue by advance() once the dispatch horizon 
+       * reaches this bound. This way goals posted far in the future are 
+       * not examined again on every tick. The key is the start date rather 
+       * than the tick at which the goal become dispatchable as the latter 
+       * depends on the latency and look-ahead of the timeline owner which 
+       * may change over time.
        *
        * @ingroup transaction
        * @relates class external
        */
-      typedef std::list< std::pair<goal_id, bool> >  goal_queue;
+      class goal_queue {
+      public:
+        /** @brief Ordering key
+         *
+         * The upper and lower bound of the goal start
+         */
+        typedef std::pair<IntegerDomain::bound,
+                          IntegerDomain::bound>       key_type;
+        typedef std::pair<goal_id, bool>              value_type;
+      private:
+        typedef std::multimap<key_type, value_type>   queue_type;
+        typedef timer_wheel<value_type>               wheel_type;
+        
+        /** @brief Goal position
+         *
+         * Locates a goal either in the sorted queue or in the timer
+         * wheel
+         */
+        struct position {
+          position(wheel_type::handle const &h)
+            :scheduled(true), timer(h) {}
+          position(queue_type::iterator const &i)
+            :scheduled(false), pos(i) {}
+          
+          bool                 scheduled;
+          wheel_type::handle   timer;
+          queue_type::iterator pos;
+        }; // TREX::transaction::details::goal_queue::position
+        
+        typedef boost::unordered_map<Goal const *, position> index_type;
+      public:
+        typedef queue_type::iterator                  iterator;
+        typedef queue_type::const_iterator            const_iterator;
+        
+        /** @brief Constructor
+         *
+         * @post the queue is empty
+         */
+        goal_queue() {}
+        /** @brief Copy constructor
+         *
+         * @param[in] other Another instance
+         *
+         * Create a copy of @p other
+         */
+        goal_queue(goal_queue const &other);
+        /** @brief Destructor */
+        ~goal_queue() {}
+        
+        goal_queue &operator= (goal_queue const &other);
+        
+        bool empty() const {
+          return m_index.empty();
+        }
+        /** @brief Number of goals
+         *
+         * @return the number of goals in this queue including the
+         *         ones not yet within the dispatch horizon
+         */
+        size_t size() const {
+          return m_index.size();
+        }
+        
+        /** @brief Beginning of the queue
+         *
+         * @return an iterator to the first goal of the queue. Only the 
+         *         goals that were moved in the queue by advance() are 
+         *         iterated through
+         *
+         * @sa advance(TICK)
+         */
+        iterator begin() {
+          return m_queue.begin();
+        }
+        iterator end() {
+          return m_queue.end();
+        }
+        const_iterator begin() const {
+          return m_queue.begin();
+        }
+        const_iterator end() const {
+          return m_queue.end();
+        }
+        
+        /** @brief Check for a goal
+         *
+         * @param[in] g A goal
+         *
+         * @retval true if @p g is in this queue
+         * @retval false otherwise
+         */
+        bool contains(goal_id const &g) const {
+          return m_index.end()!=m_index.find(g.get());
+        }
+        
+        /** @brief Add a goal
+         *
+         * @param[in] g A goal
+         * @param[in] ok The dispatchable flag of @p g
+         *
+         * Insert @p g in the queue based on the current value of
+         * its start domain
+         *
+         * @retval true @p g was inserted
+         * @retval false @p g was already in the queue
+         */
+        bool insert(goal_id const &g, bool ok=true);
+        /** @brief Remove a goal
+         *
+         * @param[in] g A goal
+         *
+         * @retval true @p g was removed from the queue
+         * @retval false @p g was not in the queue
+         */
+        bool erase(goal_id const &g);
+        /** @brief Remove a goal
+         *
+         * @param[in] i An iterator
+         *
+         * @pre @p i is a valid iterator of this queue
+         *
+         * @return an iterator to the element following @p i
+         */
+        iterator erase(iterator i);
+        /** @brief Advance the dispatch horizon
+         *
+         * @param[in] horizon A tick
+         *
+         * Move to the sorted queue all the goals that may start at or 
+         * before @p horizon. 
+         *
+         * @return the number of goals moved to the queue
+         */
+        size_t advance(TICK horizon);
+        
+      private:
+        iterator enqueue(value_type const &v);
+        
+        queue_type m_queue;
+        wheel_type m_wheel;
+        index_type m_index;
+      }; // TREX::transaction::details::goal_queue
+      
       /** @brief A external timeline proxy
        *
        * This type by a external class to represent an external timeline
@@ -167,7 +334,7 @@ namespace TREX {
          * @sa operator->() const
          * @sa Relation::name() const
          * 
-         * @sa dispatch(TICK, goal_queue &)
+         * @sa dispatch(TICK, std::list<goal_id> &)
          * @sa recall(goal_id const &)
          */
         bool post_goal(goal_id const &g);
@@ -190,7 +357,7 @@ namespace TREX {
          *
          * @sa valid() const
          */
-        void dispatch(TICK current, goal_queue &sent);
+        void dispatch(TICK current, std::list<goal_id> &sent);
         /** @brief Recall a goal
          *
          * @param[in] g A goal
@@ -215,16 +382,14 @@ namespace TREX {
                  
       private:
         utils::log::stream syslog(utils::log::id_type const &kind);
+        utils::log::record record(utils::log::format const &fmt,
+                                  utils::log::id_type const &kind);
         
         external_set::iterator m_pos, m_last;
         
         external(external_set::iterator const &pos,
                  external_set::iterator const &last);
         
-        
-        static bool cmp_goals(IntegerDomain const &a, IntegerDomain const &b);
-        
-        goal_queue::iterator lower_bound(IntegerDomain const &dom);
 
 	void increment();
 	bool equal(external const &other) const;
@@ -245,10 +245,19 @@ namespace TREX {
 	Observation const &lastObservation() const {
 	  return *m_last_obs;
 	}
-	Observation const &lastObservation(bool &print) {
+	/** @brief last observation
+	 *
+	 * @return the shared instance of the last observation
+	 *
+	 * @sa lastObservation() const
+	 */
+	observation_id const &lastObservationId() const {
+	  return m_last_obs;
+	}
+	observation_id const &lastObservation(bool &print) {
 	  print = m_shouldPrint;
 	  m_shouldPrint = false;
-	  return *m_last_obs;
+	  return m_last_obs;
 	}
 
 	/** @brief Timeline look ahead
@@ -447,8 +456,12 @@ namespace TREX {
 	 * @sa lastObservation() const
 	 * @sa lastObsDate() const
 	 */
-	void postObservation(Observation const &obs, 
+	void postObservation(observation_id const &obs, 
 			     bool verbose = false);
+	void postObservation(Observation const &obs, 
+			     bool verbose = false) {
+	  postObservation(MAKE_SHARED<Observation>(obs), verbose);
+	}
         void synchronize(TICK date);
         
         bool notifyPlan(goal_id const &t);
@@ -484,8 +497,8 @@ namespace TREX {
 	client_set    m_clients;
 	
 
-        boost::optional<Observation> m_last_obs;
-        boost::optional<Observation> m_next_obs;
+        observation_id m_last_obs;
+        observation_id m_next_obs;
         TICK m_last_synch;
         TICK m_obs_date;
 
@@ -0,0 +1,272 @@
+/** @file trex/transaction/bits/timer_wheel.hh
+ * @brief A hierarchical timing wheel over ticks
+ * 
+ * This file defines the timer_wheel class used by reactors to hold 
+ * elements -- typically goals -- until a given tick is reached without 
+ * having to look at them on every tick.
+ * 
+ * @ingroup transaction
+ */
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ * 
+ *  Copyright (c) 2011, MBARI.
+ *  All rights reserved.
+ * 
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ * 
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the TREX Project nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ * 
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef H_BITS_timer_wheel
+# define H_BITS_timer_wheel
+
+# include "../Tick.hh"
+
+# include <list>
+# include <algorithm>
+
+namespace TREX {
+  namespace transaction {
+    namespace details {
+      
+      /** @brief Hierarchical timing wheel
+       *
+       * @tparam Ty The type of the elements stored
+       * @tparam Bits log2 of the number of slots per level
+       * @tparam Levels number of levels of the wheel
+       *
+       * A timing wheel associates each element with a tick key and 
+       * releases the element when the wheel is advanced past this key. 
+       * Level @e l of the wheel has @c 2^Bits slots each covering 
+       * @c 2^(l*Bits) ticks; elements are inserted in the finest level 
+       * that can hold them and cascaded down to finer levels as the wheel 
+       * time progresses. Keys beyond the horizon of the coarsest level are 
+       * kept in an overflow list revisited once every @c 2^(Levels*Bits) 
+       * ticks.
+       *
+       * Insertion and removal are constant time and advancing the wheel 
+       * only touches the elements that are due or the slot being cascaded, 
+       * whatever the number of elements waiting further in the future. 
+       * Empty stretches of time are skipped at the granularity of the finest 
+       * non empty level.
+       *
+       * Elements are stored in @c std::list slots and moved between them 
+       * with @c splice so the handle returned on insertion remains valid 
+       * until the element is either released or erased.
+       *
+       * @ingroup transaction
+       */
+      template<typename Ty, unsigned Bits=6, unsigned Levels=4>
+      class timer_wheel {
+        struct entry;
+        typedef std::list<entry> slot_type;
+        
+      public:
+        typedef Ty value_type;
+        typedef typename slot_type::iterator handle;
+        
+        /** @brief Constructor 
+         *
+         * @param[in] now The initial wheel time
+         *
+         * @post the wheel is empty
+         */
+        explicit timer_wheel(TICK now=0):m_now(now), m_size(0) {
+          std::fill(m_count, m_count+Levels+1, 0);
+        }
+        /** @brief Destructor */
+        ~timer_wheel() {}
+        
+        /** @brief Wheel time
+         *
+         * @return the first tick not yet reached by this wheel. All 
+         *         the elements with a key lower than this value have 
+         *         already been released
+         */
+        TICK now() const {
+          return m_now;
+        }
+        bool empty() const {
+          return 0==m_size;
+        }
+        size_t size() const {
+          return m_size;
+        }
+        
+        /** @brief Insert an element
+         *
+         * @param[in] key The tick at which @p val is due
+         * @param[in] val The element
+         *
+         * Insert @p val in the wheel. If @p key is lower than now() 
+         * then @p val will be released on the next call to advance
+         *
+         * @return a handle to the inserted element
+         *
+         * @sa erase(handle)
+         * @sa advance(TICK, std::list<Ty> &)
+         */
+        handle insert(TICK key, value_type const &val) {
+          m_spare.push_back(entry(key, val, &m_spare));
+          handle h = m_spare.end();
+          place(--h);
+          ++m_size;
+          return h;
+        }
+        /** @brief Element access
+         *
+         * @param[in] h A handle
+         *
+         * @pre @p h is a valid handle of this wheel
+         *
+         * @return the element referred by @p h
+         */
+        value_type &get(handle h) {
+          return h->value;
+        }
+        value_type const &get(handle h) const {
+          return h->value;
+        }
+        /** @brief Remove an element
+         *
+         * @param[in] h A handle
+         *
+         * @pre @p h is a valid handle of this wheel
+         * @post @p h is no longer valid
+         */
+        void erase(handle h) {
+          --m_count[h->level];
+          --m_size;
+          h->slot->erase(h);
+        }
+        /** @brief Advance the wheel
+         *
+         * @param[in] to A tick
+         * @param[out] due The released elements
+         *
+         * Move the wheel time to @p to (included) and append to @p due 
+         * all the elements whose key is not greater than @p to. The 
+         * handles of these elements are no longer valid.
+         *
+         * @post now() is greater than @p to
+         */
+        void advance(TICK to, std::list<value_type> &due) {
+          while( m_now<=to ) {
+            if( 0==m_size ) {
+              m_now = to+1;
+              return;
+            }
+            unsigned l = 0;
+            while( l<Levels && 0==m_count[l] )
+              ++l;
+            if( 0==l ) {
+              release(m_wheel[0][m_now&mask], due);
+              ++m_now;
+            } else {
+              // Nothing in the finer levels : jump directly to the
+              // next slot of level l
+              TICK next = ((m_now>>(Bits*l))+1)<<(Bits*l);
+              m_now = std::min(next, to+1);
+            }
+            if( 0==(m_now&mask) )
+              cascade();
+          }
+        }
+        
+      private:
+        static TICK const slots = TICK(1)<<Bits;
+        static TICK const mask = slots-1;
+        
+        struct entry {
+          entry(TICK k, value_type const &v, slot_type *s)
+            :key(k), value(v), level(0), slot(s) {}
+          
+          TICK       key;
+          value_type value;
+          unsigned   level;
+          slot_type *slot;
+        }; // TREX::transaction::details::timer_wheel<>::entry
+        
+        void place(handle h) {
+          TICK k = std::max(h->key, m_now);
+          unsigned l = 0;
+          slot_type *dest = &m_overflow;
+          
+          for( ; l<Levels; ++l) {
+            if( (k>>(Bits*(l+1)))==(m_now>>(Bits*(l+1))) ) {
+              dest = &(m_wheel[l][(k>>(Bits*l))&mask]);
+              break;
+            }
+          }
+          ++m_count[l];
+          h->level = l;
+          if( dest!=h->slot ) {
+            dest->splice(dest->end(), *(h->slot), h);
+            h->slot = dest;
+          }
+        }
+        
+        void release(slot_type &s, std::list<value_type> &due) {
+          m_count[0] -= s.size();
+          m_size -= s.size();
+          for(handle i=s.begin(); s.end()!=i; ++i)
+            due.push_back(i->value);
+          s.clear();
+        }
+        
+        void redistribute(slot_type &s, unsigned l) {
+          m_count[l] -= s.size();
+          for(handle i=s.begin(); s.end()!=i; ) {
+            handle cur = i++;
+            place(cur);
+          }
+        }
+        
+        void cascade() {
+          if( 0==(m_now&((TICK(1)<<(Bits*Levels))-1)) ) 
+            redistribute(m_overflow, Levels);
+          for(unsigned l=Levels-1; l>0; --l) 
+            if( 0==(m_now&((TICK(1)<<(Bits*l))-1)) )
+              redistribute(m_wheel[l][(m_now>>(Bits*l))&mask], l);
+        }
+        
+        TICK      m_now;
+        size_t    m_size;
+        size_t    m_count[Levels+1];
+        slot_type m_wheel[Levels][1<<Bits];
+        slot_type m_overflow;
+        slot_type m_spare;
+        
+        // non copyable : handles would refer to the original slots
+        timer_wheel(timer_wheel const &);
+        timer_wheel &operator= (timer_wheel const &);
+      }; // TREX::transaction::details::timer_wheel<>
+      
+    } // TREX::transaction::details
+  } // TREX::transaction
+} // TREX
+
+#endif // H_BITS_timer_wheel
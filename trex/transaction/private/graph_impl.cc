@@ -78,6 +78,19 @@ tlog::stream details::graph_impl::syslog(Symbol const &ctx,
 }
 
 
+tlog::record details::graph_impl::record(tlog::format const &fmt,
+                                         Symbol const &ctx,
+                                         Symbol const &kind) const {
+  boost::optional<date_type> cur = get_date();
+  tlog::record ret = m_log->record(fmt, m_name, kind);
+  
+  if( !ctx.empty() )
+    ret.source(ctx);
+  if( cur )
+    ret.date(*cur);
+  return ret;
+}
+
 details::node_id details::graph_impl::create_node() {
   SHARED_PTR<graph_impl> me = shared_from_this();
   SHARED_PTR<node_impl> ret(new node_impl(me));
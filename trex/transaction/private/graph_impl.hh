@@ -35,6 +35,7 @@
 # define H_trex_transaction_graph_impl
 
 # include "clock_impl.hh"
+# include <trex/utils/latency_histogram.hh>
 # include <set>
 
 
@@ -136,6 +137,22 @@ namespace TREX {
          */
         utils::log::stream syslog(utils::Symbol const &ctx,
                                   utils::Symbol const &kind) const;
+        /** @brief Create a structured log record
+         *
+         * @param[in] fmt The message format
+         * @param[in] ctx A symbol giving the context of the message
+         * @param[in] kind A symbol indicating the type of message
+         *
+         * Create a new binary log record for the context @p ctx, 
+         * associated message type @p kind and dated with the current
+         * graph date
+         *
+         * @return A record that can receive the message arguments
+         * @sa syslog(utils::Symbol const &, utils::Symbol const &) const
+         */
+        utils::log::record record(utils::log::format const &fmt,
+                                  utils::Symbol const &ctx,
+                                  utils::Symbol const &kind) const;
         /** @brief graph log manager
          *
          * @return The log manager for this graph
@@ -156,6 +173,14 @@ namespace TREX {
         boost::asio::strand &strand() const {
           return *m_strand;
         }
+        /** @brief Latency metrics
+         *
+         * @return The registry that collects the latency histograms of 
+         * this graph reactors
+         */
+        utils::latency_registry &latency() {
+          return m_latency;
+        }
         /** @brief Create a new transaction node
          *
          * This method creates a new node that is associated 
@@ -205,6 +230,11 @@ namespace TREX {
          * of its structure
          */
         UNIQ_PTR<boost::asio::strand>          m_strand;
+        /** @brief Latency metrics
+         *
+         * The histograms of the reactors execution phases durations
+         */
+        utils::latency_registry                m_latency;
 
         std::set< SHARED_PTR<node_impl> > m_nodes;
         
@@ -35,6 +35,8 @@
 #include "private/graph_impl.hh"
 #include "TeleoReactor.hh"
 
+#include <trex/utils/json_writer.hh>
+
 #include <boost/date_time/posix_time/posix_time_io.hpp>
 
 #undef WITH_MAKE_SHARED
@@ -166,7 +168,7 @@ graph::graph()
 #else 
 :m_impl(new details::graph_impl)
 #endif
-{}
+, m_topology(0) {}
 
 graph::graph(utils::Symbol const &name, TICK init, bool verbose)
 #ifdef WITH_MAKE_SHARED
@@ -174,7 +176,7 @@ graph::graph(utils::Symbol const &name, TICK init, bool verbose)
 #else 
 :m_impl(new details::graph_impl(name))
 #endif
-, m_verbose(verbose) {
+, m_verbose(verbose), m_topology(0) {
   m_impl->set_date(init);
 }
 
@@ -185,7 +187,7 @@ graph::graph(utils::Symbol const &name, boost::property_tree::ptree &conf,
 #else
 :m_impl(new details::graph_impl(name))
 #endif
-, m_verbose(verbose) {
+, m_verbose(verbose), m_topology(0) {
   m_impl->set_date(init);
   
   size_t number = add_reactors(conf);
@@ -202,6 +204,26 @@ TREX::utils::log::stream graph::syslog(utils::Symbol const &context,
   return m_impl->syslog(context, kind);
 }
 
+TREX::utils::log::record graph::record(utils::log::format const &fmt,
+                                       utils::Symbol const &context,
+                                       utils::Symbol const &kind) const {
+  return m_impl->record(fmt, context, kind);
+}
+
+TREX::utils::latency_registry &graph::latency() const {
+  return m_impl->latency();
+}
+
+size_t graph::topology_version() const {
+  utils::SharedVar<size_t>::scoped_lock lock(m_topology);
+  return *m_topology;
+}
+
+void graph::topology_changed() const {
+  utils::SharedVar<size_t>::scoped_lock lock(m_topology);
+  *m_topology += 1;
+}
+
 bool graph::is_isolated(graph::reactor_id r) const {
   return m_quarantined.find(r->getName())!=m_quarantined.end();
 }
@@ -255,6 +277,7 @@ void graph::clear() {
     m_reactors.pop_front();
   } 
   m_quarantined.clear();
+  topology_changed();
 }
 
 long graph::index(graph::reactor_id id) const {
@@ -273,9 +296,10 @@ graph::reactor_id graph::add_reactor(boost::property_tree::ptree::value_type &de
   SHARED_PTR<TeleoReactor> tmp(m_factory->produce(arg));
   std::pair<details::reactor_set::iterator, bool> ret = m_reactors.insert(tmp);
 
-  if( ret.second ) 
+  if( ret.second ) {
     syslog(info)<<"Reactor \""<<tmp->getName()<<"\" created.";
-  else
+    topology_changed();
+  } else
     throw MultipleReactors(*this, **(ret.first));			   
   return ret.first->get();
 }
@@ -284,6 +308,8 @@ graph::reactor_id graph::add_reactor(graph::reactor_id r) {
   SHARED_PTR<TeleoReactor> tmp(r);
   std::pair<details::reactor_set::iterator, bool> ret = m_reactors.insert(tmp);
   // As it is an internal call make is silent for now ...
+  if( ret.second )
+    topology_changed();
   return ret.first->get();
 }
 
@@ -332,6 +358,7 @@ bool graph::kill_reactor(graph::reactor_id r) {
       // std::cerr<<"Erase the reactor"<<std::endl;
       m_reactors.erase(pos);
       /// std::cerr<<"Done."<<std::endl;
+      topology_changed();
       return true;
     }
   }
@@ -345,6 +372,7 @@ graph::reactor_id graph::isolate(graph::reactor_id r) const {
       syslog(info)<<"Putting reactor\""<<r->getName()<<"\" in quarantine.";
       r->isolate();
       m_quarantined.insert(*pos);
+      topology_changed();
       return r;
     }
   }
@@ -405,6 +433,33 @@ goal_id graph::parse_goal(boost::property_tree::ptree::value_type goal) const {
   return goal_id(new Goal(goal));
 }
 
+size_t graph::parse_goals(boost::property_tree::ptree &goals,
+                          std::list<goal_id> &out) const {
+  // create the handlers once for the whole batch
+  DateHandler date_parser("date", *this);
+  DurationHandler duration_parser("duration", *this);
+  size_t failed = 0;
+  
+  for(boost::property_tree::ptree::iterator i=goals.begin();
+      goals.end()!=i; ++i) {
+    if( i->first.empty() || utils::is_tag(*i, "Goal") ) {
+      try {
+        out.push_back(goal_id(new Goal(*i)));
+      } catch(utils::Exception const &e) {
+        syslog(warn)<<"Failed to parse goal: "<<e;
+        ++failed;
+      } catch(std::exception const &se) {
+        syslog(warn)<<"Failed to parse goal: "<<se.what();
+        ++failed;
+      } catch(...) {
+        syslog(warn)<<"Failed to parse goal: unknown exception";
+        ++failed;
+      }
+    }
+  }
+  return failed;
+}
+
 namespace bp=boost::property_tree;
 
 namespace TREX {
@@ -424,7 +479,7 @@ namespace TREX {
         if( dom.hasLower() )
           TREX::utils::set_attr(tmp, "min", date_export(g,dom.lowerBound()));
         if( dom.hasUpper() )
-          TREX::utils::set_attr(tmp, "max", date_export(g,dom.lowerBound()));
+          TREX::utils::set_attr(tmp, "max", date_export(g,dom.upperBound()));
       }
       TREX::utils::set_attr(ret, "type", "date");
       return ret;
@@ -456,6 +511,42 @@ namespace TREX {
   }
 }
 
+namespace {
+  
+  /** @brief json date or duration variable
+   *
+   * Write the variable @p name with the domain @p dom into @p out. 
+   * The output is the same as date_export or duration_export with the 
+   * name attribute set.
+   */
+  void json_export(utils::json_writer &out, graph const &g, bool date,
+                   std::string const &name, IntegerDomain const &dom) {
+    std::string const type(date?"date":"duration");
+    std::string (*fmt)(graph const &, IntegerDomain::bound const &);
+    
+    if( date )
+      fmt = &date_export;
+    else
+      fmt = &duration_export;
+    
+    out.begin_object();
+    out.key(type).begin_object();
+    if( dom.isSingleton() )
+      out.key("value").value(fmt(g, dom.lowerBound()));
+    else {
+      if( dom.hasLower() )
+        out.key("min").value(fmt(g, dom.lowerBound()));
+      if( dom.hasUpper() )
+        out.key("max").value(fmt(g, dom.upperBound()));
+    }
+    out.end_object();
+    out.key("type").value(type);
+    out.key("name").value(name);
+    out.end_object();
+  }
+  
+}
+
 TICK graph::as_date(std::string const &str) const {
   return timeToTick(utils::string_cast<date_type>(str));
 }
@@ -504,6 +595,24 @@ boost::property_tree::ptree graph::export_goal(goal_id const &g) const {
   return ret;
 }
 
+void graph::export_goal(goal_id const &g, utils::json_writer &out) const {
+  out.begin_object();
+  out.key("on").value(g->object().str());
+  out.key("pred").value(g->predicate().str());
+  out.key("Variable").begin_array();
+  for(Predicate::const_iterator i=g->begin(); g->end()!=i; ++i)
+    i->second.to_json(out);
+  if( !g->getStart().isFull() )
+    json_export(out, *this, true, "start", g->getStart());
+  if( !g->getEnd().isFull() )
+    json_export(out, *this, true, "end", g->getEnd());
+  if( g->getDuration().hasUpper() ||
+      g->getDuration().lowerBound()!=Goal::s_durationDomain.lowerBound() )
+    json_export(out, *this, false, "duration", g->getDuration());
+  out.end_array();
+  out.end_object();
+}
+
 
 
 /*
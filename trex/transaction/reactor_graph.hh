@@ -38,6 +38,8 @@
 # include "bits/timeline.hh"
 
 # include <trex/utils/TimeUtils.hh>
+# include <trex/utils/SharedVar.hh>
+# include <trex/utils/latency_histogram.hh>
 
 # include <boost/graph/graph_traits.hpp>
 # include <boost/graph/adjacency_iterator.hpp>
@@ -487,6 +489,19 @@ namespace TREX {
        * @sa kill_reactor(reactor_id)
        */
       size_t cleanup();
+      /** @brief Graph structure version
+       *
+       * Indicates the current version of the graph structure. This value
+       * is incremented each time the structure of the graph changes: a
+       * reactor is added, isolated or killed or a timeline relation is
+       * created or removed.
+       *
+       * It allows to cache information extracted from the graph structure
+       * and only refresh it when the graph changed.
+       *
+       * @return the current version of the graph structure
+       */
+      size_t topology_version() const;
       
       TICK as_date(std::string const &str) const;
       TICK as_duration(std::string const &str, bool up=false) const;
@@ -662,7 +677,46 @@ namespace TREX {
       }
       
       goal_id parse_goal(boost::property_tree::ptree::value_type goal) const;
+      /** @brief Parse a batch of goals
+       *
+       * @param[in] goals A goals container
+       * @param[out] out Where to append the parsed goals
+       *
+       * Parse all the goals in @p goals. These can be either @c Goal tags,
+       * as found in the XML form:
+       * @code
+       * <Goals>
+       *   <Goal on="navigator" pred="At"> ... </Goal>
+       *   ...
+       * </Goals>
+       * @endcode
+       * or the elements of a json array:
+       * @code
+       * { "Goals": [ { "on": "navigator", "pred": "At", ... }, ... ] }
+       * @endcode
+       * The other entries of @p goals are ignored. A goal that fails to 
+       * parse is reported in the log and skipped.
+       *
+       * @return The number of goals that failed to parse
+       *
+       * @sa parse_goal(boost::property_tree::ptree::value_type) const
+       */
+      size_t parse_goals(boost::property_tree::ptree &goals,
+                         std::list<goal_id> &out) const;
       boost::property_tree::ptree export_goal(goal_id const &g) const;
+      /** @brief Streaming goal export
+       *
+       * @param[in] g A goal
+       * @param[in,out] out A json writer
+       *
+       * Write into @p out the json object describing @p g with its 
+       * temporal attributes formatted as dates and durations. This is 
+       * the content of export_goal(g) under its @c Goal tag, written 
+       * without building a property tree.
+       *
+       * @sa export_goal(goal_id const &) const
+       */
+      void export_goal(goal_id const &g, utils::json_writer &out) const;
       
       
       boost::asio::strand &strand();
@@ -672,6 +726,30 @@ namespace TREX {
       utils::log::stream syslog(utils::log::id_type const &kind=null) const {
         return syslog(null, kind);
       }
+      /** @brief Create a structured log record
+       *
+       * @param[in] fmt The message format
+       * @param[in] context The message context
+       * @param[in] kind The message type
+       *
+       * Similar to syslog but produces a binary record in @c TREX.blog
+       * that stores the message arguments without formatting them
+       *
+       * @sa syslog(utils::log::id_type const &, utils::log::id_type const &) const
+       * @sa utils::log::record
+       */
+      utils::log::record record(utils::log::format const &fmt,
+                                utils::log::id_type const &context,
+                                utils::log::id_type const &kind) const;
+      /** @brief Latency metrics
+       *
+       * @return The registry of latency histograms for the different 
+       * execution phases of this graph reactors. It can be queried at
+       * any time for the summary of the last window of ticks.
+       *
+       * @sa TeleoReactor::latency_phase
+       */
+      utils::latency_registry &latency() const;
 
     protected:
       reactor_id add_reactor(reactor_id r);
@@ -737,6 +815,18 @@ namespace TREX {
        * @sa internal_check(reactor_id r, details::timeline const &)
        */
       virtual void external_check(reactor_id r, details::timeline const &tl) {}
+      /** @brief Reactor wake up
+       *
+       * @param[in] r An event driven reactor
+       *
+       * This method is called within the graph strand when the event driven
+       * reactor @p r received a new event (goal, recall, plan token or
+       * observation). It can be used by derived classes to schedule this
+       * reactor for deliberation without polling it.
+       *
+       * @sa TeleoReactor::is_event_driven() const
+       */
+      virtual void wakeup(reactor_id r) {}
       
     private:
       
@@ -757,6 +847,9 @@ namespace TREX {
       TREX::utils::SingletonUse<xml_factory>             m_factory;
       
       mutable details::reactor_set m_quarantined;
+      mutable TREX::utils::SharedVar<size_t> m_topology;
+      
+      void topology_changed() const;
       
       friend class TeleoReactor;
       friend class timelines_listener;
@@ -78,6 +78,8 @@ LogManager::~LogManager() {
   boost::posix_time::ptime now(boost::posix_time::second_clock::universal_time());
   
   syslog("", log::info)<<">>> End of log at "<<boost::posix_time::to_simple_string(now)<<" UTC <<<";
+  if( m_trex_blog )
+    m_trex_blog->close();
   m_out.reset();
   m_log.reset();
   m_err.reset();
@@ -87,6 +89,8 @@ LogManager::~LogManager() {
 
 void LogManager::flush() {
   m_trex_log->flush();
+  if( m_trex_blog )
+    m_trex_blog->flush();
 }
 
 
@@ -164,7 +168,7 @@ LogManager::path_type const &LogManager::logPath() {
     } else if( !is_directory(m_path) ) { 
       create_directory(m_path);
     }
-    path_type cfg(m_path), trex_log(m_path);
+    path_type cfg(m_path), trex_log(m_path), trex_blog(m_path);
     cfg /= "cfg";
     create_directory(cfg);
     
@@ -172,6 +176,10 @@ LogManager::path_type const &LogManager::logPath() {
     m_trex_log.reset(new log::out_file(trex_log.string()));
     m_syslog.direct_connect(m_syslog.stranded(*m_trex_log).track_foreign(m_trex_log));
     
+    trex_blog /= TREX_BLOG_FILE;
+    m_trex_blog.reset(new log::binary_file(trex_blog.string(), m_io.service()));
+    m_trex_blog->start();
+    
     thread_count(2);
     
     syslog("", log::null)<<"TREX version "<<TREX::version::full_str();
@@ -48,6 +48,7 @@
 
 # include "log/log_pipe.hh"
 # include "log/out_file.hh"
+# include "log/binary_file.hh"
 # include "asio_runner.hh"
 
 # include "SingletonUse.hh"
@@ -64,6 +65,16 @@
  */
 # define TREX_LOG_FILE "TREX.log"
 
+/** @brief Default binary log file name
+ *
+ * This macro is used by LogManager. It gives the name of the log
+ * file to create for logging structured binary records.
+ *
+ * @relates TREX::utils::LogManager
+ * @sa TREX::utils::log::record
+ */
+# define TREX_BLOG_FILE "TREX.blog"
+
 /** @brief Home environment variable
  *
  * The name of the environment variable that indicates where TREX is located.
@@ -247,6 +258,33 @@ namespace TREX {
                          log::id_type const &kind=log::null) {
         return m_syslog(when, who, kind);
       }
+      /** @brief Create a structured log record
+       *
+       * @param[in] fmt The message format
+       * @param[in] who The message source
+       * @param[in] kind The message type
+       *
+       * Create a new record for @c TREX.blog. As opposed to syslog, the
+       * record stores the raw arguments of the message which makes it
+       * much cheaper for messages produced at high rate.
+       *
+       * @return the new record
+       * @sa log::record
+       */
+      log::record record(log::format const &fmt, log::id_type const &who,
+                         log::id_type const &kind=log::null) {
+        log::record ret(m_trex_blog.get(), fmt, kind);
+        if( !who.empty() )
+          ret.source(who);
+        return ret;
+      }
+      log::record record(log::entry::date_type const &when,
+                         log::format const &fmt, log::id_type const &who,
+                         log::id_type const &kind=log::null) {
+        log::record ret = record(fmt, who, kind);
+        ret.date(when);
+        return ret;
+      }
       void flush();
       
       template<typename Handler>
@@ -395,6 +433,8 @@ namespace TREX {
       /** @brief syslog text log file */
       log::text_log   m_syslog;
       SHARED_PTR<log::out_file> m_trex_log;
+      /** @brief structured binary log file */
+      SHARED_PTR<log::binary_file> m_trex_blog;
       SHARED_PTR<log::log_pipe> m_out, m_err, m_log;
       
       /** @brief verbosity level */
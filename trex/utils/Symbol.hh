@@ -53,14 +53,11 @@
 
 # include <string>
 
-# include <boost/flyweight.hpp>
-# include <boost/flyweight/no_tracking.hpp>
-# include <boost/flyweight/holder_tag.hpp>
-
 # include "IOstreamable.hh"
 # include "Hashable.hh"
 # include "StringExtract.hh"
 # include "SingletonUse.hh"
+# include "bits/symbol_table.hh"
 
 namespace TREX {
   namespace utils {
@@ -74,22 +71,6 @@ namespace TREX {
       }
     };
     
-    struct trex_holder_specifier :boost::flyweights::holder_marker {
-      template<typename C>
-      struct apply {
-        typedef trex_holder_class<C> type;
-      };
-    };
-    
-  }
-}
-
-namespace boost {
-  namespace flyweights {
-    
-    template<>
-    struct is_holder<TREX::utils::trex_holder_specifier> :boost::mpl::true_ {};
-    
   }
 }
 
@@ -105,9 +86,11 @@ namespace TREX {
      *
      * This class offer a generic symbol class definition.
      * A symbol is a a string access point ensuring that there's
-     * no more than one string value stored in memory. It relies
-     * on a unique reference memory managed by a reference counter
-     * to ensure both equality efficiency and better memory management.
+     * no more than one string value stored in memory. It refers to
+     * a unique entry of a global interning table which also holds the
+     * precomputed hash and length of the string. Therefore equality
+     * and hashing are constant time operations independent of the
+     * string length.
      *
      *
      * @author Frederic Py <fpy@mbari.org>
@@ -122,21 +105,17 @@ namespace TREX {
       typedef std::basic_string<CharT, Traits, Alloc> str_type;
       
     private:
-      /** @brief the symbol value
-       *
-       * @note I have purposedly set the policy to @c no_tracking.
-       * This implies that all symbol created will remain in
-       * memory until the end of the program. This make sense as
-       * these symbols will be used all along the agent lifetime
-       * but if you think it implies an increasing memory usage you
-       * can change it back by removing this.
-       * @note @c intermodule_holder is used to support dynmic
+      /** @brief the symbol table
+       *
+       * @note Entries of this table are never removed. This implies 
+       * that all symbol created will remain in memory until the end 
+       * of the program. This make sense as these symbols will be used 
+       * all along the agent lifetime.
+       * @note The table is held by a singleton to support dynamic
        * libraries loading (and/or plug-ins)
        */
-      typedef typename
-      boost::flyweight< str_type,
-      boost::flyweights::no_tracking,
-      boost::flyweights::holder<trex_holder_specifier> > ref_type;
+      typedef details::symbol_table<str_type> table_type;
+      typedef typename table_type::entry const *ref_type;
       
     public:
       /** @brief Constructor
@@ -207,14 +186,14 @@ namespace TREX {
        * @sa size_t length() const
        */
       bool empty() const {
-        return m_name.get().empty();
+        return NULL==m_name;
       }
       /** @brief Symbol length
        *
        * @return the length of the string representing this instance
        */
       size_t length() const {
-        return size_t(empty()?0:m_name.get().size());
+        return empty()?0:m_name->length;
       }
       
       /** @brief Equality test
@@ -309,7 +288,7 @@ namespace TREX {
        * @return the equivalent string value to this instance
        */
       str_type const &str() const {
-        return m_name.get();
+        return empty()?s_empty:m_name->value;
       }
       
       CharT const *c_str() const {
@@ -320,6 +299,8 @@ namespace TREX {
     private:
       /** @brief symbol value */
       ref_type m_name;
+      /** @brief value of empty symbols */
+      static str_type const s_empty;
       /** @brief Symbol creation
        *
        * @param str A string
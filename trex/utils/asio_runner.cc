@@ -34,6 +34,20 @@
 #include "asio_runner.hh"
 #include "cpu_clock.hh"
 #include "chrono_helper.hh"
+#include "Exception.hh"
+
+#include <sstream>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
+
+#ifdef __linux__
+# include <pthread.h>
+# include <sched.h>
+# include <sys/resource.h>
+# include <sys/syscall.h>
+# include <unistd.h>
+#endif // __linux__
 
 using namespace TREX::utils;
 using namespace boost::asio;
@@ -81,23 +95,112 @@ namespace {
 
 # endif 
 
+/*
+ * class TREX::utils::thread_placement
+ */
+
+// modifiers
+
+void thread_placement::cpus(std::string const &spec) {
+  std::set<unsigned> result;
+  std::vector<std::string> items;
+  
+  boost::split(items, spec, boost::is_any_of(","));
+  try {
+    for(std::vector<std::string>::iterator i=items.begin(); items.end()!=i; ++i) {
+      boost::trim(*i);
+      if( i->empty() )
+        continue;
+      
+      size_t dash = i->find('-');
+      unsigned lo, hi;
+      
+      if( std::string::npos==dash )
+        lo = hi = boost::lexical_cast<unsigned>(*i);
+      else {
+        lo = boost::lexical_cast<unsigned>(boost::trim_copy(i->substr(0, dash)));
+        hi = boost::lexical_cast<unsigned>(boost::trim_copy(i->substr(dash+1)));
+      }
+      if( hi<lo )
+        throw Exception("Invalid cpu range \""+(*i)+"\"");
+      for( ; lo<=hi; ++lo)
+        result.insert(lo);
+    }
+  } catch(boost::bad_lexical_cast const &) {
+    throw Exception("Invalid cpu list \""+spec+"\"");
+  }
+  m_cpus.swap(result);
+}
+
+// observers
+
+bool thread_placement::apply() const {
+  bool ret = true;
+#ifdef __linux__
+  if( !m_cpus.empty() ) {
+    cpu_set_t set;
+    
+    CPU_ZERO(&set);
+    for(std::set<unsigned>::const_iterator i=m_cpus.begin(); m_cpus.end()!=i; ++i)
+      if( *i<CPU_SETSIZE )
+        CPU_SET(*i, &set);
+    ret = 0==pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+  }
+  if( m_renice ) {
+    // on linux niceness is a per thread attribute 
+    pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+    ret = (0==setpriority(PRIO_PROCESS, tid, m_nice)) && ret;
+  }
+#else
+  // not supported : just report failure if something was requested
+  ret = empty();
+#endif // __linux__
+  return ret;
+}
+
+std::string thread_placement::str() const {
+  std::ostringstream oss;
+  
+  if( m_cpus.empty() )
+    oss<<"any cpu";
+  else {
+    oss<<"cpus {";
+    for(std::set<unsigned>::const_iterator i=m_cpus.begin(); m_cpus.end()!=i; ++i) {
+      if( m_cpus.begin()!=i )
+        oss<<',';
+      oss<<*i;
+    }
+    oss<<'}';
+  }
+  if( m_renice )
+    oss<<", nice "<<m_nice;
+  return oss.str();
+}
+
 /*
  * class TREX::utils::asio_runner
  */
 
 // structors 
 
-asio_runner::asio_runner() {
+asio_runner::asio_runner():m_started(0), m_failed(0) {
   // Create a work for maintaining our service 
   m_active.reset(new io_service::work(m_io));
 }
 
-asio_runner::asio_runner(size_t n_threads) {
+asio_runner::asio_runner(size_t n_threads):m_started(0), m_failed(0) {
   m_active.reset(new io_service::work(m_io));
   if( n_threads>0 )
     thread_count(n_threads);
 }
 
+asio_runner::asio_runner(size_t n_threads, thread_placement const &where)
+  :m_placement(where), m_started(0), m_failed(0) {
+  m_active.reset(new io_service::work(m_io));
+  if( n_threads>0 )
+    thread_count(n_threads, true);
+}
+
 
 asio_runner::~asio_runner() {
   // complete our work so threads can complete
@@ -129,8 +232,14 @@ size_t asio_runner::thread_count(size_t n, bool override_hw) {
 }
 
 void asio_runner::spawn(size_t n) {
+  boost::mutex::scoped_lock lock(m_mtx);
+  size_t target = m_started+n;
+  
   for(size_t i=0; i<n; ++i) 
     m_threads.create_thread(boost::bind(&asio_runner::thread_task, this));
+  // wait for the new threads to be placed 
+  while( m_started<target )
+    m_placed.wait(lock);
 }
 
 #undef CHECK_INTERRUPTED
@@ -143,6 +252,15 @@ void asio_runner::spawn(size_t n) {
 #endif // BOOST_VERSION
 
 void asio_runner::thread_task() {
+  {
+    bool placed = m_placement.apply();
+    boost::mutex::scoped_lock lock(m_mtx);
+    
+    m_started += 1;
+    if( !placed )
+      m_failed += 1;
+    m_placed.notify_all();
+  }
 #ifdef CHECK_INTERRUPTED
   bool interrupted;
   do {
@@ -46,9 +46,97 @@
 # include <boost/smart_ptr.hpp>
 # include <boost/thread.hpp>
 
+# include <set>
+# include <string>
+
 namespace TREX {
   namespace utils {
     
+    /** @brief Thread placement 
+     *
+     * Describes on which CPUs and with which scheduling niceness a thread 
+     * should execute. It is used by asio_runner to isolate the threads 
+     * of a service from the others -- for example to keep a reactor 
+     * handling vehicle I/O away from the cores used by a planner.
+     *
+     * Placement is only effective on platforms that support it (currently 
+     * Linux) and is otherwise silently ignored.
+     *
+     * @ingroup utils
+     * @sa asio_runner
+     */
+    class thread_placement {
+    public:
+      /** @brief Constructor 
+       *
+       * @post the placement is empty
+       */
+      thread_placement():m_renice(false), m_nice(0) {}
+      /** @brief Destructor */
+      ~thread_placement() {}
+      
+      /** @brief Check if empty 
+       *
+       * @retval true if this placement does not constrain threads
+       * @retval false otherwise
+       */
+      bool empty() const {
+        return m_cpus.empty() && !m_renice;
+      }
+      
+      /** @brief Set CPU affinity 
+       *
+       * @param[in] spec A CPU list specification
+       *
+       * Set the CPUs a thread is allowed to run on. The specification 
+       * is a comma separated list of CPU indexes or ranges such as 
+       * @c "0-3,6". An empty specification removes any affinity.
+       *
+       * @throw Exception @p spec is not a valid CPU list
+       */
+      void cpus(std::string const &spec);
+      /** @brief CPU affinity
+       *
+       * @return the set of CPUs threads are restricted to. An empty set 
+       *  indicates no restriction
+       */
+      std::set<unsigned> const &cpus() const {
+        return m_cpus;
+      }
+      /** @brief Set niceness 
+       *
+       * @param[in] n A nice value
+       *
+       * Set the scheduling niceness of the thread to @p n. As for the 
+       * @c nice command a lower value gives a higher priority and negative 
+       * values generally require extra privileges.
+       */
+      void nice(int n) {
+        m_renice = true;
+        m_nice = n;
+      }
+      
+      /** @brief Apply placement
+       *
+       * Apply this placement to the calling thread.
+       *
+       * @retval true if the placement was successfully applied or is empty
+       * @retval false if the platform refused or does not support it
+       */
+      bool apply() const;
+      
+      /** @brief Text description 
+       *
+       * @return a human readable description of this placement
+       */
+      std::string str() const;
+      
+    private:
+      std::set<unsigned> m_cpus;
+      bool               m_renice;
+      int                m_nice;
+    }; // TREX::utils::thread_placement
+    
     /** @brief Boost Asio service manager
      *
      * This class manages the creation and execution of and asio service 
@@ -76,6 +164,18 @@ namespace TREX {
        */
       asio_runner();
       explicit asio_runner(size_t n_threads);
+      /** @brief Contructor 
+       *
+       * @param[in] n_threads The number of threads to spawn
+       * @param[in] where The placement of the threads
+       *
+       * Create a new instance with @p n_threads threads -- not limited by 
+       * the hardware concurrency -- that execute according to @p where.
+       *
+       * @post all the threads were spawned and placed 
+       * @sa placement_failures() const
+       */
+      asio_runner(size_t n_threads, thread_placement const &where);
       /** @brief Destructor 
        *
        * This destructor will join all the threads this instance had created
@@ -131,6 +231,23 @@ namespace TREX {
        */
       size_t thread_count(size_t n, bool override_hw=false);
       
+      /** @brief Thread placement 
+       *
+       * @return the placement applied to the threads of this instance
+       */
+      thread_placement const &placement() const {
+        return m_placement;
+      }
+      /** @brief Failed placements
+       *
+       * @return the number of threads of this instance on which the 
+       *         placement could not be applied
+       */
+      size_t placement_failures() const {
+        boost::mutex::scoped_lock lock(m_mtx);
+        return m_failed;
+      }
+      
     private:
       void spawn(size_t n_threads);
       
@@ -141,6 +258,11 @@ namespace TREX {
       boost::asio::io_service m_io;
       boost::scoped_ptr<boost::asio::io_service::work> m_active;
       boost::thread_group m_threads;
+      
+      thread_placement          m_placement;
+      mutable boost::mutex      m_mtx;
+      boost::condition_variable m_placed;
+      size_t                    m_started, m_failed;
     }; // TREX::utils::asio_runner
     
     /** @brief synchronize asynchronous call
@@ -46,21 +46,25 @@
  * class TREX::utils::BasicSymbol<>
  */ 
 // statics
+template<class CharT, class Traits, class Alloc> 
+typename BasicSymbol<CharT, Traits, Alloc>::str_type const
+BasicSymbol<CharT, Traits, Alloc>::s_empty;
+
 template<class CharT, class Traits, class Alloc> 
 typename BasicSymbol<CharT, Traits, Alloc>::ref_type
 BasicSymbol<CharT, Traits, Alloc>::create
 (typename BasicSymbol<CharT, Traits, Alloc>::str_type const &str) {
   if( str.empty() )
-    return ref_type();
+    return NULL;
   else 
-    return ref_type(str);
+    return trex_holder_class<table_type>::get().intern(str);
 }
 
 template<class CharT, class Traits, class Alloc> 
 typename BasicSymbol<CharT, Traits, Alloc>::ref_type
 BasicSymbol<CharT, Traits, Alloc>::create(CharT const *str, size_t len) {
   if( NULL==str || 0==len )
-    return ref_type();
+    return NULL;
   else if( str_type::npos==len )
     return create(str_type(str));
   else
@@ -72,15 +76,16 @@ BasicSymbol<CharT, Traits, Alloc>::create(CharT const *str, size_t len) {
 template<class CharT, class Traits, class Alloc> 
 bool BasicSymbol<CharT, Traits, Alloc>::operator< 
 (BasicSymbol<CharT, Traits, Alloc> const &other) const {
+  // Keep the lexical order as it defines the order of attributes
+  // and timelines in the agent outputs
   return !other.empty() &&
     ( empty() ||( m_name!=other.m_name &&
-		  m_name.get()<other.m_name.get() ) );
+		  m_name->value<other.m_name->value ) );
 }
 
 template<class CharT, class Traits, class Alloc> 
 size_t BasicSymbol<CharT, Traits, Alloc>::hash() const {
-  boost::hash<str_type> href;
-  return href(m_name.get());
+  return empty()?0:m_name->hash;
 }
 
 template<class CharT, class Traits, class Alloc> 
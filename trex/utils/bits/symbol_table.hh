@@ -0,0 +1,232 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ * 
+ *  Copyright (c) 2011, MBARI.
+ *  All rights reserved.
+ * 
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ * 
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the TREX Project nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ * 
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef H_trex_utils_symbol_table
+# define H_trex_utils_symbol_table
+
+# include <vector>
+
+# include <boost/noncopyable.hpp>
+# include <boost/functional/hash.hpp>
+# include <boost/thread/mutex.hpp>
+
+# include "../platform/atomic.hh"
+
+namespace TREX {
+  namespace utils {
+    namespace details {
+
+      /** @brief Symbol interning table
+       *
+       * @tparam Str The string type
+       *
+       * This class maintains the unique set of strings referred by
+       * BasicSymbol instances. Each string is stored once in an entry
+       * that is never moved nor destroyed until the table itself is
+       * destroyed -- which is at the end of the program -- allowing a
+       * symbol to be represented by a simple pointer to its entry.
+       *
+       * Lookups are lock-free: the buckets are published through
+       * atomic pointers and are only prepended to. Insertions of new
+       * strings are serialized by a mutex and, when the table needs to
+       * grow, a new bucket array is built and published while the older
+       * ones are kept alive for the readers that may still traverse them.
+       *
+       * @ingroup utils
+       * @relates class BasicSymbol
+       */
+      template<class Str>
+      class symbol_table :boost::noncopyable {
+      public:
+        /** @brief Symbol entry
+         *
+         * The unique representation of an interned string along with
+         * its precomputed hash and length
+         */
+        struct entry {
+          entry(Str const &s, size_t h)
+          :value(s), hash(h), length(s.size()) {}
+          
+          Str const    value;
+          size_t const hash;
+          size_t const length;
+        }; // TREX::utils::details::symbol_table<>::entry
+        
+        symbol_table();
+        ~symbol_table();
+        
+        /** @brief Intern a string
+         *
+         * @param[in] str A string
+         *
+         * Look for the entry corresponding to @p str and create it
+         * if it does not exist yet
+         *
+         * @return The unique entry for @p str
+         */
+        entry const *intern(Str const &str);
+        
+      private:
+        struct cell {
+          cell(entry const *e, cell *n):value(e), next(n) {}
+          
+          entry const *value;
+          cell        *next;
+        };
+        struct bucket_array {
+          explicit bucket_array(size_t n);
+          ~bucket_array();
+          
+          size_t const mask;
+          ATOMIC_NS::atomic<cell *> *slots;
+        };
+        
+        static entry const *find(bucket_array const *t, Str const &str, 
+                                 size_t h);
+        static void link(bucket_array *t, entry const *e);
+        void grow();
+        
+        ATOMIC_NS::atomic<bucket_array *> m_table;
+        
+        boost::mutex               m_mtx;
+        std::vector<entry *>       m_entries;
+        std::vector<bucket_array *> m_retired;
+        
+        static size_t const initial_size = 1024;
+      }; // TREX::utils::details::symbol_table<>
+      
+      /*
+       * class TREX::utils::details::symbol_table<>::bucket_array
+       */
+      template<class Str>
+      symbol_table<Str>::bucket_array::bucket_array(size_t n)
+      :mask(n-1), slots(new ATOMIC_NS::atomic<cell *>[n]) {
+        for(size_t i=0; i<n; ++i)
+          slots[i].store(NULL, ATOMIC_NS::memory_order_relaxed);
+      }
+
+      template<class Str>
+      symbol_table<Str>::bucket_array::~bucket_array() {
+        for(size_t i=0; i<=mask; ++i) {
+          cell *c = slots[i].load(ATOMIC_NS::memory_order_relaxed);
+          while( NULL!=c ) {
+            cell *tmp = c;
+            c = c->next;
+            delete tmp;
+          }
+        }
+        delete[] slots;
+      }
+      
+      /*
+       * class TREX::utils::details::symbol_table<>
+       */
+      template<class Str>
+      symbol_table<Str>::symbol_table()
+      :m_table(new bucket_array(initial_size)) {}
+      
+      template<class Str>
+      symbol_table<Str>::~symbol_table() {
+        delete m_table.load(ATOMIC_NS::memory_order_relaxed);
+        for(typename std::vector<bucket_array *>::iterator i=m_retired.begin();
+            m_retired.end()!=i; ++i)
+          delete *i;
+        for(typename std::vector<entry *>::iterator i=m_entries.begin();
+            m_entries.end()!=i; ++i)
+          delete *i;
+      }
+      
+      template<class Str>
+      typename symbol_table<Str>::entry const *
+      symbol_table<Str>::find(bucket_array const *t, Str const &str,
+                              size_t h) {
+        for(cell const *c=t->slots[h&t->mask].load(ATOMIC_NS::memory_order_acquire);
+            NULL!=c; c=c->next)
+          if( h==c->value->hash && str==c->value->value )
+            return c->value;
+        return NULL;
+      }
+      
+      template<class Str>
+      void symbol_table<Str>::link(bucket_array *t, entry const *e) {
+        ATOMIC_NS::atomic<cell *> &slot = t->slots[e->hash&t->mask];
+        // The cell is fully built before being published so readers
+        // never see a partial chain
+        slot.store(new cell(e, slot.load(ATOMIC_NS::memory_order_relaxed)),
+                   ATOMIC_NS::memory_order_release);
+      }
+      
+      template<class Str>
+      void symbol_table<Str>::grow() {
+        bucket_array *old = m_table.load(ATOMIC_NS::memory_order_relaxed),
+          *t = new bucket_array(2*(old->mask+1));
+        
+        for(typename std::vector<entry *>::const_iterator i=m_entries.begin();
+            m_entries.end()!=i; ++i)
+          link(t, *i);
+        m_table.store(t, ATOMIC_NS::memory_order_release);
+        // readers may still be traversing the old buckets
+        m_retired.push_back(old);
+      }
+      
+      template<class Str>
+      typename symbol_table<Str>::entry const *
+      symbol_table<Str>::intern(Str const &str) {
+        size_t h = boost::hash<Str>()(str);
+        entry const *ret = find(m_table.load(ATOMIC_NS::memory_order_acquire),
+                                str, h);
+        if( NULL==ret ) {
+          boost::mutex::scoped_lock lock(m_mtx);
+          bucket_array *t = m_table.load(ATOMIC_NS::memory_order_relaxed);
+          
+          // Another thread may have added it in the meantime
+          ret = find(t, str, h);
+          if( NULL==ret ) {
+            entry *e = new entry(str, h);
+            
+            m_entries.push_back(e);
+            if( m_entries.size()>t->mask+1 )
+              grow();
+            else
+              link(t, e);
+            ret = e;
+          }
+        }
+        return ret;
+      }
+      
+    } // TREX::utils::details
+  } // TREX::utils
+} // TREX
+
+#endif // H_trex_utils_symbol_table
@@ -0,0 +1,196 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2011, MBARI.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the TREX Project nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "json_writer.hh"
+
+#include <iomanip>
+
+#include <boost/property_tree/ptree.hpp>
+
+namespace bp=boost::property_tree;
+using namespace TREX::utils;
+
+/*
+ * class TREX::utils::json_writer
+ */
+
+// statics
+
+void json_writer::quote(std::ostream &out, std::string const &str) {
+  out.put('"');
+  for(std::string::const_iterator i=str.begin(); str.end()!=i; ++i) {
+    switch( *i ) {
+    case '"':
+      out<<"\\\"";
+      break;
+    case '\\':
+      out<<"\\\\";
+      break;
+    case '\b':
+      out<<"\\b";
+      break;
+    case '\f':
+      out<<"\\f";
+      break;
+    case '\n':
+      out<<"\\n";
+      break;
+    case '\r':
+      out<<"\\r";
+      break;
+    case '\t':
+      out<<"\\t";
+      break;
+    default:
+      if( static_cast<unsigned char>(*i)<0x20 ) {
+        std::ios_base::fmtflags flags = out.flags();
+        out<<"\\u"<<std::hex<<std::setw(4)<<std::setfill('0')
+           <<static_cast<unsigned>(static_cast<unsigned char>(*i));
+        out.flags(flags);
+      } else
+        out.put(*i);
+    }
+  }
+  out.put('"');
+}
+
+// modifiers
+
+void json_writer::indent() {
+  if( m_fancy ) {
+    m_out.put('\n');
+    for(size_t i=0; i<m_stack.size(); ++i)
+      m_out<<"    ";
+  }
+}
+
+void json_writer::next() {
+  if( m_key ) {
+    // this is the value of the last key
+    m_key = false;
+    return;
+  }
+  if( !m_stack.empty() ) {
+    if( m_stack.back().object )
+      throw Exception("json_writer: object member written without key");
+    if( m_stack.back().count++>0 )
+      m_out.put(',');
+    indent();
+  }
+}
+
+void json_writer::close(bool object) {
+  if( m_stack.empty() || m_stack.back().object!=object || m_key )
+    throw Exception(object?"json_writer: unexpected end of object":
+                    "json_writer: unexpected end of array");
+  bool empty = 0==m_stack.back().count;
+  m_stack.pop_back();
+  if( !empty )
+    indent();
+  m_out.put(object?'}':']');
+  if( m_stack.empty() && m_fancy )
+    m_out.put('\n');
+}
+
+json_writer &json_writer::begin_object() {
+  next();
+  m_out.put('{');
+  m_stack.push_back(level(true));
+  return *this;
+}
+
+json_writer &json_writer::end_object() {
+  close(true);
+  return *this;
+}
+
+json_writer &json_writer::begin_array() {
+  next();
+  m_out.put('[');
+  m_stack.push_back(level(false));
+  return *this;
+}
+
+json_writer &json_writer::end_array() {
+  close(false);
+  return *this;
+}
+
+json_writer &json_writer::key(std::string const &name) {
+  if( m_stack.empty() || !m_stack.back().object || m_key )
+    throw Exception("json_writer: key \""+name+"\" outside of an object");
+  if( m_stack.back().count++>0 )
+    m_out.put(',');
+  indent();
+  quote(m_out, name);
+  m_out<<(m_fancy?": ":":");
+  m_key = true;
+  return *this;
+}
+
+json_writer &json_writer::value(std::string const &val) {
+  next();
+  quote(m_out, val);
+  return *this;
+}
+
+json_writer &json_writer::raw(std::string const &json) {
+  next();
+  m_out<<json;
+  return *this;
+}
+
+json_writer &json_writer::tree(bp::ptree const &p) {
+  if( p.empty() )
+    return value(p.data());
+  if( p.size()==p.count(std::string()) ) {
+    // only anonymous children : this is an array
+    begin_array();
+    for(bp::ptree::const_iterator i=p.begin(); p.end()!=i; ++i)
+      tree(i->second);
+    return end_array();
+  }
+  begin_object();
+  members(p);
+  return end_object();
+}
+
+void json_writer::members(bp::ptree const &p) {
+  for(bp::ptree::const_iterator i=p.begin(); p.end()!=i; ++i) {
+    if( "<xmlattr>"==i->first )
+      // xml attributes are just members
+      members(i->second);
+    else
+      key(i->first).tree(i->second);
+  }
+}
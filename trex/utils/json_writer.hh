@@ -0,0 +1,183 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2011, MBARI.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the TREX Project nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef H_trex_utils_json_writer
+# define H_trex_utils_json_writer
+
+# include "Exception.hh"
+
+# include <ostream>
+# include <sstream>
+# include <string>
+# include <vector>
+
+# include <boost/property_tree/ptree_fwd.hpp>
+# include <boost/utility.hpp>
+
+namespace TREX {
+  namespace utils {
+    
+    /** @brief Streaming json writer
+     *
+     * This class writes json directly to an output stream as the 
+     * document is described, without building an intermediate 
+     * @c boost::property_tree. Its output follows the same conventions 
+     * as write_json: all the values are strings and the xml attributes 
+     * of a ptree are written as regular members.
+     *
+     * As nothing is buffered, a large document can be sent while it is 
+     * produced and the memory used does not depend on its size.
+     *
+     * @code
+     * json_writer out(std::cout);
+     * out.begin_object();
+     * out.key("name").value("foo");
+     * out.key("values").begin_array();
+     * out.value(1).value(2);
+     * out.end_array();
+     * out.end_object();
+     * @endcode
+     *
+     * @ingroup utils
+     * @sa write_json(std::ostream &, boost::property_tree::ptree, bool)
+     */
+    class json_writer :boost::noncopyable {
+    public:
+      /** @brief Constructor
+       *
+       * @param[in] out The output stream
+       * @param[in] fancy Indent the output
+       */
+      explicit json_writer(std::ostream &out, bool fancy=true)
+      :m_out(out), m_fancy(fancy), m_key(false) {}
+      /** @brief Destructor */
+      ~json_writer() {}
+      
+      /** @brief Output stream
+       * @return the stream this instance writes to
+       */
+      std::ostream &stream() {
+        return m_out;
+      }
+      /** @brief Nesting depth
+       * @return the number of objects and arrays currently opened 
+       */
+      size_t depth() const {
+        return m_stack.size();
+      }
+      
+      json_writer &begin_object();
+      json_writer &end_object();
+      json_writer &begin_array();
+      json_writer &end_array();
+      
+      /** @brief Member name
+       *
+       * @param[in] name A name
+       *
+       * Start a new member @p name in the current object. It should be 
+       * followed by its value.
+       *
+       * @throw Exception not within an object
+       */
+      json_writer &key(std::string const &name);
+      /** @brief String value
+       *
+       * @param[in] val A value
+       *
+       * Write @p val as a json string
+       */
+      json_writer &value(std::string const &val);
+      json_writer &value(char const *val) {
+        return value(std::string(val));
+      }
+      /** @brief Generic value
+       *
+       * @param[in] val A value
+       *
+       * Write the textual representation of @p val as a json string
+       */
+      template<typename Ty>
+      json_writer &value(Ty const &val) {
+        std::ostringstream oss;
+        oss<<val;
+        return value(oss.str());
+      }
+      /** @brief Raw json
+       *
+       * @param[in] json A json document
+       *
+       * Insert @p json as is as the next value. It is used to write 
+       * already serialized documents.
+       */
+      json_writer &raw(std::string const &json);
+      /** @brief Property tree 
+       *
+       * @param[in] p A property tree
+       *
+       * Write @p p as the next value with the same conventions as 
+       * write_json
+       */
+      json_writer &tree(boost::property_tree::ptree const &p);
+      
+      /** @brief Write a string
+       *
+       * @param[out] out An output stream
+       * @param[in] str A string
+       *
+       * Write @p str to @p out as a quoted json string
+       */
+      static void quote(std::ostream &out, std::string const &str);
+      
+    private:
+      struct level {
+        level(bool obj):object(obj), count(0) {}
+        bool   object;
+        size_t count;
+      };
+      
+      void next();
+      void close(bool object);
+      void indent();
+      void members(boost::property_tree::ptree const &p);
+      
+      std::ostream      &m_out;
+      bool const         m_fancy;
+      bool               m_key;
+      std::vector<level> m_stack;
+    }; // TREX::utils::json_writer
+    
+  } // TREX::utils
+} // TREX
+
+#endif // H_trex_utils_json_writer
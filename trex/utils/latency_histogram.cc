@@ -0,0 +1,188 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2011, MBARI.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the TREX Project nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "latency_histogram.hh"
+
+#include <algorithm>
+#include <limits>
+
+using namespace TREX::utils;
+
+namespace {
+  
+  inline size_t msb(latency_histogram::value_type v) {
+#ifdef __GNUC__
+    return 63-__builtin_clzll(v);
+#else
+    size_t ret = 0;
+    while( v>>=1 )
+      ++ret;
+    return ret;
+#endif
+  }
+  
+}
+
+/*
+ * class TREX::utils::latency_histogram
+ */
+
+// statics
+
+size_t latency_histogram::index_of(value_type v) {
+  if( v<(sub_count<<1) )
+    return static_cast<size_t>(v);
+  size_t shift = msb(v)-sub_bits;
+  return shift*sub_count+static_cast<size_t>(v>>shift);
+}
+
+latency_histogram::value_type latency_histogram::highest_of(size_t idx) {
+  if( idx<(sub_count<<1) )
+    return idx;
+  size_t shift = idx/sub_count-1;
+  value_type sub = idx-shift*sub_count;
+  return ((sub+1)<<shift)-1;
+}
+
+// structors
+
+latency_histogram::latency_histogram()
+:m_buckets(n_buckets, 0), m_count(0),
+ m_min(std::numeric_limits<value_type>::max()), m_max(0) {}
+
+// modifiers
+
+void latency_histogram::record_ns(value_type ns) {
+  m_buckets[index_of(ns)] += 1;
+  m_count += 1;
+  if( ns<m_min )
+    m_min = ns;
+  if( ns>m_max )
+    m_max = ns;
+}
+
+void latency_histogram::reset() {
+  if( m_count>0 ) {
+    std::fill(m_buckets.begin(), m_buckets.end(), 0);
+    m_count = 0;
+    m_min = std::numeric_limits<value_type>::max();
+    m_max = 0;
+  }
+}
+
+void latency_histogram::merge(latency_histogram const &other) {
+  if( other.m_count>0 ) {
+    for(size_t i=0; i<n_buckets; ++i)
+      m_buckets[i] += other.m_buckets[i];
+    m_count += other.m_count;
+    if( other.m_min<m_min )
+      m_min = other.m_min;
+    if( other.m_max>m_max )
+      m_max = other.m_max;
+  }
+}
+
+// observers
+
+latency_histogram::value_type latency_histogram::percentile(double p) const {
+  if( 0==m_count )
+    return 0;
+  if( p>=100.0 )
+    return m_max;
+  
+  count_type target = static_cast<count_type>((p/100.0)*m_count+0.5);
+  if( target<1 )
+    target = 1;
+  count_type seen = 0;
+  for(size_t i=index_of(m_min); i<n_buckets; ++i) {
+    seen += m_buckets[i];
+    if( seen>=target ) {
+      value_type ret = highest_of(i);
+      return ret<m_max ? ret : m_max;
+    }
+  }
+  return m_max;
+}
+
+/*
+ * class TREX::utils::latency_registry
+ */
+
+// structors
+
+latency_registry::latency_registry():m_last_window(-1) {}
+
+latency_registry::~latency_registry() {}
+
+// modifiers
+
+latency_registry::histogram_ref latency_registry::get(Symbol const &source,
+                                                      Symbol const &phase) {
+  boost::mutex::scoped_lock lock(m_mtx);
+  histogram_ref &ret = m_histograms[std::make_pair(source, phase)];
+  if( !ret )
+    ret = MAKE_SHARED<latency_histogram>();
+  return ret;
+}
+
+void latency_registry::roll(long long window, std::list<summary> &out) {
+  std::list<summary> tmp;
+  boost::mutex::scoped_lock lock(m_mtx);
+  
+  for(map_type::const_iterator i=m_histograms.begin();
+      m_histograms.end()!=i; ++i) {
+    latency_histogram &h = *(i->second);
+    if( !h.empty() ) {
+      summary s;
+      s.source = i->first.first;
+      s.phase = i->first.second;
+      s.count = h.count();
+      s.p50 = h.percentile(50.0);
+      s.p99 = h.percentile(99.0);
+      s.max = h.max();
+      tmp.push_back(s);
+      h.reset();
+    }
+  }
+  out.insert(out.end(), tmp.begin(), tmp.end());
+  m_last.swap(tmp);
+  m_last_window = window;
+}
+
+// observers
+
+long long latency_registry::last(std::list<summary> &out) const {
+  boost::mutex::scoped_lock lock(m_mtx);
+  out.insert(out.end(), m_last.begin(), m_last.end());
+  return m_last_window;
+}
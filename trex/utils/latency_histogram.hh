@@ -0,0 +1,217 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2011, MBARI.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the TREX Project nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef H_trex_utils_latency_histogram
+# define H_trex_utils_latency_histogram
+
+# include "Symbol.hh"
+# include "platform/chrono.hh"
+# include "platform/memory.hh"
+
+# include <map>
+# include <list>
+# include <vector>
+
+# include <boost/cstdint.hpp>
+# include <boost/noncopyable.hpp>
+# include <boost/thread/mutex.hpp>
+
+namespace TREX {
+  namespace utils {
+    
+    /** @brief Latency histogram
+     *
+     * A compact histogram of durations inspired by HdrHistogram. Values
+     * are stored in nanoseconds into log-linear buckets: each power of 2
+     * is split in 32 linear sub-buckets which gives a relative error
+     * below 3.2% for any value while keeping a fixed size for the whole
+     * 64 bits range.
+     *
+     * The histogram is not thread safe: it is meant to be updated by a
+     * single thread at a time and read when this thread is not updating
+     * it.
+     *
+     * @ingroup utils
+     */
+    class latency_histogram {
+    public:
+      typedef boost::uint64_t value_type; //*< value type (ns)
+      typedef boost::uint64_t count_type; //*< count type
+      
+      latency_histogram();
+      
+      /** @brief Record a duration
+       *
+       * @param[in] d A duration
+       *
+       * Record @p d -- converted in nanoseconds -- in this histogram.
+       * Negative durations are recorded as 0.
+       */
+      template<class Rep, class Period>
+      void record(CHRONO::duration<Rep, Period> const &d) {
+        Rep ns = CHRONO::duration_cast<CHRONO::nanoseconds>(d).count();
+        record_ns(ns<0 ? 0 : static_cast<value_type>(ns));
+      }
+      /** @brief Record a value
+       * @param[in] ns A duration in nanoseconds
+       */
+      void record_ns(value_type ns);
+      
+      /** @brief Number of values recorded */
+      count_type count() const {
+        return m_count;
+      }
+      bool empty() const {
+        return 0==m_count;
+      }
+      /** @brief Smallest value recorded
+       * @pre !empty()
+       */
+      value_type min() const {
+        return m_min;
+      }
+      /** @brief Largest value recorded
+       * @pre !empty()
+       */
+      value_type max() const {
+        return m_max;
+      }
+      /** @brief Percentile value
+       *
+       * @param[in] p A percentile in [0, 100]
+       *
+       * @return The highest value equivalent to the bucket that includes
+       *         the @p p th percentile of the recorded values, capped by
+       *         max()
+       * @pre !empty()
+       */
+      value_type percentile(double p) const;
+      
+      /** @brief Clear all the recorded values */
+      void reset();
+      /** @brief Merge histograms
+       * @param[in] other Another histogram
+       * Add all the values recorded in @p other to this histogram
+       */
+      void merge(latency_histogram const &other);
+      
+    private:
+      static size_t const sub_bits = 5;
+      static size_t const sub_count = 1<<sub_bits;
+      static size_t const n_buckets = (64-sub_bits+1)*sub_count;
+      
+      static size_t index_of(value_type v);
+      static value_type highest_of(size_t idx);
+      
+      std::vector<count_type> m_buckets;
+      count_type              m_count;
+      value_type              m_min, m_max;
+    }; // TREX::utils::latency_histogram
+    
+    /** @brief Latency metrics registry
+     *
+     * A registry of latency histograms identified by a source (typically
+     * a reactor name) and a phase (for example @c synchronize). Each
+     * histogram covers a window of ticks: when the window ends the owner of
+     * the registry calls roll() which summarizes the histograms, resets
+     * them for the next window and publishes this summary so other threads
+     * can query it at any time through last().
+     *
+     * @ingroup utils
+     */
+    class latency_registry :boost::noncopyable {
+    public:
+      typedef latency_histogram::value_type value_type;
+      typedef SHARED_PTR<latency_histogram> histogram_ref;
+      
+      /** @brief Histogram summary */
+      struct summary {
+        Symbol     source;
+        Symbol     phase;
+        latency_histogram::count_type count;
+        value_type p50, p99, max;
+      }; // TREX::utils::latency_registry::summary
+      
+      latency_registry();
+      ~latency_registry();
+      
+      /** @brief Get a histogram
+       *
+       * @param[in] source A source name
+       * @param[in] phase A phase name
+       *
+       * @return The histogram associated to @p source and @p phase, creating
+       *         it if it did not already exist. The histogram is owned by
+       *         this registry but the caller can keep the reference returned
+       *         to update it directly.
+       */
+      histogram_ref get(Symbol const &source, Symbol const &phase);
+      
+      /** @brief Close the current window
+       *
+       * @param[in] window The identifier of the window (usually its
+       *            last tick)
+       * @param[out] out Where to append the summaries
+       *
+       * Summarize all the non empty histograms, reset them and publish the
+       * summaries as the last window.
+       *
+       * @pre the histograms are not updated during this call
+       *
+       * @sa last(std::list<summary> &) const
+       */
+      void roll(long long window, std::list<summary> &out);
+      /** @brief Last window summary
+       *
+       * @param[out] out Where to append the summaries
+       *
+       * @return The identifier of the last window closed by roll or -1 if
+       *         no window was closed yet
+       *
+       * This method is thread safe and can be called at any time.
+       */
+      long long last(std::list<summary> &out) const;
+      
+    private:
+      typedef std::map<std::pair<Symbol, Symbol>, histogram_ref> map_type;
+      
+      mutable boost::mutex m_mtx;
+      map_type             m_histograms;
+      long long            m_last_window;
+      std::list<summary>   m_last;
+    }; // TREX::utils::latency_registry
+    
+  } // TREX::utils
+} // TREX
+
+#endif // H_trex_utils_latency_histogram
@@ -0,0 +1,173 @@
+/* -*- C++ -*- */
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ * 
+ *  Copyright (c) 2011, MBARI.
+ *  All rights reserved.
+ * 
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ * 
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the TREX Project nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ * 
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef H_trex_utils_log_binary_file
+# define H_trex_utils_log_binary_file
+
+# include "record.hh"
+# include "bits/record_ring.hh"
+
+# include <fstream>
+# include <list>
+
+# include <boost/asio/io_service.hpp>
+# include <boost/asio/deadline_timer.hpp>
+# include <boost/thread/mutex.hpp>
+# include <boost/thread/tss.hpp>
+# include <boost/unordered_map.hpp>
+
+namespace TREX {
+  namespace utils {
+    namespace log {
+      
+      /** @brief Structured binary log file
+       *
+       * This class collects the structured log records produced by all 
+       * the threads and writes them in a compact binary file. Records 
+       * are stored by each producing thread in its own ring buffer
+       * and drained periodically by a handler running on the log 
+       * io_service which writes them -- along with the definition of 
+       * each format and symbol the first time they are used -- in the 
+       * binary file.
+       *
+       * The file starts with the @c "TRXL" magic followed by a 16 bits 
+       * version and a sequence of entries each starting with a one 
+       * character tag:
+       * @li @c F a format definition: @c <id:u32><len:u32><text>
+       * @li @c S a symbol definition: @c <id:u32><len:u32><text>
+       * @li @c M a message: @c <fmt:u32><dated:u8>[<date:u64>]<kind:u32>
+       *        @c <n:u8><source:u32>*n<m:u8><arg>*m where each argument 
+       *        is its type tag (see record::arg_type) followed by its value
+       * @li @c D dropped records: @c <count:u64>
+       *
+       * All the integers are in little endian.
+       *
+       * @ingroup utils
+       * @sa class record
+       */
+      class binary_file :public ENABLE_SHARED_FROM_THIS<binary_file> {
+      public:
+        typedef boost::uint16_t version_type;
+        
+        static char const         magic[4];
+        static version_type const version;
+        
+        /** @brief Constructor
+         *
+         * @param[in] fname A file name
+         * @param[in] io The service used for draining records
+         *
+         * Create the file @p fname in order to store binary log records
+         */
+        binary_file(std::string const &fname, boost::asio::io_service &io);
+        /** @brief Destructor */
+        ~binary_file();
+        
+        /** @brief Start periodic drain 
+         *
+         * @param[in] period The drain period in milliseconds
+         */
+        void start(long period=50);
+        /** @brief Stop
+         *
+         * Stop the periodic drain and write all the pending records
+         */
+        void close();
+        /** @brief Write pending records
+         *
+         * Drain all the records produced so far into the file and flush it
+         */
+        void flush();
+        
+        /** @brief Decode a binary log
+         *
+         * @param[in] in An input stream 
+         * @param[out] out An output stream
+         *
+         * Decode the binary log from @p in and write it to @p out in 
+         * the same text format as @c TREX.log
+         *
+         * @throw ErrnoExcept the content of @p in is not a valid binary log
+         *
+         * @return the number of messages decoded
+         */
+        static size_t decode(std::istream &in, std::ostream &out);
+        
+      private:
+        typedef details::record_ring ring_type;
+        typedef SHARED_PTR<ring_type> ring_ref;
+        
+        void push(void const *data, size_t len);
+        ring_type &local_ring();
+        
+        void drain();
+        void schedule();
+        void timeout(boost::system::error_code const &ec);
+        
+        struct writer {
+          explicit writer(binary_file &f):file(f) {}
+          void operator()(char const *data, ring_type::size_type len) {
+            file.write_record(data, len);
+          }
+          binary_file &file;
+        };
+        void write_record(char const *data, ring_type::size_type len);
+        boost::uint32_t symbol(char const *str);
+        void write_format(format::id_type id);
+        
+        template<typename Ty>
+        void write(Ty val);
+        void write_text(char const *str, size_t len);
+        
+        boost::thread_specific_ptr<ring_ref> m_local;
+        boost::mutex                         m_rings_mtx;
+        std::list<ring_ref>                  m_rings;
+        
+        boost::mutex                         m_drain_mtx;
+        std::ofstream                        m_file;
+        boost::unordered_map<char const *, boost::uint32_t> m_symbols;
+        std::vector<bool>                    m_formats;
+        
+        boost::asio::deadline_timer m_timer;
+        long                        m_period;
+        bool                        m_closed;
+        
+        friend class record;
+      }; // TREX::utils::log::binary_file
+      
+    } // TREX::utils::log
+  } // TREX::utils
+} // TREX
+
+#endif // H_trex_utils_log_binary_file
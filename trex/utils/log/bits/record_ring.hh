@@ -0,0 +1,179 @@
+/* -*- C++ -*- */
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ * 
+ *  Copyright (c) 2011, MBARI.
+ *  All rights reserved.
+ * 
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ * 
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the TREX Project nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ * 
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef H_trex_utils_log_bits_record_ring
+# define H_trex_utils_log_bits_record_ring
+
+# include <cstring>
+# include <vector>
+
+# include <boost/cstdint.hpp>
+# include <boost/noncopyable.hpp>
+
+# include "../../platform/atomic.hh"
+
+namespace TREX {
+  namespace utils {
+    namespace log {
+      namespace details {
+        
+        /** @brief Log record ring buffer
+         *
+         * A fixed size single producer / single consumer ring buffer of
+         * variable length records. Each thread producing structured log
+         * records owns one of these so recording a message never locks
+         * nor allocates: the record is copied in the buffer and the
+         * write position published atomically. The consumer -- the 
+         * binary_file drain -- then reads the records and releases their 
+         * space.
+         *
+         * When there's not enough room for a new record it is dropped and
+         * accounted for in the dropped() counter so the producer is never 
+         * blocked by a slow consumer.
+         *
+         * @ingroup utils
+         */
+        class record_ring :boost::noncopyable {
+        public:
+          typedef boost::uint32_t size_type;
+          
+          /** @brief Constructor
+           * @param[in] log2 The log2 of the buffer capacity in bytes
+           */
+          explicit record_ring(unsigned log2=16)
+          :m_buff(size_t(1)<<log2), m_mask((size_t(1)<<log2)-1),
+           m_head(0), m_tail(0), m_dropped(0) {}
+          ~record_ring() {}
+          
+          /** @brief Add a record
+           *
+           * @param[in] data The record content
+           * @param[in] len The size of @p data in bytes
+           *
+           * @note Only the thread owning this ring should call this method
+           *
+           * @retval true if the record was added
+           * @retval false if there was no room and the record got dropped
+           */
+          bool push(void const *data, size_type len) {
+            size_t need = sizeof(size_type)+align(len),
+              head = m_head.load(ATOMIC_NS::memory_order_relaxed),
+              tail = m_tail.load(ATOMIC_NS::memory_order_acquire),
+              pos = head&m_mask, to_end = m_buff.size()-pos,
+              total = need;
+            
+            if( to_end<need )
+              total += to_end; // will need to skip to the beginning
+            if( m_buff.size()-(head-tail)<total ) {
+              m_dropped.fetch_add(1, ATOMIC_NS::memory_order_relaxed);
+              return false;
+            }
+            if( to_end<need ) {
+              size_type const wrap = s_wrap;
+              std::memcpy(&m_buff[pos], &wrap, sizeof(size_type));
+              head += to_end;
+              pos = 0;
+            }
+            std::memcpy(&m_buff[pos], &len, sizeof(size_type));
+            std::memcpy(&m_buff[pos+sizeof(size_type)], data, len);
+            m_head.store(head+need, ATOMIC_NS::memory_order_release);
+            return true;
+          }
+          
+          /** @brief Consume records
+           *
+           * @tparam Fn A functor type
+           * @param[in] fn A functor
+           *
+           * Call @p fn as @c fn(char const *data, size_type len) for all 
+           * the records currently in the buffer and release their space
+           *
+           * @note Only one thread can consume records at a time
+           *
+           * @return the number of records consumed
+           */
+          template<class Fn>
+          size_t consume(Fn &fn) {
+            size_t tail = m_tail.load(ATOMIC_NS::memory_order_relaxed),
+              head = m_head.load(ATOMIC_NS::memory_order_acquire), ret = 0;
+            
+            while( tail!=head ) {
+              size_t pos = tail&m_mask;
+              size_type len;
+              
+              std::memcpy(&len, &m_buff[pos], sizeof(size_type));
+              if( s_wrap==len )
+                tail += m_buff.size()-pos;
+              else {
+                fn(&m_buff[pos+sizeof(size_type)], len);
+                tail += sizeof(size_type)+align(len);
+                ++ret;
+              }
+            }
+            m_tail.store(tail, ATOMIC_NS::memory_order_release);
+            return ret;
+          }
+          
+          /** @brief Check for emptiness */
+          bool empty() const {
+            return m_head.load(ATOMIC_NS::memory_order_acquire)==
+              m_tail.load(ATOMIC_NS::memory_order_acquire);
+          }
+          
+          /** @brief Collect dropped records count
+           *
+           * @return the number of records dropped since the last call
+           */
+          size_t dropped() {
+            return m_dropped.exchange(0, ATOMIC_NS::memory_order_relaxed);
+          }
+          
+        private:
+          static size_t align(size_type len) {
+            return (size_t(len)+sizeof(size_type)-1)&~(sizeof(size_type)-1);
+          }
+          
+          static size_type const s_wrap = 0xffffffff;
+          
+          std::vector<char>          m_buff;
+          size_t const               m_mask;
+          ATOMIC_NS::atomic<size_t>  m_head, m_tail, m_dropped;
+        }; // TREX::utils::log::details::record_ring
+        
+      } // TREX::utils::log::details
+    } // TREX::utils::log
+  } // TREX::utils
+} // TREX
+
+#endif // H_trex_utils_log_bits_record_ring
@@ -40,6 +40,8 @@
 # include <fstream>
 # include <memory>
 
+# include <boost/optional.hpp>
+
 namespace TREX {
   namespace utils {
     namespace log {
@@ -78,6 +80,25 @@ namespace TREX {
         void operator()(entry::pointer msg);
         void flush();
         
+        /** @brief Format a message
+         *
+         * @param[out] out An output stream
+         * @param[in] date The optional date of the message
+         * @param[in] source The message source
+         * @param[in] kind The message type
+         * @param[in] content The message content
+         *
+         * Write the message in @p out using the same format as the 
+         * entries of the log file
+         *
+         * @return @p out after the operation
+         */
+        static std::ostream &print(std::ostream &out, 
+                                   boost::optional<entry::date_type> const &date,
+                                   std::string const &source, 
+                                   id_type const &kind,
+                                   std::string const &content);
+        
       private:
         SHARED_PTR<std::ofstream> m_file;
       };
@@ -0,0 +1,579 @@
+/* -*- C++ -*- */
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ * 
+ *  Copyright (c) 2011, MBARI.
+ *  All rights reserved.
+ * 
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ * 
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the TREX Project nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ * 
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "binary_file.hh"
+#include "out_file.hh"
+#include "../Exception.hh"
+
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/format.hpp>
+#include <boost/optional.hpp>
+#include <boost/thread/locks.hpp>
+
+using namespace TREX::utils::log;
+
+namespace {
+  
+  /** @brief Global format registry
+   *
+   * All the formats declared so far. The index of a format in this 
+   * vector is its identifier.
+   */
+  class format_registry {
+  public:
+    static format_registry &instance() {
+      static format_registry me;
+      return me;
+    }
+    
+    format::id_type add(std::string const &text) {
+      boost::mutex::scoped_lock lock(m_mtx);
+      m_formats.push_back(text);
+      return format::id_type(m_formats.size()-1);
+    }
+    std::string get(format::id_type id) {
+      boost::mutex::scoped_lock lock(m_mtx);
+      if( id<m_formats.size() )
+        return m_formats[id];
+      return std::string();
+    }
+    
+  private:
+    format_registry() {}
+    
+    boost::mutex             m_mtx;
+    std::vector<std::string> m_formats;
+  };
+  
+  /** @brief Decoding helper for binary_file::decode */
+  class blog_reader {
+  public:
+    explicit blog_reader(std::istream &in):m_in(in) {}
+    
+    template<typename Ty>
+    Ty read() {
+      Ty ret = 0;
+      unsigned char buf[sizeof(Ty)];
+      
+      check(m_in.read(reinterpret_cast<char *>(buf), sizeof(Ty)));
+      for(size_t i=sizeof(Ty); i>0; --i)
+        ret = (ret<<8)|Ty(buf[i-1]);
+      return ret;
+    }
+    double read_double() {
+      boost::uint64_t bits = read<boost::uint64_t>();
+      double ret;
+      std::memcpy(&ret, &bits, sizeof(double));
+      return ret;
+    }
+    std::string read_text() {
+      boost::uint32_t len = read<boost::uint32_t>();
+      std::string ret(len, '\0');
+      if( len>0 )
+        check(m_in.read(&ret[0], len));
+      return ret;
+    }
+    
+    void check(std::istream &in) {
+      if( !in )
+        throw TREX::utils::Exception("Truncated binary log");
+    }
+    
+  private:
+    std::istream &m_in;
+  };
+  
+  /** @brief Value of the symbol @p id */
+  std::string const &symbol_of(std::vector<std::string> const &symbols,
+                               boost::uint32_t id) {
+    static std::string const none;
+    return id<symbols.size()?symbols[id]:none;
+  }
+  
+}
+
+/*
+ * class TREX::utils::log::format
+ */
+
+format::format(std::string const &text)
+  :m_id(format_registry::instance().add(text)) {}
+
+std::string format::text(format::id_type id) {
+  return format_registry::instance().get(id);
+}
+
+/*
+ * class TREX::utils::log::record
+ */
+
+// structors
+
+record::record(binary_file *dest, format const &fmt, id_type const &kind)
+  :m_dest(dest), m_size(sizeof(header)) {
+  m_header.fmt = fmt.id();
+  m_header.dated = 0;
+  m_header.n_source = 0;
+  m_header.n_args = 0;
+  m_header.date = 0;
+  m_header.kind = kind.c_str();
+}
+
+record::record(record const &other)
+  :m_dest(other.m_dest), m_header(other.m_header), m_size(other.m_size) {
+  std::memcpy(m_buff, other.m_buff, m_size);
+  other.m_dest = NULL;
+}
+
+record::~record() {
+  if( NULL!=m_dest ) {
+    std::memcpy(m_buff, &m_header, sizeof(header));
+    m_dest->push(m_buff, m_size);
+  }
+}
+
+// modifiers
+
+record &record::date(record::date_type const &when) {
+  m_header.dated = 1;
+  m_header.date = when;
+  return *this;
+}
+
+record &record::source(id_type const &id) {
+  if( m_header.n_source<max_source )
+    m_header.source[m_header.n_source++] = id.c_str();
+  return *this;
+}
+
+bool record::reserve(size_t len) {
+  if( m_size+1+len<=capacity && m_header.n_args<0xff ) {
+    m_header.n_args += 1;
+    return true;
+  }
+  return false;
+}
+
+template<typename Ty>
+void record::put(Ty const &val) {
+  std::memcpy(m_buff+m_size, &val, sizeof(Ty));
+  m_size += sizeof(Ty);
+}
+
+record &record::add_int(boost::int64_t val) {
+  if( reserve(sizeof(val)) ) {
+    put(boost::uint8_t(arg_int));
+    put(val);
+  }
+  return *this;
+}
+
+record &record::add_uint(boost::uint64_t val) {
+  if( reserve(sizeof(val)) ) {
+    put(boost::uint8_t(arg_uint));
+    put(val);
+  }
+  return *this;
+}
+
+record &record::operator<<(bool val) {
+  if( reserve(1) ) {
+    put(boost::uint8_t(arg_bool));
+    put(boost::uint8_t(val));
+  }
+  return *this;
+}
+
+record &record::operator<<(double val) {
+  if( reserve(sizeof(val)) ) {
+    put(boost::uint8_t(arg_float));
+    put(val);
+  }
+  return *this;
+}
+
+record &record::operator<<(id_type const &val) {
+  // Symbols are never released so their text remains at the same address
+  char const *ptr = val.c_str();
+  if( reserve(sizeof(ptr)) ) {
+    put(boost::uint8_t(arg_symbol));
+    put(ptr);
+  }
+  return *this;
+}
+
+record &record::operator<<(char const *val) {
+  return add_string(val, NULL==val?0:std::strlen(val));
+}
+
+record &record::operator<<(void const *val) {
+  if( reserve(sizeof(boost::uint64_t)) ) {
+    put(boost::uint8_t(arg_pointer));
+    put(boost::uint64_t(reinterpret_cast<size_t>(val)));
+  }
+  return *this;
+}
+
+record &record::add_string(char const *s, size_t len) {
+  if( reserve(sizeof(boost::uint16_t)) ) {
+    // truncate the string to what remains available
+    boost::uint16_t n = std::min(len, capacity-m_size-1-sizeof(boost::uint16_t));
+    put(boost::uint8_t(arg_string));
+    put(n);
+    std::memcpy(m_buff+m_size, s, n);
+    m_size += n;
+  }
+  return *this;
+}
+
+/*
+ * class TREX::utils::log::binary_file
+ */
+
+char const binary_file::magic[4] = {'T', 'R', 'X', 'L'};
+binary_file::version_type const binary_file::version = 1;
+
+// structors
+
+binary_file::binary_file(std::string const &fname, 
+                         boost::asio::io_service &io)
+  :m_file(fname.c_str(), std::ios::binary), m_timer(io), m_period(50),
+   m_closed(false) {
+  m_file.write(magic, sizeof(magic));
+  write(version);
+}
+
+binary_file::~binary_file() {
+  close();
+}
+
+// manipulators
+
+void binary_file::start(long period) {
+  m_period = period;
+  schedule();
+}
+
+void binary_file::close() {
+  {
+    boost::mutex::scoped_lock lock(m_drain_mtx);
+    if( m_closed )
+      return;
+    m_closed = true;
+  }
+  m_timer.cancel();
+  flush();
+}
+
+void binary_file::flush() {
+  drain();
+  boost::mutex::scoped_lock lock(m_drain_mtx);
+  m_file.flush();
+}
+
+void binary_file::schedule() {
+  m_timer.expires_from_now(boost::posix_time::milliseconds(m_period));
+  m_timer.async_wait(boost::bind(&binary_file::timeout, shared_from_this(), _1));
+}
+
+void binary_file::timeout(boost::system::error_code const &ec) {
+  if( !ec ) {
+    drain();
+    boost::mutex::scoped_lock lock(m_drain_mtx);
+    if( !m_closed ) 
+      schedule();
+  }
+}
+
+binary_file::ring_type &binary_file::local_ring() {
+  ring_ref *cur = m_local.get();
+  
+  if( NULL==cur ) {
+    cur = new ring_ref(new ring_type);
+    m_local.reset(cur);
+    
+    boost::mutex::scoped_lock lock(m_rings_mtx);
+    m_rings.push_back(*cur);
+  }
+  return **cur;
+}
+
+void binary_file::push(void const *data, size_t len) {
+  local_ring().push(data, len);
+}
+
+void binary_file::drain() {
+  boost::mutex::scoped_lock lock(m_drain_mtx);
+  std::list<ring_ref> rings;
+  size_t dropped = 0;
+  
+  {
+    boost::mutex::scoped_lock r_lock(m_rings_mtx);
+    // Forget about the rings of terminated threads once empty
+    for(std::list<ring_ref>::iterator i=m_rings.begin(); m_rings.end()!=i; ) {
+      if( 1==i->use_count() && (*i)->empty() )
+        i = m_rings.erase(i);
+      else 
+        ++i;
+    }
+    rings = m_rings;
+  }
+  writer w(*this);
+  
+  for(std::list<ring_ref>::iterator i=rings.begin(); rings.end()!=i; ++i) {
+    (*i)->consume(w);
+    dropped += (*i)->dropped();
+  }
+  if( dropped>0 ) {
+    m_file.put('D');
+    write(boost::uint64_t(dropped));
+  }
+}
+
+template<typename Ty>
+void binary_file::write(Ty val) {
+  char buf[sizeof(Ty)];
+  
+  for(size_t i=0; i<sizeof(Ty); ++i) {
+    buf[i] = char(val&0xff);
+    val >>= 8;
+  }
+  m_file.write(buf, sizeof(Ty));
+}
+
+void binary_file::write_text(char const *str, size_t len) {
+  write(boost::uint32_t(len));
+  m_file.write(str, len);
+}
+
+boost::uint32_t binary_file::symbol(char const *str) {
+  std::pair<boost::unordered_map<char const *, boost::uint32_t>::iterator, bool>
+    ret = m_symbols.insert(std::make_pair(str, boost::uint32_t(m_symbols.size())));
+  
+  if( ret.second ) {
+    m_file.put('S');
+    write(ret.first->second);
+    write_text(str, std::strlen(str));
+  }
+  return ret.first->second;
+}
+
+void binary_file::write_format(format::id_type id) {
+  if( m_formats.size()<=id )
+    m_formats.resize(id+1, false);
+  if( !m_formats[id] ) {
+    std::string text = format::text(id);
+    
+    m_formats[id] = true;
+    m_file.put('F');
+    write(id);
+    write_text(text.c_str(), text.length());
+  }
+}
+
+void binary_file::write_record(char const *data, ring_type::size_type len) {
+  record::header hdr;
+  boost::uint32_t kind, src[record::max_source];
+  
+  std::memcpy(&hdr, data, sizeof(hdr));
+  // Definitions need to be written before the message itself
+  write_format(hdr.fmt);
+  kind = symbol(hdr.kind);
+  for(size_t i=0; i<hdr.n_source; ++i)
+    src[i] = symbol(hdr.source[i]);
+  
+  char const *pos = data+sizeof(hdr), *end = data+len;
+  std::vector<boost::uint32_t> syms;
+  
+  // collect arguments symbols 
+  for(size_t i=0; i<hdr.n_args && pos<end; ++i) {
+    boost::uint8_t type = boost::uint8_t(*(pos++));
+    switch( type ) {
+      case record::arg_bool:
+        pos += 1;
+        break;
+      case record::arg_symbol:
+        {
+          char const *ptr;
+          std::memcpy(&ptr, pos, sizeof(ptr));
+          syms.push_back(symbol(ptr));
+          pos += sizeof(ptr);
+        }
+        break;
+      case record::arg_string:
+        {
+          boost::uint16_t n;
+          std::memcpy(&n, pos, sizeof(n));
+          pos += sizeof(n)+n;
+        }
+        break;
+      default:
+        pos += 8;
+    }
+  }
+  
+  m_file.put('M');
+  write(hdr.fmt);
+  write(hdr.dated);
+  if( hdr.dated )
+    write(boost::uint64_t(hdr.date));
+  write(kind);
+  write(hdr.n_source);
+  for(size_t i=0; i<hdr.n_source; ++i)
+    write(src[i]);
+  write(hdr.n_args);
+  
+  pos = data+sizeof(hdr);
+  std::vector<boost::uint32_t>::const_iterator s = syms.begin();
+  for(size_t i=0; i<hdr.n_args && pos<end; ++i) {
+    boost::uint8_t type = boost::uint8_t(*(pos++));
+    
+    m_file.put(type);
+    switch( type ) {
+      case record::arg_bool:
+        m_file.put(*(pos++));
+        break;
+      case record::arg_symbol:
+        write(*(s++));
+        pos += sizeof(char const *);
+        break;
+      case record::arg_string:
+        {
+          boost::uint16_t n;
+          std::memcpy(&n, pos, sizeof(n));
+          pos += sizeof(n);
+          write_text(pos, n);
+          pos += n;
+        }
+        break;
+      default:
+        {
+          // all the other types are 8 bytes long
+          boost::uint64_t bits;
+          std::memcpy(&bits, pos, sizeof(bits));
+          write(bits);
+          pos += sizeof(bits);
+        }
+    }
+  }
+}
+
+// statics
+
+size_t binary_file::decode(std::istream &in, std::ostream &out) {
+  blog_reader rd(in);
+  char head[sizeof(magic)];
+  std::vector<std::string> formats, symbols;
+  size_t count = 0;
+  
+  rd.check(in.read(head, sizeof(head)));
+  if( !std::equal(head, head+sizeof(head), magic) )
+    throw TREX::utils::Exception("Not a TREX binary log");
+  if( rd.read<version_type>()!=version )
+    throw TREX::utils::Exception("Unsupported binary log version");
+  
+  for(int tag=in.get(); std::istream::traits_type::eof()!=tag; tag=in.get()) {
+    switch( tag ) {
+      case 'F':
+      case 'S':
+        {
+          std::vector<std::string> &dest = ('F'==tag)?formats:symbols;
+          boost::uint32_t id = rd.read<boost::uint32_t>();
+          if( dest.size()<=id )
+            dest.resize(id+1);
+          dest[id] = rd.read_text();
+        }
+        break;
+      case 'D':
+        out<<"WARNING: "<<rd.read<boost::uint64_t>()
+           <<" log records were dropped"<<std::endl;
+        break;
+      case 'M':
+        {
+          boost::uint32_t fmt = rd.read<boost::uint32_t>();
+          boost::optional<entry::date_type> date;
+          std::string source;
+          
+          if( rd.read<boost::uint8_t>() )
+            date = rd.read<boost::uint64_t>();
+          id_type kind(symbol_of(symbols, rd.read<boost::uint32_t>()));
+          for(size_t n=rd.read<boost::uint8_t>(); n>0; --n) {
+            if( !source.empty() )
+              source += '.';
+            source += symbol_of(symbols, rd.read<boost::uint32_t>());
+          }
+          
+          boost::format text(fmt<formats.size()?formats[fmt]:std::string());
+          text.exceptions(boost::io::all_error_bits ^ 
+                          (boost::io::too_many_args_bit | 
+                           boost::io::too_few_args_bit));
+          for(size_t n=rd.read<boost::uint8_t>(); n>0; --n) {
+            switch( rd.read<boost::uint8_t>() ) {
+              case record::arg_int:
+                text % boost::int64_t(rd.read<boost::uint64_t>());
+                break;
+              case record::arg_uint:
+                text % rd.read<boost::uint64_t>();
+                break;
+              case record::arg_float:
+                text % rd.read_double();
+                break;
+              case record::arg_bool:
+                text % bool(rd.read<boost::uint8_t>());
+                break;
+              case record::arg_symbol:
+                text % symbol_of(symbols, rd.read<boost::uint32_t>());
+                break;
+              case record::arg_string:
+                text % rd.read_text();
+                break;
+              case record::arg_pointer:
+                text % reinterpret_cast<void const *>(size_t(rd.read<boost::uint64_t>()));
+                break;
+              default:
+                throw TREX::utils::Exception("Unknown argument type in binary log");
+            }
+          }
+          out_file::print(out, date, source, kind, text.str());
+          ++count;
+        }
+        break;
+      default:
+        throw TREX::utils::Exception("Invalid entry in binary log");
+    }
+  }
+  return count;
+}
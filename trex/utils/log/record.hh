@@ -0,0 +1,228 @@
+/* -*- C++ -*- */
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ * 
+ *  Copyright (c) 2011, MBARI.
+ *  All rights reserved.
+ * 
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ * 
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the TREX Project nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ * 
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef H_trex_utils_log_record
+# define H_trex_utils_log_record
+
+# include "entry.hh"
+# include "../platform/cpp11_deleted.hh"
+
+# include <boost/cstdint.hpp>
+
+namespace TREX {
+  namespace utils {
+    namespace log {
+      
+      class binary_file;
+      
+      /** @brief Structured log message format
+       *
+       * A format describes the text of a structured log message. It is 
+       * registered once -- typically as a static variable near its call 
+       * site -- and identified afterward by a simple integer. The text
+       * uses the boost::format syntax where @c %N% is replaced by the 
+       * N-th argument of the record.
+       *
+       * @code
+       * namespace {
+       *   log::format const fmt_dispatch("Dispatching %1%[%2%] on \"%3%\".");
+       * }
+       * 
+       * m_log->record(fmt_dispatch, name, log::info)<<pred<<g.get()<<tl;
+       * @endcode
+       *
+       * @ingroup utils
+       * @sa class record
+       */
+      class format {
+      public:
+        typedef boost::uint32_t id_type;
+        
+        /** @brief Constructor
+         * @param[in] text The format text
+         *
+         * Register @p text as a new format
+         */
+        explicit format(std::string const &text);
+        ~format() {}
+        
+        /** @brief Format identifier */
+        id_type id() const {
+          return m_id;
+        }
+        
+        /** @brief Format text
+         * @param[in] id A format identifier
+         *
+         * @return the text of the format @p id or an empty string if
+         * there's no such format
+         */
+        static std::string text(id_type id);
+        
+      private:
+        id_type const m_id;
+      }; // TREX::utils::log::format
+      
+      /** @brief Structured log record
+       *
+       * A record is the structured counterpart of a log stream. Instead
+       * of formatting its message, it stores the format id along with 
+       * the raw arguments in a fixed size buffer. On destruction the
+       * buffer is pushed in the ring buffer of the current thread which
+       * will then be written in binary form into @c TREX.blog by a 
+       * binary_file. No memory allocation occurs during this process.
+       *
+       * The @c blog2txt command converts this binary file back into the 
+       * same text format as @c TREX.log
+       *
+       * @note Strings that do not fit in the record are truncated.
+       *
+       * @ingroup utils
+       * @sa class format
+       * @sa class binary_file
+       */
+      class record {
+      public:
+        typedef entry::date_type date_type;
+        
+        /** @brief Argument types */
+        enum arg_type {
+          arg_int     = 0,
+          arg_uint    = 1,
+          arg_float   = 2,
+          arg_bool    = 3,
+          arg_symbol  = 4,
+          arg_string  = 5,
+          arg_pointer = 6
+        };
+        /** @brief Maximum number of source identifiers */
+        static size_t const max_source = 3;
+        
+        /** @brief Constructor
+         *
+         * @param[in] dest The binary log destination
+         * @param[in] fmt The message format
+         * @param[in] kind The message type
+         *
+         * Create a new record for @p dest. If @p dest is @c NULL the
+         * record is inactive and all its content is discarded.
+         */
+        record(binary_file *dest, format const &fmt, id_type const &kind);
+        /** @brief Copy constructor 
+         *
+         * @param[in] other Another instance
+         *
+         * Transfer the content of @p other into this new instance.
+         * 
+         * @post @p other is no longer active
+         */
+        record(record const &other);
+        /** @brief Destructor
+         *
+         * Send the record to the binary log 
+         */
+        ~record();
+        
+        /** @brief Set record date */
+        record &date(date_type const &when);
+        /** @brief Add a source identifier
+         *
+         * @param[in] id An identifier
+         *
+         * Append @p id to the source of this record. All the source 
+         * identifiers are joined with a '.' when decoded
+         */
+        record &source(id_type const &id);
+        
+        record &operator<<(bool val);
+        record &operator<<(int val) {
+          return add_int(val);
+        }
+        record &operator<<(long val) {
+          return add_int(val);
+        }
+        record &operator<<(long long val) {
+          return add_int(val);
+        }
+        record &operator<<(unsigned val) {
+          return add_uint(val);
+        }
+        record &operator<<(unsigned long val) {
+          return add_uint(val);
+        }
+        record &operator<<(unsigned long long val) {
+          return add_uint(val);
+        }
+        record &operator<<(double val);
+        record &operator<<(id_type const &val);
+        record &operator<<(std::string const &val) {
+          return add_string(val.c_str(), val.length());
+        }
+        record &operator<<(char const *val);
+        record &operator<<(void const *val);
+        
+        /** @brief Record header */
+        struct header {
+          format::id_type fmt;
+          boost::uint8_t  dated;
+          boost::uint8_t  n_source;
+          boost::uint8_t  n_args;
+          date_type       date;
+          char const     *kind;
+          char const     *source[max_source];
+        }; // TREX::utils::log::record::header
+        
+      private:
+        record &operator= (record const &) DELETED;
+        
+        record &add_int(boost::int64_t val);
+        record &add_uint(boost::uint64_t val);
+        record &add_string(char const *s, size_t len);
+        bool reserve(size_t len);
+        template<typename Ty>
+        void put(Ty const &val);
+        
+        static size_t const capacity = 256;
+        
+        mutable binary_file *m_dest;
+        header               m_header;
+        size_t               m_size;
+        char                 m_buff[capacity];
+      }; // TREX::utils::log::record
+      
+    } // TREX::utils::log
+  } // TREX::utils
+} // TREX
+
+#endif // H_trex_utils_log_record
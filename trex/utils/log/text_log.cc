@@ -151,22 +151,33 @@ void out_file::flush() {
 
 void out_file::operator()(entry::pointer msg) {
   if( m_file && *m_file) {
-    bool prefixed = false;
+    boost::optional<entry::date_type> date;
     
-    if( msg->is_dated() ) {
-      prefixed = true;
-      (*m_file)<<'['<<msg->date()<<']';
-    }
-    if( !msg->source().empty() ) {
-      prefixed = true;
-      (*m_file)<<'['<<msg->source()<<']';
-    }
-    if( msg->kind()!=null && msg->kind()!=info ) 
-      (*m_file)<<msg->kind()<<": ";
-    else if( prefixed )
-      m_file->put(' ');
-    (*m_file)<<msg->content()<<std::endl; // change this to dt::endl if you awnt to flush
+    if( msg->is_dated() ) 
+      date = msg->date();
+    print(*m_file, date, msg->source().str(), msg->kind(), msg->content());
+  }
+}
+
+std::ostream &out_file::print(std::ostream &out, 
+                              boost::optional<entry::date_type> const &date,
+                              std::string const &source, id_type const &kind,
+                              std::string const &content) {
+  bool prefixed = false;
+  
+  if( date ) {
+    prefixed = true;
+    out<<'['<<*date<<']';
+  }
+  if( !source.empty() ) {
+    prefixed = true;
+    out<<'['<<source<<']';
   }
+  if( kind!=null && kind!=info ) 
+    out<<kind<<": ";
+  else if( prefixed )
+    out.put(' ');
+  return out<<content<<std::endl; // change this to dt::endl if you awnt to flush
 }
 
 /*
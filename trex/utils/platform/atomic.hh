@@ -0,0 +1,78 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ * 
+ *  Copyright (c) 2011, MBARI.
+ *  All rights reserved.
+ * 
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ * 
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the TREX Project nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ * 
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+/** @file "trex/utils/platform/atomic.hh"
+ * @brief atomic class integration helper header
+ *
+ * This header allows to include either @c boost/atomic or its C++11 
+ * std::atomic counterpart depending on the initial compilation 
+ * options of TREX
+ *
+ * @ingroup utils 
+ */
+#ifndef H_trex_utils_platform_atomic
+# define H_trex_utils_platform_atomic
+
+# include "bits/cpp11.hh"
+
+# ifdef DOXYGEN
+
+/** @brief atomic class namespace 
+ *
+ * This macro defines the namespace where the atomic template class 
+ * and its memory_order values are defined. This namespace is either 
+ * @c boost or @c std depending on whether c++11 support is active or not
+ */
+#  define ATOMIC_NS platform-dependent
+
+# else // !DOXYGEN
+#  ifdef CPP11_HAS_ATOMIC
+/*
+ * Use the standard C++11 atomic header
+ */
+#   include <atomic>
+#   define ATOMIC_NS ::std
+#  else // !CPP11_HAS_ATOMIC
+/*
+ * Use boost atomic as a replacement (boost 1.53 and beyond)
+ */
+#   include <boost/version.hpp>
+#   if BOOST_VERSION < 105300
+#    error "TREX requires either C++11 atomic or boost 1.53 or newer"
+#   endif
+#   include <boost/atomic.hpp>
+#   define ATOMIC_NS ::boost
+#  endif // CPP11_HAS_ATOMIC
+# endif // DOXYGEN
+
+#endif // H_trex_utils_platform_atomic
@@ -32,6 +32,7 @@
  *  POSSIBILITY OF SUCH DAMAGE.
  */
 #include "ptree_io.hh"
+#include "json_writer.hh"
 
 // Need to indicate to spirit to be thread safe
 # define BOOST_SPIRIT_THREADSAFE
@@ -150,10 +151,15 @@ std::ostream &ptree_convertible::to_xml(std::ostream &out) const {
 }
 
 std::ostream &ptree_convertible::to_json(std::ostream &out) const {
-  write_json(out, as_tree());
+  json_writer json(out);
+  to_json(json);
   return out;
 }
 
+void ptree_convertible::json_value(json_writer &out) const {
+  out.tree(as_tree());
+}
+
 
 
 
@@ -39,6 +39,8 @@
 namespace TREX {
   namespace utils {
     
+    class json_writer;
+    
     void flatten_xml_attrs(boost::property_tree::ptree &p);
     void flatten_json_arrays(boost::property_tree::ptree &p);
 
@@ -56,9 +58,31 @@ namespace TREX {
       
       std::ostream &to_xml(std::ostream &out) const;
       std::ostream &to_json(std::ostream &out) const;
+      /** @brief Streaming json output
+       *
+       * @param[in,out] out A json writer
+       *
+       * Write this instance as the next value of @p out
+       *
+       * @return @p out after the operation
+       */
+      json_writer &to_json(json_writer &out) const {
+        json_value(out);
+        return out;
+      }
     protected:
       ptree_convertible() {}
       virtual ~ptree_convertible() {}
+      
+      /** @brief json serialization
+       *
+       * @param[in,out] out A json writer
+       *
+       * Write this instance into @p out. The default implementation 
+       * writes as_tree() ; derived classes can override it in order to 
+       * produce the same document without building the property tree.
+       */
+      virtual void json_value(json_writer &out) const;
     };
     
   } // TREX::utils